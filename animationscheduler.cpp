@@ -0,0 +1,64 @@
+#include "animationscheduler.h"
+#include "iconcache.h"
+#include "tracing.h"
+
+#include <QLabel>
+#include <QPropertyAnimation>
+#include <QWidget>
+
+// AnimationScheduler 实现
+AnimationScheduler::AnimationScheduler(QWidget *host, QObject *parent)
+    : QObject(parent), host(host) {}
+
+QLabel *AnimationScheduler::acquireSprite() {
+    if (!idleSprites.isEmpty()) {
+        return idleSprites.takeLast();
+    }
+    QLabel *sprite = new QLabel(host);
+    sprite->setAttribute(Qt::WA_TransparentForMouseEvents);
+    return sprite;
+}
+
+void AnimationScheduler::releaseSprite(QLabel *sprite) {
+    sprite->hide();
+    idleSprites.append(sprite);  // 池大小不超过同时进行的动画上限
+}
+
+// 负载越高动画越短：每多 4 个并发动画，时长减半一次，最短 minDuration
+int AnimationScheduler::durationForLoad() const {
+    int duration = baseDuration;
+    for (int load = active; load >= 4 && duration > minDuration; load -= 4) {
+        duration /= 2;
+    }
+    return qMax(minDuration, duration);
+}
+
+bool AnimationScheduler::animate(int spot, const QRect &targetRect, bool isEntering) {
+    if (active >= maxConcurrent || targetRect.isEmpty()) {
+        emit animationFinished(spot, isEntering);
+        return false;
+    }
+
+    QSize iconSize(targetRect.width() * 0.8, targetRect.height() * 0.8);
+    QLabel *sprite = acquireSprite();
+    sprite->setPixmap(IconCache::pixmap(":/images/car_icon.png", iconSize));
+    sprite->show();
+    sprite->raise();
+
+    QRect outside(targetRect.x(), host->height() + 100, iconSize.width(), iconSize.height()); // 窗口之外（+100确保完全移出）
+    QPropertyAnimation *animation = new QPropertyAnimation(sprite, "geometry", this);
+    animation->setDuration(durationForLoad());
+    animation->setStartValue(isEntering ? outside : targetRect);
+    animation->setEndValue(isEntering ? targetRect : outside);
+    ++active;
+    qint64 traceStart = Tracer::enabled() ? Tracer::now() : -1;  // 动画是异步的，结束时记录整段区间
+
+    connect(animation, &QPropertyAnimation::finished, this, [=]() {
+        --active;
+        releaseSprite(sprite);
+        if (traceStart >= 0) Tracer::record(TracePoint::Animation, traceStart, Tracer::now());
+        emit animationFinished(spot, isEntering);
+    });
+    animation->start(QAbstractAnimation::DeleteWhenStopped);
+    return true;
+}
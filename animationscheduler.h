@@ -0,0 +1,44 @@
+#ifndef ANIMATIONSCHEDULER_H
+#define ANIMATIONSCHEDULER_H
+
+#include <QObject>
+#include <QRect>
+#include <QVector>
+
+class QLabel;
+class QWidget;
+
+// AnimationScheduler 类
+// 车辆进出场动画调度器：模型状态先提交，动画只负责视觉效果。
+// 任意数量的动画可以同时进行，车辆图标从复用池中取出；
+// 同时进行的动画越多，每个动画越短，超过上限时直接跳过，既不阻塞操作也不泄漏 QLabel。
+class AnimationScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit AnimationScheduler(QWidget *host, QObject *parent = nullptr);
+
+    // targetRect 为宿主控件坐标系中的车位区域；返回 false 表示因负载过高而跳过
+    bool animate(int spot, const QRect &targetRect, bool isEntering);
+
+    int activeCount() const { return active; }
+    void setBaseDuration(int msecs) { baseDuration = msecs; }
+    void setMaxConcurrent(int count) { maxConcurrent = count; }
+
+signals:
+    void animationFinished(int spot, bool isEntering);
+
+private:
+    QLabel *acquireSprite();
+    void releaseSprite(QLabel *sprite);
+    int durationForLoad() const;
+
+    QWidget *host;
+    QVector<QLabel *> idleSprites;
+    int active = 0;
+    int baseDuration = 2000;
+    int minDuration = 250;
+    int maxConcurrent = 32;
+};
+
+#endif // ANIMATIONSCHEDULER_H
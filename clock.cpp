@@ -0,0 +1,41 @@
+#include "clock.h"
+
+#include <QDateTime>
+
+const Clock *Clock::system() {
+    static const SystemClock clock;
+    return &clock;
+}
+
+// SystemClock 实现
+qint64 SystemClock::now() const {
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+// ManualClock 实现
+ManualClock::ManualClock(qint64 start) : time(start) {}
+
+qint64 ManualClock::now() const {
+    return time.load(std::memory_order_acquire);
+}
+
+void ManualClock::setTime(qint64 msecs) {
+    time.store(msecs, std::memory_order_release);
+}
+
+void ManualClock::advance(qint64 msecs) {
+    time.fetch_add(msecs, std::memory_order_acq_rel);
+}
+
+// ScaledClock 实现
+ScaledClock::ScaledClock(double speed, qint64 start) : speed(speed), start(start) {
+    elapsed.start();
+}
+
+qint64 ScaledClock::now() const {
+    return start + qint64(double(elapsed.nsecsElapsed()) * speed / 1e6);
+}
+
+QString formatTimestamp(qint64 msecs) {
+    return QDateTime::fromMSecsSinceEpoch(msecs).toString("yyyy-MM-dd hh:mm:ss");
+}
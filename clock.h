@@ -0,0 +1,54 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <atomic>
+
+// Clock 接口
+// 核心代码统一通过它读取当前时间（自 1970-01-01 UTC 起的毫秒数），
+// 测试和仿真可以换成手动推进或加速流逝的时钟。
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual qint64 now() const = 0;
+
+    static const Clock *system();  // 进程共享的系统时钟
+};
+
+// SystemClock 类：系统墙上时间
+class SystemClock : public Clock {
+public:
+    qint64 now() const override;
+};
+
+// ManualClock 类：只在调用 setTime/advance 时前进，可跨线程读取
+class ManualClock : public Clock {
+public:
+    explicit ManualClock(qint64 start = 0);
+    qint64 now() const override;
+    void setTime(qint64 msecs);
+    void advance(qint64 msecs);
+
+private:
+    std::atomic<qint64> time;
+};
+
+// ScaledClock 类：从 start 开始按 speed 倍速流逝，基于单调时钟，不受系统时间调整影响
+class ScaledClock : public Clock {
+public:
+    explicit ScaledClock(double speed, qint64 start = Clock::system()->now());
+    qint64 now() const override;
+    double getSpeed() const { return speed; }
+
+private:
+    double speed;
+    qint64 start;
+    QElapsedTimer elapsed;
+};
+
+// 把毫秒时间戳格式化为本地时间 "yyyy-MM-dd hh:mm:ss"，只在显示时使用
+QString formatTimestamp(qint64 msecs);
+
+#endif // CLOCK_H
@@ -0,0 +1,173 @@
+#include "commandbar.h"
+
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QListWidget>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QVBoxLayout>
+
+namespace {
+
+const int kMaxResults = 500;
+
+const QVector<QPair<ParkCommandType, QString>> kActions = {
+    {ParkCommandType::Park, "入库"},
+    {ParkCommandType::Release, "出库"},
+    {ParkCommandType::Query, "查询"},
+    {ParkCommandType::Cancel, "取消排队"},
+    {ParkCommandType::About, "状态"},
+    {ParkCommandType::Settle, "结算"},
+    {ParkCommandType::History, "历史"},
+    {ParkCommandType::Export, "导出"}
+};
+
+bool takesPlates(ParkCommandType type)
+{
+    return type <= ParkCommandType::Cancel && type != ParkCommandType::About;
+}
+
+} // namespace
+
+// CommandBar 实现
+CommandBar::CommandBar(QWidget *parent)
+    : QWidget(parent), actionBox(new QComboBox(this)), classBox(new QComboBox(this)),
+    priorityBox(new QComboBox(this)), input(new QPlainTextEdit(this)), pendingLabel(new QLabel(this)),
+    results(new QListWidget(this))
+{
+    for (const auto &action : kActions) actionBox->addItem(action.second, int(action.first));
+    for (int i = 0; i < kVehicleClassCount; ++i) classBox->addItem(vehicleClassName(VehicleClass(i)));
+    for (int i = 0; i < kPriorityClassCount; ++i) priorityBox->addItem(priorityClassName(PriorityClass(i)));
+    classBox->setToolTip("车辆类型，决定计费费率和可用车位");
+    priorityBox->setToolTip("车辆类别，决定排队顺序和能否使用保留车位");
+
+    // 高度约两行：回车提交，Shift+回车换行，粘贴多行车牌即为一批；提示文字随操作切换
+    input->setTabChangesFocus(true);
+    input->setFixedHeight(input->fontMetrics().lineSpacing() * 2 + 12);
+    input->installEventFilter(this);
+
+    QPushButton *submitButton = new QPushButton("提交", this);
+    connect(submitButton, &QPushButton::clicked, this, &CommandBar::submit);
+    connect(actionBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &CommandBar::updateOptions);
+
+    results->setMaximumHeight(110);
+
+    QHBoxLayout *inputLayout = new QHBoxLayout();
+    inputLayout->addWidget(actionBox);
+    inputLayout->addWidget(classBox);
+    inputLayout->addWidget(priorityBox);
+    inputLayout->addWidget(input, 1);
+    inputLayout->addWidget(submitButton);
+    inputLayout->addWidget(pendingLabel);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(inputLayout);
+    layout->addWidget(results);
+    setLayout(layout);
+    updateOptions();
+}
+
+void CommandBar::setAction(ParkCommandType type)
+{
+    int index = actionBox->findData(int(type));
+    if (index >= 0) actionBox->setCurrentIndex(index);
+    input->setFocus();
+}
+
+void CommandBar::setInputText(const QString &text)
+{
+    input->setPlainText(text);
+    input->moveCursor(QTextCursor::End);
+}
+
+void CommandBar::addResult(const QString &text, bool ok)
+{
+    QListWidgetItem *item = new QListWidgetItem(text);
+    if (!ok) item->setForeground(QColor("#C62828"));
+    results->insertItem(0, item);
+    while (results->count() > kMaxResults) delete results->takeItem(results->count() - 1);
+}
+
+void CommandBar::addResults(const QStringList &lines, bool ok)
+{
+    for (int i = qMin(int(lines.size()), kMaxResults) - 1; i >= 0; --i) addResult(lines[i], ok);
+}
+
+void CommandBar::setPendingCount(int count)
+{
+    pendingLabel->setText(count > 0 ? QString("处理中 %1 条").arg(count) : QString());
+}
+
+bool CommandBar::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == input && event->type() == QEvent::KeyPress) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
+        bool enter = keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter;
+        if (enter && !(keyEvent->modifiers() & Qt::ShiftModifier)) {
+            submit();
+            return true;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void CommandBar::updateOptions()
+{
+    ParkCommandType type = ParkCommandType(actionBox->currentData().toInt());
+    classBox->setEnabled(type == ParkCommandType::Park);
+    priorityBox->setEnabled(type == ParkCommandType::Park);
+    switch (type) {
+    case ParkCommandType::About:
+    case ParkCommandType::Settle:
+        input->setPlaceholderText("直接回车执行");
+        break;
+    case ParkCommandType::History:
+        input->setPlaceholderText("时段 yyyy-MM-dd hh:mm ~ yyyy-MM-dd hh:mm；留空查询最近 30 天每日营收");
+        break;
+    case ParkCommandType::Export:
+        input->setPlaceholderText("导出文件路径，扩展名为 .bin 时写二进制格式，否则写 CSV");
+        break;
+    default:
+        input->setPlaceholderText("输入车牌号后回车；可粘贴多个车牌批量处理");
+        break;
+    }
+}
+
+void CommandBar::submit()
+{
+    ParkCommand command;
+    command.type = ParkCommandType(actionBox->currentData().toInt());
+    command.vehicleClass = VehicleClass(classBox->currentIndex());
+    command.priorityClass = PriorityClass(priorityBox->currentIndex());
+
+    QVector<ParkCommand> commands;
+    if (!takesPlates(command.type)) {
+        // 状态和结算没有参数，历史和导出把整个输入作为参数
+        if (command.type == ParkCommandType::History || command.type == ParkCommandType::Export) {
+            command.argument = input->toPlainText().trimmed();
+        }
+        commands.append(command);
+    } else {
+        static const QRegularExpression separators("[\\s,，;；、]+");
+        const QStringList plates = input->toPlainText().split(separators);
+        for (const QString &plate : plates) {
+            if (plate.isEmpty()) continue;
+            command.plate = PlateKey(plate);
+            if (!command.plate.isValid()) {
+                addResult(QString("%1：车牌号无效，最多 %2 个字符").arg(plate).arg(PlateKey::kMaxLength), false);
+                continue;
+            }
+            commands.append(command);
+        }
+        if (commands.isEmpty() && plates.join(QString()).isEmpty()) {
+            addResult("请输入车牌号", false);
+            return;
+        }
+    }
+    input->clear();
+    if (!commands.isEmpty()) emit commandsSubmitted(commands);
+}
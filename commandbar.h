@@ -0,0 +1,49 @@
+#ifndef COMMANDBAR_H
+#define COMMANDBAR_H
+
+#include <QVector>
+#include <QWidget>
+
+#include "parkingservice.h"
+
+class QComboBox;
+class QLabel;
+class QListWidget;
+class QPlainTextEdit;
+
+// 命令栏：代替入库、出库、查询等模态对话框的非模态入口。选择操作、车型和类别后输入车牌回车提交，
+// 粘贴的多个车牌（换行、空格、逗号或顿号分隔）作为一批提交；结果逐条显示在下方，最新的在最上面。
+// 结算、历史和导出同样在这里提交，历史的时段和导出的路径写在输入框中，明细显示在结果栏。
+// 提交后立即可以继续输入，命令在停车场工作线程上排队执行
+class CommandBar : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CommandBar(QWidget *parent = nullptr);
+
+    void setAction(ParkCommandType type);     // 切换操作并把焦点放到输入框
+    void setInputText(const QString &text);
+    void addResult(const QString &text, bool ok = true);
+    void addResults(const QStringList &lines, bool ok = true);  // 多行结果按原顺序放在最上面
+    void setPendingCount(int count);          // 已提交、尚未执行的命令数
+
+signals:
+    void commandsSubmitted(const QVector<ParkCommand> &commands);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void submit();
+    void updateOptions();
+
+    QComboBox *actionBox;
+    QComboBox *classBox;
+    QComboBox *priorityBox;
+    QPlainTextEdit *input;
+    QLabel *pendingLabel;
+    QListWidget *results;
+};
+
+#endif // COMMANDBAR_H
@@ -0,0 +1,188 @@
+#include "concurrentparkingengine.h"
+
+#include <QMutexLocker>
+
+namespace {
+
+int countTrailingZeros(quint64 value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int n = 0;
+    while (!(value & 1)) { value >>= 1; ++n; }
+    return n;
+#endif
+}
+
+uint roundUpToPowerOfTwo(int value) {
+    uint result = 1;
+    while (result < uint(qMax(1, value))) result <<= 1;
+    return result;
+}
+
+} // namespace
+
+// ConcurrentParkingEngine 实现
+ConcurrentParkingEngine::ConcurrentParkingEngine(int totalSpots, int maxQueueCapacity, int shardCount,
+                                                 const Clock *clock)
+    : totalSpots(totalSpots), clock(clock),
+    shardMask(roundUpToPowerOfTwo(shardCount) - 1),
+    shards(new Shard[shardMask + 1]),
+    wordCount((totalSpots + 63) / 64),
+    freeBits(new std::atomic<quint64>[qMax(1, wordCount)]),
+    freeCount(totalSpots), waitingQueue(maxQueueCapacity) {
+    for (int w = 0; w < wordCount; ++w) {
+        int bitsInWord = qMin(64, totalSpots - w * 64);
+        freeBits[w].store(bitsInWord == 64 ? ~quint64(0) : (quint64(1) << bitsInWord) - 1, std::memory_order_relaxed);
+    }
+}
+
+ConcurrentParkingEngine::~ConcurrentParkingEngine() = default;
+
+ConcurrentParkingEngine::Shard &ConcurrentParkingEngine::shardFor(const PlateKey &plate) const {
+    return shards[qHash(plate, 0) & shardMask];
+}
+
+// 先预留空闲计数，再在位图中抢占一个置位；预留成功就一定能找到车位。
+// 从 hint 对应的字上开始扫描，让不同车牌分散到位图的不同位置，减少 CAS 冲突。
+int ConcurrentParkingEngine::tryClaimSpot(uint hint) {
+    int available = freeCount.load(std::memory_order_relaxed);
+    do {
+        if (available <= 0) return -1;
+    } while (!freeCount.compare_exchange_weak(available, available - 1,
+                                              std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    int start = wordCount > 0 ? int(hint % uint(wordCount)) : 0;
+    for (;;) {
+        for (int i = 0; i < wordCount; ++i) {
+            int w = start + i < wordCount ? start + i : start + i - wordCount;
+            quint64 bits = freeBits[w].load(std::memory_order_acquire);
+            while (bits) {
+                quint64 lowest = bits & (~bits + 1);
+                if (freeBits[w].compare_exchange_weak(bits, bits & ~lowest,
+                                                      std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return w * 64 + countTrailingZeros(lowest);
+                }
+            }
+        }
+    }
+}
+
+// 先置位再增加计数，保证“置位数 >= 空闲计数”，预留方不会空转
+void ConcurrentParkingEngine::freeSpot(int spot) {
+    freeBits[spot / 64].fetch_or(quint64(1) << (spot % 64), std::memory_order_release);
+    freeCount.fetch_add(1, std::memory_order_release);
+}
+
+ConcurrentParkingEngine::ParkResult ConcurrentParkingEngine::parkOrEnqueue(const PlateKey &plate,
+                                                                          PriorityClass priorityClass) {
+    if (!plate.isValid()) {
+        return {ParkStatus::InvalidPlate, -1};
+    }
+    Shard &shard = shardFor(plate);
+    QMutexLocker shardLocker(&shard.mutex);
+
+    if (shard.entries.contains(plate)) {
+        return {ParkStatus::Duplicate, -1};
+    }
+
+    qint64 now = clock->now();
+    uint hint = uint(qHash(plate, 1));
+    int spot = tryClaimSpot(hint);
+    if (spot < 0) {
+        // 车位已满：在队列锁内再试一次，和出库时“交给队首或归还车位”的判断互斥，
+        // 避免车辆进入队列的同时有车位被归还而无人认领
+        QMutexLocker queueLocker(&queueMutex);
+        spot = tryClaimSpot(hint);
+        if (spot < 0) {
+            if (waitingQueue.isQueueFull()) {
+                return {ParkStatus::QueueFull, -1};
+            }
+            waitingQueue.addVehicleToQueue(Vehicle(plate, now, VehicleClass::Standard, priorityClass));
+            shard.entries.insert(plate, Entry{-1, now});
+            return {ParkStatus::Queued, -1};
+        }
+    }
+
+    shard.entries.insert(plate, Entry{spot, now});
+    return {ParkStatus::Parked, spot};
+}
+
+ConcurrentParkingEngine::ReleaseResult ConcurrentParkingEngine::releaseVehicle(const PlateKey &plate) {
+    ReleaseResult result{false, -1, 0, PlateKey()};
+    {
+        Shard &shard = shardFor(plate);
+        QMutexLocker shardLocker(&shard.mutex);
+        auto it = shard.entries.find(plate);
+        if (it == shard.entries.end() || it->spot < 0) {
+            return result;
+        }
+        result.released = true;
+        result.spot = it->spot;
+        result.entryTime = it->entryTime;
+        shard.entries.erase(it);
+    }
+
+    // 腾出的车位直接交给队首车辆；队列为空才归还到位图
+    PlateKey promoted;
+    {
+        QMutexLocker queueLocker(&queueMutex);
+        if (waitingQueue.isQueueEmpty()) {
+            freeSpot(result.spot);
+            return result;
+        }
+        promoted = waitingQueue.dequeueVehicle().getPlateKey();
+    }
+
+    // 不持有队列锁再去拿分片锁，锁顺序始终是“分片 -> 队列”
+    Shard &promotedShard = shardFor(promoted);
+    QMutexLocker promotedLocker(&promotedShard.mutex);
+    auto it = promotedShard.entries.find(promoted);
+    if (it != promotedShard.entries.end()) {
+        it->spot = result.spot;  // 保留进入队列时的时间，与界面逻辑一致
+        result.promotedPlate = promoted;
+    } else {
+        freeSpot(result.spot);
+    }
+    return result;
+}
+
+bool ConcurrentParkingEngine::cancelQueuedVehicle(const PlateKey &plate) {
+    Shard &shard = shardFor(plate);
+    QMutexLocker shardLocker(&shard.mutex);
+    auto it = shard.entries.find(plate);
+    if (it == shard.entries.end() || it->spot >= 0) {
+        return false;
+    }
+
+    QMutexLocker queueLocker(&queueMutex);
+    // 可能已被出库线程取出、正等待写入车位号，此时视为已放行
+    if (!waitingQueue.removeVehicleFromQueue(plate)) {
+        return false;
+    }
+    shard.entries.erase(it);
+    return true;
+}
+
+bool ConcurrentParkingEngine::hasVehicle(const PlateKey &plate) const {
+    return findSpot(plate) >= 0;
+}
+
+bool ConcurrentParkingEngine::hasVehicleInQueue(const PlateKey &plate) const {
+    Shard &shard = shardFor(plate);
+    QMutexLocker shardLocker(&shard.mutex);
+    auto it = shard.entries.constFind(plate);
+    return it != shard.entries.constEnd() && it->spot < 0;
+}
+
+int ConcurrentParkingEngine::findSpot(const PlateKey &plate) const {
+    Shard &shard = shardFor(plate);
+    QMutexLocker shardLocker(&shard.mutex);
+    auto it = shard.entries.constFind(plate);
+    return it != shard.entries.constEnd() ? it->spot : -1;
+}
+
+int ConcurrentParkingEngine::getQueueLength() const {
+    QMutexLocker queueLocker(&queueMutex);
+    return waitingQueue.getQueueLength();
+}
@@ -0,0 +1,85 @@
+#ifndef CONCURRENTPARKINGENGINE_H
+#define CONCURRENTPARKINGENGINE_H
+
+#include <QHash>
+#include <QMutex>
+
+#include "clock.h"
+#include "platekey.h"
+#include "queuemanager.h"
+
+#include <atomic>
+#include <memory>
+
+// ConcurrentParkingEngine 类
+// 多个出入口闸机线程同时入库、出库的基准测试原型，只编进 park_bench，停车场本身不使用它。
+// 车牌索引按车牌哈希分片，每个分片一把锁；车位用原子位图无锁抢占；
+// 只有车位已满时才经过等待队列锁，使“入库或排队”与“出库后放行队首”保持原子。
+// 车牌与 ParkingLot 一样按 PlateKey 规范化，等待队列复用 QueueManager，按排队类别放行，放弃排队为 O(1)。
+// 车位不区分尺寸和保留类别，也不通知观察者（不写预写日志），不能替换 ParkingSpotManager/QueueManager；
+// 停车场仍由 lotMutex 保护的单线程路径修改。
+class ConcurrentParkingEngine {
+public:
+    enum class ParkStatus { Parked, Queued, Duplicate, QueueFull, InvalidPlate };
+    struct ParkResult {
+        ParkStatus status;
+        int spot;           // Parked 时为车位号，否则为 -1
+    };
+
+    struct ReleaseResult {
+        bool released;      // 车辆不在车位上时为 false
+        int spot;           // 腾出的车位号
+        qint64 entryTime;   // 入场时间（毫秒时间戳），用于计费
+        PlateKey promotedPlate;  // 从等待队列放行到该车位的车牌，没有则为无效键
+    };
+
+    ConcurrentParkingEngine(int totalSpots, int maxQueueCapacity, int shardCount = 64,
+                            const Clock *clock = Clock::system());
+    ~ConcurrentParkingEngine();
+
+    ConcurrentParkingEngine(const ConcurrentParkingEngine &) = delete;
+    ConcurrentParkingEngine &operator=(const ConcurrentParkingEngine &) = delete;
+
+    ParkResult parkOrEnqueue(const PlateKey &plate, PriorityClass priorityClass = PriorityClass::Regular);
+    ReleaseResult releaseVehicle(const PlateKey &plate);
+    bool cancelQueuedVehicle(const PlateKey &plate);
+
+    bool hasVehicle(const PlateKey &plate) const;
+    bool hasVehicleInQueue(const PlateKey &plate) const;
+    int findSpot(const PlateKey &plate) const;  // 未找到或仍在排队时返回 -1
+    bool isFull() const { return getFreeCount() == 0; }
+    int getFreeCount() const { return freeCount.load(std::memory_order_acquire); }
+    int getParkedCount() const { return totalSpots - getFreeCount(); }
+    int getQueueLength() const;
+    int getTotalSpots() const { return totalSpots; }
+    int getMaxCapacity() const { return waitingQueue.getMaxCapacity(); }
+
+private:
+    struct Entry {
+        int spot;           // -1 表示在等待队列中
+        qint64 entryTime;
+    };
+
+    struct alignas(64) Shard {
+        mutable QMutex mutex;
+        QHash<PlateKey, Entry> entries;
+    };
+
+    Shard &shardFor(const PlateKey &plate) const;
+    int tryClaimSpot(uint hint);
+    void freeSpot(int spot);
+
+    int totalSpots;
+    const Clock *clock;
+    uint shardMask;
+    std::unique_ptr<Shard[]> shards;
+
+    int wordCount;
+    std::unique_ptr<std::atomic<quint64>[]> freeBits;  // 置位表示车位空闲
+    alignas(64) std::atomic<int> freeCount;
+
+    alignas(64) mutable QMutex queueMutex;
+    QueueManager waitingQueue;
+};
+
+#endif // CONCURRENTPARKINGENGINE_H
@@ -0,0 +1,125 @@
+#include "diagnosticspanel.h"
+#include "tracing.h"
+
+#include <QComboBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+
+const QStringList kColumnNames = {"次数", "平均 (µs)", "p50 (µs)", "p99 (µs)", "p99.9 (µs)", "最大 (µs)"};
+
+QString microsText(double nanoseconds)
+{
+    return QString::number(nanoseconds / 1000.0, 'f', nanoseconds < 10000 ? 2 : 0);
+}
+
+} // namespace
+
+// DiagnosticsPanel 实现
+DiagnosticsPanel::DiagnosticsPanel(QWidget *parent)
+    : QWidget(parent, Qt::Window), modeBox(new QComboBox(this)),
+    table(new QTableWidget(kTracePointCount, kColumnNames.size(), this)), refreshTimer(new QTimer(this))
+{
+    modeBox->addItem("关闭", int(TraceMode::Off));
+    modeBox->addItem("延迟直方图", int(TraceMode::Histogram));
+    modeBox->addItem("直方图 + 时间线", int(TraceMode::Timeline));
+    modeBox->setCurrentIndex(modeBox->findData(int(Tracer::mode())));
+    connect(modeBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) {
+        Tracer::setMode(TraceMode(modeBox->currentData().toInt()));
+    });
+
+    QStringList rowNames;
+    for (int point = 0; point < kTracePointCount; ++point) rowNames.append(tracePointName(TracePoint(point)));
+    table->setHorizontalHeaderLabels(kColumnNames);
+    table->setVerticalHeaderLabels(rowNames);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for (int row = 0; row < kTracePointCount; ++row) {
+        for (int column = 0; column < kColumnNames.size(); ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(row, column, item);
+        }
+    }
+
+    QPushButton *resetButton = new QPushButton("清零", this);
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        Tracer::reset();
+        refresh();
+    });
+    QPushButton *exportButton = new QPushButton("导出 Chrome 跟踪", this);
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsPanel::exportTrace);
+
+    refreshTimer->setInterval(1000);
+    connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::refresh);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    topLayout->addWidget(new QLabel("计时模式:", this));
+    topLayout->addWidget(modeBox);
+    topLayout->addStretch(1);
+    topLayout->addWidget(resetButton);
+    topLayout->addWidget(exportButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(topLayout);
+    layout->addWidget(table, 1);
+    setLayout(layout);
+    setWindowTitle("性能诊断");
+    resize(640, 520);
+}
+
+void DiagnosticsPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void DiagnosticsPanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer->stop();  // 不可见时不刷新
+}
+
+void DiagnosticsPanel::refresh()
+{
+    const QVector<TraceStats> stats = Tracer::stats();
+    for (int row = 0; row < stats.size(); ++row) {
+        const TraceStats &point = stats[row];
+        const QStringList values = {
+            QString::number(point.count),
+            point.count > 0 ? microsText(double(point.totalNs) / point.count) : QString("-"),
+            point.count > 0 ? microsText(point.p50Ns) : QString("-"),
+            point.count > 0 ? microsText(point.p99Ns) : QString("-"),
+            point.count > 0 ? microsText(point.p999Ns) : QString("-"),
+            point.count > 0 ? microsText(point.maxNs) : QString("-")
+        };
+        for (int column = 0; column < values.size(); ++column) {
+            table->item(row, column)->setText(values[column]);
+        }
+    }
+}
+
+void DiagnosticsPanel::exportTrace()
+{
+    if (Tracer::mode() != TraceMode::Timeline) {
+        QMessageBox::information(this, "导出 Chrome 跟踪", "只有“直方图 + 时间线”模式会记录逐次事件，请先切换模式并操作一段时间。");
+        return;
+    }
+    QString filePath = QFileDialog::getSaveFileName(this, "导出 Chrome 跟踪", "park-trace.json", "JSON 文件 (*.json)");
+    if (filePath.isEmpty()) return;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(Tracer::chromeTrace()) < 0 || !file.commit()) {
+        QMessageBox::warning(this, "导出失败", QString("无法写入文件：%1").arg(filePath));
+    }
+}
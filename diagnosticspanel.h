@@ -0,0 +1,32 @@
+#ifndef DIAGNOSTICSPANEL_H
+#define DIAGNOSTICSPANEL_H
+
+#include <QWidget>
+
+class QComboBox;
+class QTableWidget;
+class QTimer;
+
+// 诊断面板：切换计时模式，按代码位置显示次数、平均和分位数延迟，
+// 时间线模式下可导出 Chrome trace-event JSON；可见时每秒刷新一次
+class DiagnosticsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsPanel(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+    void exportTrace();
+
+    QComboBox *modeBox;
+    QTableWidget *table;
+    QTimer *refreshTimer;
+};
+
+#endif // DIAGNOSTICSPANEL_H
@@ -0,0 +1,94 @@
+#include "gateeventprocessor.h"
+#include "tracing.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+
+namespace {
+const int kMaxBatchSize = 4096;
+}
+
+// GateEventProcessor 实现
+GateEventProcessor::GateEventProcessor(ParkingLot *parkingLot, int ringCapacity, QObject *parent)
+    : QObject(parent), parkingLot(parkingLot), ring(ringCapacity), drainScheduled(false) {
+    qRegisterMetaType<GateBatchSummary>("GateBatchSummary");
+    batch.reserve(kMaxBatchSize);
+}
+
+bool GateEventProcessor::submit(const GateEvent &event) {
+    if (!ring.tryPush(event)) {
+        return false;
+    }
+    // 一次突发只投递一个处理请求，后续事件由同一次 processPending 一起取走
+    if (!drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, "processPending", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void GateEventProcessor::processPending() {
+    PARK_TRACE_SCOPE(GateBatch);
+    // 先清标志再取数据：之后推入的事件要么被本次取走，要么会重新投递处理请求
+    drainScheduled.store(false, std::memory_order_release);
+
+    GateBatchSummary summary;
+    for (;;) {
+        batch.clear();
+        if (ring.drain(batch, kMaxBatchSize) == 0) break;
+        QMutexLocker locker(lotMutex);
+        for (const GateEvent &event : batch) {
+            apply(event, summary);
+        }
+    }
+    batch.clear();
+
+    if (summary.applied > 0) {
+        emit batchApplied(summary);
+    }
+}
+
+void GateEventProcessor::apply(const GateEvent &event, GateBatchSummary &summary) {
+    ++summary.applied;
+    switch (event.type) {
+    case GateEventType::Enter: {
+        qint64 entryTime = event.timestamp > 0 ? event.timestamp : parkingLot->getClock()->now();
+        ParkingLot::ParkResult result = parkingLot->parkOrEnqueue(Vehicle(event.licensePlate, entryTime, event.vehicleClass));
+        if (result.status == ParkingLot::ParkStatus::Parked) {
+            ++summary.parked;
+            summary.changedSpots.append(result.spot);
+        } else if (result.status == ParkingLot::ParkStatus::Queued) {
+            ++summary.queued;
+            summary.queueChanged = true;
+        } else {
+            ++summary.rejected;
+        }
+        break;
+    }
+    case GateEventType::Exit: {
+        ParkingLot::SpotResult released = parkingLot->releaseVehicle(PlateKey(event.licensePlate));
+        if (released.spot < 0) {
+            ++summary.rejected;
+            break;
+        }
+        ++summary.released;
+        summary.changedSpots.append(released.spot);
+
+        // 闸机路径没有动画，腾出的车位立即放行队首车辆
+        ParkingLot::SpotResult promoted = parkingLot->promoteNextVehicle();
+        if (promoted.spot >= 0) {
+            ++summary.promoted;
+            summary.changedSpots.append(promoted.spot);
+            summary.queueChanged = true;
+        }
+        break;
+    }
+    case GateEventType::CancelQueue:
+        if (parkingLot->cancelQueuedVehicle(PlateKey(event.licensePlate))) {
+            ++summary.cancelled;
+            summary.queueChanged = true;
+        } else {
+            ++summary.rejected;
+        }
+        break;
+    }
+}
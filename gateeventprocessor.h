@@ -0,0 +1,57 @@
+#ifndef GATEEVENTPROCESSOR_H
+#define GATEEVENTPROCESSOR_H
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+#include <atomic>
+
+#include "gateeventring.h"
+#include "parkinglot.h"
+
+// 一批闸机事件应用到停车场后的汇总，界面据此一次性刷新
+struct GateBatchSummary {
+    int applied = 0;
+    int parked = 0;
+    int queued = 0;
+    int released = 0;
+    int promoted = 0;
+    int cancelled = 0;
+    int rejected = 0;              // 重复车牌、队列已满或找不到车辆
+    QVector<int> changedSpots;     // 状态发生变化的车位号
+    bool queueChanged = false;
+};
+Q_DECLARE_METATYPE(GateBatchSummary)
+
+// GateEventProcessor 类
+// 闸机线程通过 submit 把事件无锁地推入环形缓冲区；处理器在自己所属的线程上批量取出，
+// 按与界面相同的规则应用到 ParkingLot，每批只发出一次 batchApplied 通知。
+// 目前还没有接入真实的闸机来源，只由 park_bench 的突发场景驱动；应用和无界面服务都经 ParkingService 修改停车场。
+class GateEventProcessor : public QObject {
+    Q_OBJECT
+
+public:
+    GateEventProcessor(ParkingLot *parkingLot, int ringCapacity = 65536, QObject *parent = nullptr);
+
+    bool submit(const GateEvent &event);  // 线程安全；缓冲区已满时返回 false，由调用方重试
+    // 停车场在其他线程上也被读取时，应用每批事件期间持有该锁
+    void setLotMutex(QMutex *mutex) { lotMutex = mutex; }
+
+public slots:
+    void processPending();
+
+signals:
+    void batchApplied(const GateBatchSummary &summary);
+
+private:
+    void apply(const GateEvent &event, GateBatchSummary &summary);
+
+    ParkingLot *parkingLot;
+    QMutex *lotMutex = nullptr;
+    GateEventRing ring;
+    std::atomic<bool> drainScheduled;
+    QVector<GateEvent> batch;
+};
+
+#endif // GATEEVENTPROCESSOR_H
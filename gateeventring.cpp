@@ -0,0 +1,52 @@
+#include "gateeventring.h"
+
+#include <QtGlobal>
+
+// GateEventRing 实现
+GateEventRing::GateEventRing(int capacity) : enqueuePos(0), dequeuePos(0) {
+    size_t size = 2;
+    while (size < size_t(qMax(2, capacity))) size <<= 1;
+    mask = size - 1;
+    cells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool GateEventRing::tryPush(const GateEvent &event) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = cells[pos & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占写入位置
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.event = event;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // 消费者还没取走一整圈前的数据，缓冲区已满
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+int GateEventRing::drain(QVector<GateEvent> &out, int maxCount) {
+    int count = 0;
+    while (count < maxCount) {
+        Cell &cell = cells[dequeuePos & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeuePos + 1) {
+            break;  // 下一个槽位尚未写完
+        }
+        out.append(std::move(cell.event));
+        cell.event = GateEvent();
+        cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        ++count;
+    }
+    return count;
+}
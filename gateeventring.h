@@ -0,0 +1,50 @@
+#ifndef GATEEVENTRING_H
+#define GATEEVENTRING_H
+
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "vehicle.h"
+
+// 闸机事件：车牌识别相机和道闸传感器上报的一次进场、出场或放弃排队
+enum class GateEventType : quint8 { Enter, Exit, CancelQueue };
+
+struct GateEvent {
+    GateEventType type = GateEventType::Enter;
+    QString licensePlate;
+    qint64 timestamp = 0;   // 事件发生时间（毫秒时间戳）
+    int gate = 0;           // 上报的闸机编号
+    VehicleClass vehicleClass = VehicleClass::Standard;  // 车牌识别给出的车辆类型，仅入场事件使用
+};
+
+// GateEventRing 类
+// 固定容量的无锁多生产者单消费者环形缓冲区（按槽位序号实现，参考 Vyukov 有界队列）。
+// 任意线程可调用 tryPush；只允许一个线程调用 drain。
+class GateEventRing {
+public:
+    explicit GateEventRing(int capacity);  // 容量向上取整为 2 的幂
+
+    GateEventRing(const GateEventRing &) = delete;
+    GateEventRing &operator=(const GateEventRing &) = delete;
+
+    bool tryPush(const GateEvent &event);              // 缓冲区满时返回 false
+    int drain(QVector<GateEvent> &out, int maxCount);  // 追加到 out，返回取出的数量
+    int capacity() const { return int(mask + 1); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        GateEvent event;
+    };
+
+    size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;  // 仅消费者线程访问
+};
+
+#endif // GATEEVENTRING_H
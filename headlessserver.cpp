@@ -0,0 +1,145 @@
+#include "headlessserver.h"
+#include "lotstartup.h"
+#include "stayhistory.h"
+
+#include <QCoreApplication>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <cstdio>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_UNIX
+int signalPipe[2] = {-1, -1};
+
+void onTerminationSignal(int) {
+    char byte = 1;
+    ssize_t written = ::write(signalPipe[1], &byte, 1);  // 只做异步信号安全的操作
+    (void)written;
+}
+#endif
+
+#ifdef Q_OS_WIN
+BOOL WINAPI onConsoleControl(DWORD) {
+    // 控制台事件在单独的线程中回调，排队到主线程退出
+    QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+    return TRUE;
+}
+#endif
+
+} // namespace
+
+// HeadlessServer 实现
+HeadlessServer::HeadlessServer(const LotConfig &config, const Clock *clock, QObject *parent)
+    : QObject(parent), config(config), parkingLot(10, 5, clock), service(&parkingLot, &tariffEngine),
+      server(new ParkServer(&service, this)) {}
+
+HeadlessServer::~HeadlessServer() {
+    if (occupancy) {
+        parkingLot.setAllocationPolicy(std::make_shared<NearestEntrancePolicy>());  // 楼层均衡策略引用 occupancy
+        parkingLot.removeObserver(occupancy);
+        delete occupancy;
+    }
+    if (history) {
+        // 不在退出时封存：尚未封存的记录留在 active.bin 中，下次启动时读回，避免每次重启都多出一个小段
+        parkingLot.removeObserver(history);
+        delete history;
+    }
+    if (journal) {
+        server->setJournal(nullptr);  // 日志销毁后写盘线程不再回调服务器
+        parkingLot.removeObserver(journal);
+        journal->checkpoint(parkingLot);
+        delete journal;
+    }
+}
+
+void HeadlessServer::quitOnTerminationSignals() {
+#ifdef Q_OS_UNIX
+    if (signalPipe[0] >= 0) return;
+    if (::pipe(signalPipe) != 0) {
+        std::fprintf(stderr, "无法创建信号管道，收到退出信号时不会写快照\n");
+        return;
+    }
+    for (int fd : signalPipe) ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    ::fcntl(signalPipe[1], F_SETFL, O_NONBLOCK);
+
+    QSocketNotifier *notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, []() {
+        char byte;
+        ssize_t received = ::read(signalPipe[0], &byte, 1);
+        (void)received;
+        std::fprintf(stderr, "收到退出信号，写入快照后退出\n");
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = onTerminationSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    for (int signalNumber : {SIGINT, SIGTERM, SIGHUP}) ::sigaction(signalNumber, &action, nullptr);
+#elif defined(Q_OS_WIN)
+    SetConsoleCtrlHandler(onConsoleControl, TRUE);
+#endif
+}
+
+bool HeadlessServer::start(QString *error) {
+    // 没有可恢复或导入的状态时不询问，用配置的容量或与界面相同的默认值
+    LotStartup startup(config, &parkingLot, parkingLot.getClock());
+    if (!startup.restore()) {
+        startup.createLot(startup.configuredSpots() > 0 ? startup.configuredSpots() : 10,
+                          config.maxQueueCapacity > 0 ? config.maxQueueCapacity : 5);
+    }
+    startup.finish();
+    for (const QString &message : startup.getMessages()) {
+        std::fprintf(stderr, "%s\n", qPrintable(message));
+    }
+    occupancy = startup.getOccupancy();
+    journal = startup.getJournal();
+    server->setJournal(journal);
+
+    checkpointTimer = new QTimer(this);
+    checkpointTimer->setInterval(60 * 1000);
+    connect(checkpointTimer, &QTimer::timeout, this, [this]() {
+        if (journal->recordsSinceCheckpoint() > 0) journal->checkpoint(parkingLot);
+    });
+    checkpointTimer->start();
+
+    history = new StayHistory(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/history", &tariffEngine);
+    parkingLot.addObserver(history);
+    // 出库回调只把历史记到内存，每批应答写出后再写盘
+    connect(server, &ParkServer::requestsServed, this, [this]() { history->flush(); });
+
+    QStringList errors;
+    QString listenError;
+    bool listening = false;
+    if (!config.listenName.isEmpty()) {
+        if (server->listenLocal(config.listenName, &listenError)) {
+            listening = true;
+            std::fprintf(stderr, "本地套接字 %s 已就绪\n", qPrintable(config.listenName));
+        } else {
+            errors.append(listenError);
+        }
+    }
+    if (config.tcpPort > 0) {
+        if (server->listenTcp(quint16(config.tcpPort), &listenError)) {
+            listening = true;
+            std::fprintf(stderr, "TCP 127.0.0.1:%d 已就绪\n", config.tcpPort);
+        } else {
+            errors.append(listenError);
+        }
+    }
+    if (!listening && errors.isEmpty()) errors.append("本地套接字名和 TCP 端口都未配置");
+    if (error) *error = errors.join("\n");
+    return listening;
+}
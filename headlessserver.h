@@ -0,0 +1,47 @@
+#ifndef HEADLESSSERVER_H
+#define HEADLESSSERVER_H
+
+#include <QObject>
+#include <QString>
+
+#include "lotconfig.h"
+#include "parkinglot.h"
+#include "parkingservice.h"
+#include "parkserver.h"
+#include "tariff.h"
+
+class ParkingJournal;
+class QTimer;
+class StayHistory;
+class TopologyOccupancy;
+
+// HeadlessServer 类
+// park --headless 的主体：按启动配置恢复停车场，挂上预写日志和停车历史，
+// 然后只通过 ParkServer 对外服务，不创建任何窗口或对话框。
+// 状态变化由预写日志成组落盘，进程被直接结束也不丢已应答的操作；正常退出时再写一次快照。
+class HeadlessServer : public QObject {
+    Q_OBJECT
+
+public:
+    HeadlessServer(const LotConfig &config, const Clock *clock = Clock::system(), QObject *parent = nullptr);
+    ~HeadlessServer() override;
+
+    bool start(QString *error);  // 本地套接字和 TCP 都没能监听时返回 false
+
+    // 收到 SIGINT/SIGTERM/SIGHUP（Windows 上为控制台关闭事件）时退出事件循环，
+    // 让 exec() 返回、析构函数写退出快照。信号处理函数只向自管道写一个字节，其余在事件循环中完成
+    static void quitOnTerminationSignals();
+
+private:
+    LotConfig config;
+    ParkingLot parkingLot;
+    TariffEngine tariffEngine;
+    ParkingService service;
+    ParkServer *server;
+    ParkingJournal *journal = nullptr;
+    TopologyOccupancy *occupancy = nullptr;
+    StayHistory *history = nullptr;
+    QTimer *checkpointTimer = nullptr;
+};
+
+#endif // HEADLESSSERVER_H
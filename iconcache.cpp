@@ -0,0 +1,29 @@
+#include "iconcache.h"
+
+#include <QHash>
+#include <QPixmapCache>
+
+// IconCache 实现
+const QIcon &IconCache::icon(const QString &path) {
+    static QHash<QString, QIcon> icons;
+    auto it = icons.find(path);
+    if (it == icons.end()) {
+        it = icons.insert(path, QIcon(path));
+    }
+    return it.value();
+}
+
+QPixmap IconCache::pixmap(const QString &path, const QSize &size) {
+    const QString key = QString("%1@%2x%3").arg(path).arg(size.width()).arg(size.height());
+    QPixmap scaled;
+    if (!QPixmapCache::find(key, &scaled)) {
+        static QHash<QString, QPixmap> sources;  // 原图只解码一次
+        auto it = sources.find(path);
+        if (it == sources.end()) {
+            it = sources.insert(path, QPixmap(path));
+        }
+        scaled = it.value().scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        QPixmapCache::insert(key, scaled);
+    }
+    return scaled;
+}
@@ -0,0 +1,17 @@
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <QIcon>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+// IconCache 类
+// 资源图标只解码一次，按尺寸缩放后的位图放入 QPixmapCache，整个界面共享。
+class IconCache {
+public:
+    static const QIcon &icon(const QString &path);
+    static QPixmap pixmap(const QString &path, const QSize &size);
+};
+
+#endif // ICONCACHE_H
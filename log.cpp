@@ -1,20 +1,193 @@
 #include "log.h"
+#include "logspillwriter.h"
+#include "tracing.h"
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QListView>
+#include <QScrollBar>
+#include <QSortFilterProxyModel>
+#include <QThread>
+#include <QTimer>
 #include <QVBoxLayout>
-#include <QDateTime>
+
+namespace {
+const int kLogCapacity = 100000;  // 内存中最多保留的日志条数
+const int kAllTypes = -1;
+}
+
+// 按事件类型和关键字过滤日志
+class LogFilterModel : public QSortFilterProxyModel
+{
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    void setFilter(int type, const QString &text)
+    {
+        filterType = type;
+        filterText = text;
+        invalidateFilter();
+    }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override
+    {
+        QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+        if (filterType != kAllTypes && index.data(LogModel::TypeRole).toInt() != filterType) {
+            return false;
+        }
+        return filterText.isEmpty() || index.data(Qt::DisplayRole).toString().contains(filterText, Qt::CaseInsensitive);
+    }
+
+private:
+    int filterType = kAllTypes;
+    QString filterText;
+};
+
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent), buffer(capacity)
+{
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : buffer.size();
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= buffer.size()) return QVariant();
+
+    const LogEntry &entry = buffer.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return formatLogEntry(entry);  // 只有可见行才会被格式化
+    case TypeRole:
+        return int(entry.type);
+    case LicensePlateRole:
+        return entry.licensePlate;
+    case TimestampRole:
+        return entry.timestamp;
+    default:
+        return QVariant();
+    }
+}
+
+void LogModel::appendEntries(const QVector<LogEntry> &entries)
+{
+    if (entries.isEmpty()) return;
+
+    // 一批超过容量时只保留最新的部分
+    int first = qMax(0, int(entries.size()) - buffer.capacity());
+    int incoming = int(entries.size()) - first;
+
+    int overflow = buffer.size() + incoming - buffer.capacity();
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        buffer.dropOldest(overflow);
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), buffer.size(), buffer.size() + incoming - 1);
+    for (int i = first; i < entries.size(); ++i) {
+        buffer.append(entries[i]);
+    }
+    endInsertRows();
+}
 
 LogWindow::LogWindow(QWidget *parent)
-    : QWidget(parent), logTextEdit(new QTextEdit(this))
+    : QWidget(parent), logModel(new LogModel(kLogCapacity, this)),
+    filterModel(new LogFilterModel(this)), logView(new QListView(this)),
+    filterEdit(new QLineEdit(this)), typeFilter(new QComboBox(this)), flushTimer(new QTimer(this))
 {
+    qRegisterMetaType<QVector<LogEntry>>("QVector<LogEntry>");
+
+    filterModel->setSourceModel(logModel);
+    logView->setModel(filterModel);
+    logView->setUniformItemSizes(true);  // 行高一致，滚动和插入时不需要逐行测量
+    logView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    typeFilter->addItem("全部", kAllTypes);
+    for (LogEventType type : {LogEventType::Info, LogEventType::Parked, LogEventType::Queued, LogEventType::Released,
+                              LogEventType::Promoted, LogEventType::Cancelled, LogEventType::Rejected}) {
+        typeFilter->addItem(logEventTypeName(type), int(type));
+    }
+    filterEdit->setPlaceholderText("按车牌号或内容过滤");
+    filterEdit->setClearButtonEnabled(true);
+    connect(filterEdit, &QLineEdit::textChanged, this, &LogWindow::applyFilter);
+    connect(typeFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &LogWindow::applyFilter);
+
+    // 同一帧内的日志合并成一次模型更新
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(16);
+    connect(flushTimer, &QTimer::timeout, this, &LogWindow::flushPending);
+
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(typeFilter);
+    filterLayout->addWidget(filterEdit, 1);
+
     QVBoxLayout *layout = new QVBoxLayout(this);
-    logTextEdit->setReadOnly(true);  // Make the log text read-only
-    layout->addWidget(logTextEdit);
+    layout->addLayout(filterLayout);
+    layout->addWidget(logView);
     setLayout(layout);
     setWindowTitle("Parking Activity Log");
     resize(400, 300);  // Set an appropriate size for the log window
 }
 
+LogWindow::~LogWindow()
+{
+    flushPending();
+    if (spillThread) {
+        // 等写盘线程处理完已投递的日志再退出
+        QMetaObject::invokeMethod(spillWriter, [] {}, Qt::BlockingQueuedConnection);
+        spillThread->quit();
+        spillThread->wait();
+    }
+}
+
 void LogWindow::addLogMessage(const QString &message)
 {
-    QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
-    logTextEdit->append(QString("[%1] %2").arg(timestamp, message));
+    addLogEvent(LogEventType::Info, QString(), message);
+}
+
+void LogWindow::addLogEvent(LogEventType type, const QString &licensePlate, const QString &message)
+{
+    PARK_TRACE_SCOPE(LogAppend);
+    pending.append(LogEntry{clock->now(), type, licensePlate, message});
+    if (!flushTimer->isActive()) flushTimer->start();
+}
+
+void LogWindow::setSpillFile(const QString &filePath)
+{
+    if (spillThread) return;
+
+    spillThread = new QThread(this);
+    spillWriter = new LogSpillWriter(filePath);
+    spillWriter->moveToThread(spillThread);
+    connect(spillThread, &QThread::finished, spillWriter, &QObject::deleteLater);
+    connect(this, &LogWindow::spillEntries, spillWriter, &LogSpillWriter::writeEntries);
+    spillThread->start(QThread::LowPriority);
+}
+
+void LogWindow::flushPending()
+{
+    if (pending.isEmpty()) return;
+    PARK_TRACE_SCOPE(LogFlush);
+
+    QScrollBar *scrollBar = logView->verticalScrollBar();
+    bool atBottom = scrollBar->value() == scrollBar->maximum();
+
+    logModel->appendEntries(pending);
+    if (spillThread) {
+        emit spillEntries(pending);  // 排队投递到写盘线程，不阻塞界面
+    }
+    pending.clear();
+
+    if (atBottom) logView->scrollToBottom();
+}
+
+void LogWindow::applyFilter()
+{
+    filterModel->setFilter(typeFilter->currentData().toInt(), filterEdit->text());
 }
@@ -3,7 +3,41 @@
 
 #include <QWidget>
 #include <QString>
-#include <QTextEdit>
+#include <QVector>
+#include <QAbstractListModel>
+#include "clock.h"
+#include "logbuffer.h"
+
+class QComboBox;
+class QLineEdit;
+class QListView;
+class QThread;
+class QTimer;
+class LogFilterModel;
+class LogSpillWriter;
+
+// 日志列表模型，数据保存在固定容量的环形缓冲区中
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        TypeRole = Qt::UserRole + 1,
+        LicensePlateRole,
+        TimestampRole
+    };
+
+    explicit LogModel(int capacity, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void appendEntries(const QVector<LogEntry> &entries);  // 超出容量时先移除最旧的行
+
+private:
+    LogBuffer buffer;
+};
 
 class LogWindow : public QWidget
 {
@@ -11,10 +45,31 @@ class LogWindow : public QWidget
 
 public:
     explicit LogWindow(QWidget *parent = nullptr);
+    ~LogWindow();
+
     void addLogMessage(const QString &message);
+    void addLogEvent(LogEventType type, const QString &licensePlate, const QString &message);
+    void setSpillFile(const QString &filePath);  // 日志同时异步写入可轮转的磁盘文件
+    void setClock(const Clock *newClock) { clock = newClock; }  // 日志时间与停车场使用同一时钟
+
+signals:
+    void spillEntries(const QVector<LogEntry> &entries);
 
 private:
-    QTextEdit *logTextEdit;
+    void flushPending();
+    void applyFilter();
+
+    LogModel *logModel;
+    LogFilterModel *filterModel;
+    QListView *logView;
+    QLineEdit *filterEdit;
+    QComboBox *typeFilter;
+
+    QVector<LogEntry> pending;  // 本帧内追加的日志，定时合并后一次写入模型
+    QTimer *flushTimer;
+    QThread *spillThread = nullptr;
+    LogSpillWriter *spillWriter = nullptr;
+    const Clock *clock = Clock::system();
 };
 
 #endif // LOG_H
@@ -0,0 +1,47 @@
+#include "logbuffer.h"
+
+#include "clock.h"
+
+QString logEventTypeName(LogEventType type) {
+    switch (type) {
+    case LogEventType::Info: return "信息";
+    case LogEventType::Parked: return "入库";
+    case LogEventType::Queued: return "排队";
+    case LogEventType::Released: return "出库";
+    case LogEventType::Promoted: return "放行";
+    case LogEventType::Cancelled: return "取消排队";
+    case LogEventType::Rejected: return "拒绝";
+    }
+    return QString();
+}
+
+QString formatLogEntry(const LogEntry &entry) {
+    QString timestamp = formatTimestamp(entry.timestamp);
+    return QString("[%1] %2").arg(timestamp, entry.message);
+}
+
+// LogBuffer 实现
+LogBuffer::LogBuffer(int capacity) : entries(qMax(1, capacity)) {}
+
+void LogBuffer::append(const LogEntry &entry) {
+    int tail = (head + count) % capacity();
+    entries[tail] = entry;
+    if (count < capacity()) {
+        ++count;
+    } else {
+        head = (head + 1) % capacity();  // 覆盖最旧的条目
+    }
+}
+
+void LogBuffer::dropOldest(int dropCount) {
+    dropCount = qBound(0, dropCount, count);
+    for (int i = 0; i < dropCount; ++i) {
+        entries[(head + i) % capacity()] = LogEntry();  // 释放字符串
+    }
+    head = (head + dropCount) % capacity();
+    count -= dropCount;
+}
+
+const LogEntry &LogBuffer::at(int index) const {
+    return entries[(head + index) % capacity()];
+}
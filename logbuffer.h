@@ -0,0 +1,50 @@
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+// 日志事件类型
+enum class LogEventType : quint8 {
+    Info,       // 普通文本
+    Parked,     // 车辆入库
+    Queued,     // 进入等待队列
+    Released,   // 车辆出库
+    Promoted,   // 从等待队列放行入库
+    Cancelled,  // 放弃排队
+    Rejected    // 重复车牌、队列已满等被拒绝的操作
+};
+
+// 结构化日志条目：时间戳为整数，只在显示或写盘时才格式化
+struct LogEntry {
+    qint64 timestamp = 0;   // 毫秒时间戳
+    LogEventType type = LogEventType::Info;
+    QString licensePlate;
+    QString message;
+};
+Q_DECLARE_METATYPE(LogEntry)
+
+QString logEventTypeName(LogEventType type);
+QString formatLogEntry(const LogEntry &entry);  // "[yyyy-MM-dd hh:mm:ss] 消息"
+
+// LogBuffer 类
+// 固定容量的环形日志缓冲区，写满后覆盖最旧的条目，内存占用不随运行时间增长。
+class LogBuffer {
+public:
+    explicit LogBuffer(int capacity);
+
+    void append(const LogEntry &entry);
+    void dropOldest(int count);
+    const LogEntry &at(int index) const;  // 0 为最旧的条目
+    int size() const { return count; }
+    int capacity() const { return int(entries.size()); }
+    bool isFull() const { return count == capacity(); }
+
+private:
+    QVector<LogEntry> entries;
+    int head = 0;   // 最旧条目所在的位置
+    int count = 0;
+};
+
+#endif // LOGBUFFER_H
@@ -0,0 +1,37 @@
+#include "logspillwriter.h"
+
+// LogSpillWriter 实现
+LogSpillWriter::LogSpillWriter(const QString &filePath, qint64 maxFileBytes, int keepFiles)
+    : filePath(filePath), maxFileBytes(maxFileBytes), keepFiles(keepFiles) {}
+
+bool LogSpillWriter::openFile() {
+    if (file.isOpen()) return true;
+    file.setFileName(filePath);
+    return file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+void LogSpillWriter::rotate() {
+    file.close();
+    QFile::remove(QString("%1.%2").arg(filePath).arg(keepFiles));
+    for (int i = keepFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(filePath).arg(i), QString("%1.%2").arg(filePath).arg(i + 1));
+    }
+    QFile::rename(filePath, filePath + ".1");
+}
+
+void LogSpillWriter::writeEntries(const QVector<LogEntry> &entries) {
+    if (entries.isEmpty() || !openFile()) return;
+
+    // 一批日志拼成一次写入
+    QByteArray chunk;
+    for (const LogEntry &entry : entries) {
+        chunk += formatLogEntry(entry).toUtf8();
+        chunk += '\n';
+    }
+    file.write(chunk);
+    file.flush();
+
+    if (file.size() >= maxFileBytes) {
+        rotate();
+    }
+}
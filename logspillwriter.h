@@ -0,0 +1,32 @@
+#ifndef LOGSPILLWRITER_H
+#define LOGSPILLWRITER_H
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "logbuffer.h"
+
+// LogSpillWriter 类
+// 在后台线程把日志批量追加到磁盘文件，文件超过上限时轮转：
+// park.log -> park.log.1 -> ... -> park.log.N，最旧的文件被删除。
+class LogSpillWriter : public QObject {
+    Q_OBJECT
+
+public:
+    LogSpillWriter(const QString &filePath, qint64 maxFileBytes = 8 * 1024 * 1024, int keepFiles = 5);
+
+public slots:
+    void writeEntries(const QVector<LogEntry> &entries);
+
+private:
+    bool openFile();
+    void rotate();
+
+    QString filePath;
+    qint64 maxFileBytes;
+    int keepFiles;
+    QFile file;
+};
+
+#endif // LOGSPILLWRITER_H
@@ -0,0 +1,244 @@
+#include "lotanalytics.h"
+#include "clock.h"
+
+#include <QDateTime>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+const qint64 kMSecsPerMinute = 60 * 1000;
+const qint64 kMSecsPerHour = 60 * kMSecsPerMinute;
+
+qint64 alignDown(qint64 time, qint64 width) {
+    qint64 quotient = time / width;
+    if (time % width != 0 && time < 0) --quotient;
+    return quotient * width;
+}
+
+} // namespace
+
+void AnalyticsWindow::merge(const AnalyticsWindow &other) {
+    arrivals += other.arrivals;
+    departures += other.departures;
+    queued += other.queued;
+    promoted += other.promoted;
+    cancelled += other.cancelled;
+    rejected += other.rejected;
+    revenueCents += other.revenueCents;
+    occupancyMSecs += other.occupancyMSecs;
+    peakParked = qMax(peakParked, other.peakParked);
+    peakQueued = qMax(peakQueued, other.peakQueued);
+    dwell.merge(other.dwell);
+    wait.merge(other.wait);
+}
+
+double AnalyticsWindow::averageParked() const {
+    return end > start ? double(occupancyMSecs) / double(end - start) : 0.0;
+}
+
+double AnalyticsWindow::revenuePerHour() const {
+    return end > start ? revenueCents / 100.0 * kMSecsPerHour / double(end - start) : 0.0;
+}
+
+double AnalyticsWindow::rejectionRate() const {
+    return arrivals > 0 ? double(rejected) / arrivals : 0.0;
+}
+
+// LotAnalytics 实现
+LotAnalytics::LotAnalytics(const ParkingLot *parkingLot, const TariffEngine *tariff)
+    : parkingLot(parkingLot), tariff(tariff),
+    parked(parkingLot->getSpotManager().getParkedCount()),
+    queueLength(parkingLot->getQueueManager().getQueueLength()),
+    lastTime(parkingLot->getClock()->now()), startedAt(lastTime) {
+    minutes.buckets.resize(kMinuteBuckets);
+    minutes.width = kMSecsPerMinute;
+    hours.buckets.resize(kHourBuckets);
+    hours.width = kMSecsPerHour;
+}
+
+AnalyticsWindow &LotAnalytics::bucketAt(Ring &ring, qint64 time) {
+    qint64 start = alignDown(time, ring.width);
+    int size = ring.buckets.size();
+    int index = int(((start / ring.width) % size + size) % size);
+    AnalyticsWindow &bucket = ring.buckets[index];
+    if (bucket.start != start || bucket.end == 0) {
+        // 环形数组中的旧分段已过期，就地重置
+        bucket = AnalyticsWindow();
+        bucket.start = start;
+        bucket.end = start + ring.width;
+        bucket.peakParked = parked;
+        bucket.peakQueued = queueLength;
+    }
+    return bucket;
+}
+
+void LotAnalytics::accumulate(Ring &ring, qint64 from, qint64 to) {
+    // 超出环形数组跨度的部分会被覆盖，直接跳过
+    qint64 span = ring.width * ring.buckets.size();
+    if (to - from > span) from = to - span;
+    while (from < to) {
+        AnalyticsWindow &bucket = bucketAt(ring, from);
+        qint64 until = qMin(to, bucket.start + ring.width);
+        bucket.occupancyMSecs += qint64(parked) * (until - from);
+        from = until;
+    }
+}
+
+void LotAnalytics::advanceTo(qint64 now) {
+    if (now <= lastTime) return;
+    accumulate(minutes, lastTime, now);
+    accumulate(hours, lastTime, now);
+    lastTime = now;
+}
+
+qint64 LotAnalytics::advance() {
+    advanceTo(parkingLot->getClock()->now());
+    return lastTime;
+}
+
+template <typename Update>
+void LotAnalytics::record(qint64 now, Update update) {
+    AnalyticsWindow &minute = bucketAt(minutes, now);
+    AnalyticsWindow &hour = bucketAt(hours, now);
+    update(minute);
+    update(hour);
+    for (AnalyticsWindow *bucket : {&minute, &hour}) {
+        bucket->peakParked = qMax(bucket->peakParked, parked);
+        bucket->peakQueued = qMax(bucket->peakQueued, queueLength);
+    }
+}
+
+// 每个回调先按变化前的在库数把占用时间累计到当前时刻，再更新计数
+void LotAnalytics::vehicleParked(const Vehicle &, int) {
+    qint64 now = advance();
+    bool arrival = !promoting;
+    promoting = false;
+    ++parked;
+    record(now, [&](AnalyticsWindow &bucket) {
+        if (arrival) ++bucket.arrivals;
+    });
+}
+
+void LotAnalytics::vehicleReleased(const Vehicle &vehicle, int, const ReleaseInfo &release) {
+    qint64 now = advance();
+    --parked;
+    qint64 revenue = release.feeCents >= 0 ? release.feeCents
+                                           : tariff->price(vehicle.getVehicleClass(), vehicle.getEntryTime(), now);
+    record(now, [&](AnalyticsWindow &bucket) {
+        ++bucket.departures;
+        bucket.dwell.add(now - vehicle.getEntryTime());
+        bucket.revenueCents += revenue;
+    });
+}
+
+void LotAnalytics::vehicleQueued(const Vehicle &) {
+    qint64 now = advance();
+    ++queueLength;
+    record(now, [&](AnalyticsWindow &bucket) {
+        ++bucket.arrivals;
+        ++bucket.queued;
+    });
+}
+
+void LotAnalytics::vehicleDequeued(const Vehicle &vehicle) {
+    qint64 now = advance();
+    --queueLength;
+    promoting = true;
+    record(now, [&](AnalyticsWindow &bucket) {
+        ++bucket.promoted;
+        bucket.wait.add(now - vehicle.getEntryTime());
+    });
+}
+
+void LotAnalytics::queueCancelled(const Vehicle &) {
+    qint64 now = advance();
+    --queueLength;
+    record(now, [&](AnalyticsWindow &bucket) {
+        ++bucket.cancelled;
+    });
+}
+
+void LotAnalytics::vehicleRejected(const Vehicle &) {
+    qint64 now = advance();
+    record(now, [&](AnalyticsWindow &bucket) {
+        ++bucket.arrivals;
+        ++bucket.rejected;
+    });
+}
+
+AnalyticsWindow LotAnalytics::mergeSince(const Ring &ring, qint64 since) const {
+    AnalyticsWindow window;
+    window.start = qMax(since, startedAt);  // 分析启动之前没有数据，不计入平均值
+    window.end = lastTime;
+    for (const AnalyticsWindow &bucket : ring.buckets) {
+        if (bucket.end > since && bucket.start <= lastTime && bucket.end != 0) {
+            window.merge(bucket);
+        }
+    }
+    if (window.end < window.start) window.end = window.start;
+    return window;
+}
+
+AnalyticsWindow LotAnalytics::lastHour() const {
+    // 最近 60 个分钟分段，起点对齐到分钟
+    return mergeSince(minutes, alignDown(lastTime, kMSecsPerMinute) - (kMinuteBuckets - 1) * kMSecsPerMinute);
+}
+
+AnalyticsWindow LotAnalytics::today() const {
+    QDateTime local = QDateTime::fromMSecsSinceEpoch(lastTime);
+    qint64 midnight = QDateTime(local.date(), QTime(0, 0)).toMSecsSinceEpoch();
+    return mergeSince(hours, midnight);
+}
+
+QVector<double> LotAnalytics::minuteOccupancy() const {
+    QVector<double> curve;
+    curve.reserve(kMinuteBuckets);
+    qint64 current = alignDown(lastTime, kMSecsPerMinute);
+    for (int i = kMinuteBuckets - 1; i >= 0; --i) {
+        qint64 start = current - i * kMSecsPerMinute;
+        int index = int(((start / kMSecsPerMinute) % kMinuteBuckets + kMinuteBuckets) % kMinuteBuckets);
+        const AnalyticsWindow &bucket = minutes.buckets[index];
+        if (bucket.start != start || bucket.end == 0) {
+            curve.append(-1);  // 该分钟没有数据（分析启动之前）
+            continue;
+        }
+        qint64 end = qMin(bucket.end, lastTime);
+        curve.append(end > start ? double(bucket.occupancyMSecs) / double(end - start) : parked);
+    }
+    return curve;
+}
+
+QVector<AnalyticsWindow> LotAnalytics::hourlyWindows() const {
+    QVector<AnalyticsWindow> windows;
+    for (const AnalyticsWindow &bucket : hours.buckets) {
+        if (bucket.end != 0 && bucket.start <= lastTime) {
+            AnalyticsWindow window = bucket;
+            window.end = qMin(bucket.end, lastTime);
+            windows.append(window);
+        }
+    }
+    std::sort(windows.begin(), windows.end(), [](const AnalyticsWindow &a, const AnalyticsWindow &b) {
+        return a.start < b.start;
+    });
+    return windows;
+}
+
+QString LotAnalytics::toCsv() const {
+    QString csv;
+    QTextStream out(&csv);
+    out << "hour_start,arrivals,departures,queued,promoted,cancelled,rejected,avg_parked,peak_parked,peak_queued,"
+           "revenue,dwell_p50_min,dwell_p95_min,dwell_p99_min,wait_p50_min,wait_p95_min,wait_p99_min\n";
+    auto minutesOf = [](qint64 msecs) { return QString::number(double(msecs) / kMSecsPerMinute, 'f', 1); };
+    for (const AnalyticsWindow &window : hourlyWindows()) {
+        out << formatTimestamp(window.start) << ',' << window.arrivals << ',' << window.departures << ','
+            << window.queued << ',' << window.promoted << ',' << window.cancelled << ',' << window.rejected << ','
+            << QString::number(window.averageParked(), 'f', 2) << ',' << window.peakParked << ','
+            << window.peakQueued << ',' << TariffEngine::formatCents(window.revenueCents) << ','
+            << minutesOf(window.dwell.quantile(0.50)) << ',' << minutesOf(window.dwell.quantile(0.95)) << ','
+            << minutesOf(window.dwell.quantile(0.99)) << ',' << minutesOf(window.wait.quantile(0.50)) << ','
+            << minutesOf(window.wait.quantile(0.95)) << ',' << minutesOf(window.wait.quantile(0.99)) << '\n';
+    }
+    return csv;
+}
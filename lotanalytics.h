@@ -0,0 +1,84 @@
+#ifndef LOTANALYTICS_H
+#define LOTANALYTICS_H
+
+#include <QString>
+#include <QVector>
+
+#include "parkinglot.h"
+#include "quantilesketch.h"
+#include "tariff.h"
+
+// 一个时间窗口内的运营指标，可以逐段合并
+struct AnalyticsWindow {
+    qint64 start = 0;               // 窗口起止时间（毫秒时间戳）
+    qint64 end = 0;
+    int arrivals = 0;               // 到达车辆（直接入库 + 排队 + 被拒绝）
+    int departures = 0;
+    int queued = 0;
+    int promoted = 0;               // 从队列放行入库
+    int cancelled = 0;              // 放弃排队
+    int rejected = 0;               // 等待队列已满被拒绝
+    qint64 revenueCents = 0;        // 出库车辆应收金额
+    qint64 occupancyMSecs = 0;      // 在库车辆数对时间的积分
+    int peakParked = 0;
+    int peakQueued = 0;
+    QuantileSketch dwell;           // 停留时长（毫秒）
+    QuantileSketch wait;            // 排队等待时长（毫秒）
+
+    void merge(const AnalyticsWindow &other);
+    double averageParked() const;
+    double revenuePerHour() const;  // 元/小时
+    double rejectionRate() const;
+};
+
+// LotAnalytics 类
+// 作为 ParkingLotObserver 在每次入库、出库、排队、放行时 O(1) 更新当前分钟和当前小时的分段计数，
+// 分段保存在两个环形数组里（最近 60 分钟、最近 48 小时）。窗口查询只合并分段，不回看历史事件。
+class LotAnalytics : public ParkingLotObserver {
+public:
+    static const int kMinuteBuckets = 60;
+    static const int kHourBuckets = 48;
+
+    LotAnalytics(const ParkingLot *parkingLot, const TariffEngine *tariff);
+
+    void advanceTo(qint64 now);  // 没有事件时也把时间窗口推进到 now
+
+    AnalyticsWindow lastHour() const;
+    AnalyticsWindow today() const;               // 从当地零点到现在
+    QVector<double> minuteOccupancy() const;     // 最近 60 分钟每分钟的平均在库车辆数，从旧到新
+    QVector<AnalyticsWindow> hourlyWindows() const;  // 最近 48 小时中有数据的小时，从旧到新
+    QString toCsv() const;                       // 按小时导出
+
+    void vehicleParked(const Vehicle &vehicle, int spot) override;
+    void vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) override;
+    void vehicleQueued(const Vehicle &vehicle) override;
+    void vehicleDequeued(const Vehicle &vehicle) override;
+    void queueCancelled(const Vehicle &vehicle) override;
+    void vehicleRejected(const Vehicle &vehicle) override;
+
+private:
+    struct Ring {
+        QVector<AnalyticsWindow> buckets;
+        qint64 width;
+    };
+
+    AnalyticsWindow &bucketAt(Ring &ring, qint64 time);
+    void accumulate(Ring &ring, qint64 from, qint64 to);
+    AnalyticsWindow mergeSince(const Ring &ring, qint64 since) const;
+
+    qint64 advance();  // 推进到时钟当前时间并返回
+    template <typename Update>
+    void record(qint64 now, Update update);
+
+    const ParkingLot *parkingLot;
+    const TariffEngine *tariff;
+    Ring minutes;
+    Ring hours;
+    int parked;
+    int queueLength;
+    qint64 lastTime;
+    qint64 startedAt;
+    bool promoting = false;  // vehicleDequeued 之后的 vehicleParked 不算新到达
+};
+
+#endif // LOTANALYTICS_H
@@ -0,0 +1,158 @@
+#include "lotconfig.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+
+namespace {
+
+// 命令行选项、配置文件键和环境变量一一对应
+struct ConfigKey {
+    const char *name;
+    const char *environment;
+    const char *valueName;
+    const char *description;
+};
+
+const ConfigKey kConfigKeys[] = {
+    {"spots", "PARK_SPOTS", "n", "停车位数量"},
+    {"queue", "PARK_QUEUE", "n", "等待队列容量"},
+    {"import", "PARK_IMPORT", "file", "启动时导入的状态文件（.csv 或 .bin），替换恢复出的状态"},
+    {"state-dir", "PARK_STATE_DIR", "dir", "预写日志和快照目录"},
+    {"topology", "PARK_TOPOLOGY", "spec", "停车场拓扑，如 \"北库=40+40,60;南库=30+30+30\""},
+    {"layout", "PARK_LAYOUT", "spec", "车位布局，如 \"compact=20,oversize=5,disabled=2\""},
+    {"policy", "PARK_SPOT_POLICY", "name", "车位分配策略：nearest | balance | level"},
+    {"trace", "PARK_TRACE", "mode", "计时模式：off | histogram | timeline"},
+    {"clock-speed", "PARK_CLOCK_SPEED", "x", "停车场时间流逝倍速"},
+    {"listen", "PARK_LISTEN", "name", "无界面服务的本地套接字名，默认 park"},
+    {"port", "PARK_PORT", "port", "无界面服务在 127.0.0.1 上的 TCP 端口，默认 7878，0 表示不监听"}
+};
+
+bool parsePositive(const QString &key, const QString &value, int *result, QString *error) {
+    bool ok;
+    int number = value.trimmed().toInt(&ok);
+    if (!ok || number < 1) {
+        if (error) *error = QString("%1 应为正整数：%2").arg(key, value);
+        return false;
+    }
+    *result = number;
+    return true;
+}
+
+} // namespace
+
+// LotConfig 实现
+bool LotConfig::set(const QString &key, const QString &value, QString *error) {
+    if (key == "spots") return parsePositive(key, value, &totalSpots, error);
+    if (key == "queue") return parsePositive(key, value, &maxQueueCapacity, error);
+    if (key == "import") {
+        importFile = value.trimmed();
+    } else if (key == "state-dir") {
+        stateDirectory = value.trimmed();
+    } else if (key == "topology") {
+        topology = value.trimmed();
+    } else if (key == "layout") {
+        layout = value.trimmed();
+    } else if (key == "policy") {
+        spotPolicy = value.trimmed().toLower();
+    } else if (key == "trace") {
+        traceMode = value.trimmed();
+    } else if (key == "clock-speed") {
+        bool ok;
+        double speed = value.trimmed().toDouble(&ok);
+        if (!ok || speed <= 0) {
+            if (error) *error = QString("clock-speed 应为正数：%1").arg(value);
+            return false;
+        }
+        clockSpeed = speed;
+    } else if (key == "listen") {
+        listenName = value.trimmed();
+    } else if (key == "port") {
+        bool ok;
+        int port = value.trimmed().toInt(&ok);
+        if (!ok || port < 0 || port > 65535) {
+            if (error) *error = QString("port 应为 0 ~ 65535：%1").arg(value);
+            return false;
+        }
+        tcpPort = port;
+    } else if (key == "headless") {
+        QString flag = value.trimmed().toLower();
+        headless = flag == "1" || flag == "true" || flag == "yes" || flag == "on";
+    } else {
+        if (error) *error = QString("未知的配置项：%1").arg(key);
+        return false;
+    }
+    return true;
+}
+
+bool LotConfig::loadFile(const QString &path, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("无法打开配置文件：%1").arg(path);
+        return false;
+    }
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        ++lineNumber;
+        QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith(';') || line.startsWith('[')) continue;
+        int equals = line.indexOf('=');
+        QString message;
+        if (equals <= 0) {
+            message = "缺少 \"=\"";
+        } else if (set(line.left(equals).trimmed().toLower(), line.mid(equals + 1), &message)) {
+            continue;
+        }
+        if (error) *error = QString("%1 第 %2 行：%3").arg(path).arg(lineNumber).arg(message);
+        return false;
+    }
+    return true;
+}
+
+bool LotConfig::load(const QStringList &arguments, LotConfig *config, QString *error, QString *helpText) {
+    *config = LotConfig();
+    if (helpText) helpText->clear();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("停车场管理");
+    QCommandLineOption helpOption(QStringList{"h", "help"}, "显示帮助");
+    QCommandLineOption configOption("config", "配置文件，每行 \"键 = 值\"，键同命令行选项", "file");
+    QCommandLineOption headlessOption("headless", "不显示界面，在本地套接字和 TCP 端口上提供服务（环境变量 PARK_HEADLESS）");
+    parser.addOption(helpOption);
+    parser.addOption(configOption);
+    parser.addOption(headlessOption);
+    QList<QCommandLineOption> options;
+    for (const ConfigKey &key : kConfigKeys) {
+        options.append(QCommandLineOption(key.name, QString("%1（环境变量 %2）").arg(key.description, key.environment),
+                                          key.valueName));
+        parser.addOption(options.last());
+    }
+    if (!parser.parse(arguments)) {
+        if (error) *error = parser.errorText();
+        return false;
+    }
+    if (parser.isSet(helpOption)) {
+        config->headless = parser.isSet(headlessOption);  // 无界面时帮助输出到标准错误
+        if (helpText) *helpText = parser.helpText();
+        return true;
+    }
+
+    for (const ConfigKey &key : kConfigKeys) {
+        QString value = qEnvironmentVariable(key.environment);
+        if (!value.isEmpty() && !config->set(key.name, value, error)) {
+            if (error) *error = QString("%1：%2").arg(key.environment, *error);
+            return false;
+        }
+    }
+    if (!qEnvironmentVariable("PARK_HEADLESS").isEmpty()) config->set("headless", qEnvironmentVariable("PARK_HEADLESS"), error);
+    QString configFile = parser.isSet(configOption) ? parser.value(configOption) : qEnvironmentVariable("PARK_CONFIG");
+    if (!configFile.isEmpty() && !config->loadFile(configFile, error)) {
+        return false;
+    }
+    for (int i = 0; i < options.size(); ++i) {
+        if (parser.isSet(options[i]) && !config->set(kConfigKeys[i].name, parser.value(options[i]), error)) {
+            return false;
+        }
+    }
+    if (parser.isSet(headlessOption)) config->headless = true;
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef LOTCONFIG_H
+#define LOTCONFIG_H
+
+#include <QString>
+#include <QStringList>
+
+// LotConfig 结构
+// 启动配置，依次取 PARK_* 环境变量、配置文件和命令行，后者覆盖前者。
+// 配置文件为 UTF-8 的 "键 = 值" 行，键与命令行选项同名（如 spots = 200），# 开头为注释。
+// 车位数和队列容量都未给出、也没有可恢复或导入的状态时，界面再询问。
+struct LotConfig {
+    int totalSpots = 0;         // 0 表示未指定
+    int maxQueueCapacity = 0;
+    QString importFile;         // 启动时导入的 CSV/二进制状态文件，替换恢复出的状态
+    QString stateDirectory;     // 预写日志和快照目录，为空时使用应用数据目录
+    QString topology;           // 见 LotTopology::parse
+    QString layout;             // 见 SpotLayout::parse
+    QString spotPolicy;         // nearest / balance / level
+    QString traceMode;          // off / histogram / timeline
+    double clockSpeed = 1.0;    // 大于 1 时停车场时间按该倍速流逝
+    bool headless = false;      // 不显示界面，只通过 ParkProtocol 提供服务
+    QString listenName = "park";  // 无界面服务的本地套接字名，为空时不监听
+    int tcpPort = 7878;         // 无界面服务在 127.0.0.1 上监听的端口，0 表示不监听
+
+    // arguments 含程序名；出错时返回 false 并填写 error，要求帮助时 helpText 非空
+    static bool load(const QStringList &arguments, LotConfig *config, QString *error, QString *helpText = nullptr);
+    bool loadFile(const QString &path, QString *error);
+    bool set(const QString &key, const QString &value, QString *error);  // 键名同命令行选项
+};
+
+#endif // LOTCONFIG_H
@@ -0,0 +1,105 @@
+#include "lotstartup.h"
+#include "lotstatefile.h"
+
+#include <QStandardPaths>
+
+// LotStartup 实现
+LotStartup::LotStartup(const LotConfig &config, ParkingLot *parkingLot, const Clock *clock)
+    : config(config), parkingLot(parkingLot), clock(clock) {
+    // 拓扑描述多个停车场、楼层和区域（如 "北库=40+40,60;南库=30+30+30"），此时车位数由拓扑决定
+    QString error;
+    hasTopology = !config.topology.isEmpty() && LotTopology::parse(config.topology, &topology, &error);
+    if (!config.topology.isEmpty() && !hasTopology) {
+        messages.append(QString("忽略拓扑配置：%1").arg(error));
+    }
+
+    stateDirectory = stateDirectoryFor(config);
+}
+
+QString LotStartup::stateDirectoryFor(const LotConfig &config) {
+    if (!config.stateDirectory.isEmpty()) return config.stateDirectory;
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/state";
+}
+
+int LotStartup::configuredSpots() const {
+    return hasTopology ? topology.getTotalSpots() : config.totalSpots;
+}
+
+void LotStartup::createLot(int totalSpots, int maxQueueCapacity) {
+    *parkingLot = ParkingLot(totalSpots, maxQueueCapacity, clock);
+}
+
+bool LotStartup::restore() {
+    bool recovered = ParkingJournal::recover(stateDirectory, parkingLot, &recovery);
+    if (recovered) {
+        messages.append(QString("已恢复停车场状态：快照车辆 %1 辆，重放日志 %2 条，耗时 %3 毫秒")
+                            .arg(recovery.snapshotVehicles)
+                            .arg(recovery.replayedRecords)
+                            .arg(recovery.elapsedMSecs));
+    }
+    if (config.importFile.isEmpty()) return recovered;
+
+    // 导入的状态替换恢复出的状态；文件没有写明容量时沿用恢复的或配置的容量
+    if (!recovered) {
+        int totalSpots = configuredSpots() > 0 ? configuredSpots() : 10;
+        createLot(totalSpots, config.maxQueueCapacity > 0 ? config.maxQueueCapacity : 5);
+    }
+    LotStateImportInfo info;
+    QString error;
+    imported = LotStateFile::importFile(config.importFile, parkingLot, &info, &error);
+    if (!imported) {
+        messages.append(QString("导入失败：%1").arg(error));
+        return recovered;
+    }
+    messages.append(QString("已导入 %1：在库 %2 辆，排队 %3 辆，跳过 %4 行，耗时 %5 毫秒")
+                        .arg(config.importFile)
+                        .arg(info.parked)
+                        .arg(info.queued)
+                        .arg(info.skipped)
+                        .arg(info.elapsedMSecs));
+    for (const QString &warning : info.warnings) {
+        messages.append(QString("导入跳过：%1").arg(warning));
+    }
+    return true;
+}
+
+void LotStartup::finish() {
+    // 布局划分车型车位和保留车位（如 "compact=20,oversize=5,disabled=2"），没有拓扑时可用 zones 平均划分区域；
+    // 分配策略为 nearest|balance|level，多层拓扑下默认为 level（引导到空闲最多的楼层）。
+    // 拓扑和布局不写入日志，每次启动按当前车位数重新生成
+    int totalSpots = parkingLot->getSpotManager().getTotalSpots();
+    if (hasTopology && topology.getTotalSpots() != totalSpots) {
+        messages.append(QString("忽略拓扑配置：拓扑共 %1 个车位，停车场有 %2 个")
+                            .arg(topology.getTotalSpots())
+                            .arg(totalSpots));
+        hasTopology = false;
+    }
+    if (!hasTopology) topology = LotTopology::flat(totalSpots);
+
+    SpotLayout layout = SpotLayout::uniform(totalSpots);
+    layout.zoneStarts = topology.zoneStarts();
+    QString layoutError;
+    if (!config.layout.isEmpty()
+        && !SpotLayout::parse(totalSpots, config.layout, &layout, &layoutError, hasTopology ? layout.zoneStarts : QVector<int>())) {
+        messages.append(QString("忽略车位布局：%1").arg(layoutError));
+    }
+    parkingLot->setSpotLayout(layout);
+
+    occupancy = new TopologyOccupancy(topology, parkingLot);
+    parkingLot->addObserver(occupancy);
+    QString policyName = config.spotPolicy;
+    if (policyName.isEmpty() && topology.getLevels().size() > 1) policyName = "level";
+    std::shared_ptr<const SpotAllocationPolicy> policy = spotAllocationPolicy(policyName);
+    if (policyName == "level") policy = std::make_shared<LevelBalancingPolicy>(occupancy);
+    if (policy) {
+        parkingLot->setAllocationPolicy(policy);
+    } else {
+        messages.append(QString("忽略分配策略：未知的分配策略 %1").arg(policyName));
+    }
+
+    // 之后的每次状态变化都写入日志；导入的状态立即写快照，之后的日志接在它后面
+    journal = new ParkingJournal(stateDirectory, totalSpots, parkingLot->getQueueManager().getMaxCapacity(),
+                                 recovery.lastSequence, clock);
+    parkingLot->addObserver(journal);
+    if (imported) journal->checkpoint(*parkingLot);
+}
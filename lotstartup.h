@@ -0,0 +1,49 @@
+#ifndef LOTSTARTUP_H
+#define LOTSTARTUP_H
+
+#include <QString>
+#include <QStringList>
+
+#include "lotconfig.h"
+#include "lottopology.h"
+#include "parkingjournal.h"
+#include "parkinglot.h"
+
+// LotStartup 类
+// 按启动配置准备停车场，界面和无界面服务共用：先从预写日志恢复、再按需导入状态文件，
+// 然后应用拓扑、车位布局和分配策略，挂上空闲车位聚合和预写日志。
+// 过程中的提示放在 getMessages() 中，由调用方写入日志窗口或标准错误。
+class LotStartup {
+public:
+    LotStartup(const LotConfig &config, ParkingLot *parkingLot, const Clock *clock = Clock::system());
+
+    // 预写日志和快照所在的目录，未配置时为应用数据目录下的 state
+    static QString stateDirectoryFor(const LotConfig &config);
+
+    // 恢复并导入；返回 false 时没有可用的状态，调用方确定容量后调用 createLot
+    bool restore();
+    int configuredSpots() const;  // 拓扑或配置给出的车位数，0 表示未给出
+    void createLot(int totalSpots, int maxQueueCapacity);
+
+    // 应用拓扑、布局和策略并开始写日志。occupancy 和 journal 归调用方所有，
+    // 须在停车场析构前移除并删除（楼层均衡策略引用 occupancy，删除前先换掉策略）
+    void finish();
+    TopologyOccupancy *getOccupancy() const { return occupancy; }
+    ParkingJournal *getJournal() const { return journal; }
+    const QStringList &getMessages() const { return messages; }
+
+private:
+    LotConfig config;
+    ParkingLot *parkingLot;
+    const Clock *clock;
+    LotTopology topology;
+    bool hasTopology = false;
+    QString stateDirectory;
+    ParkingJournal::RecoveryInfo recovery;
+    bool imported = false;
+    TopologyOccupancy *occupancy = nullptr;
+    ParkingJournal *journal = nullptr;
+    QStringList messages;
+};
+
+#endif // LOTSTARTUP_H
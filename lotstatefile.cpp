@@ -0,0 +1,515 @@
+#include "lotstatefile.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+#include <optional>
+
+namespace {
+
+const char kCsvConfigTag[] = "#park-state";
+const char kBinaryMagic[4] = {'P', 'K', 'L', 'S'};
+const quint32 kBinaryVersion = 1;
+const int kHeaderBytes = 32;  // 魔数、版本、车位数、队列容量、在库数、排队数，其余保留为 0
+const int kRecordBytes = 32;  // 车牌两个字、入场时间、车位号（排队为 -1）、车型、排队类别，补齐到 32 字节
+const int kChunkBytes = 1 << 20;
+const int kMaxSpots = 10000000;
+const int kMaxWarnings = 20;
+
+const char *const kVehicleClassKeys[kVehicleClassCount] = {"standard", "compact", "oversize"};
+const char *const kPriorityClassKeys[kPriorityClassCount] = {"regular", "electric", "permit", "disabled"};
+
+template <typename T>
+void put(QByteArray &out, T value) {
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+T get(const char *data) {
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+// CSV 中的一个字段，去掉首尾空白和包围的双引号
+struct Field {
+    const char *begin = nullptr;
+    const char *end = nullptr;
+    bool escaped = false;  // 引号内含有写成两个的双引号
+
+    bool isEmpty() const { return begin == end; }
+    bool equals(const char *text) const {
+        int length = int(std::strlen(text));
+        return end - begin == length && std::memcmp(begin, text, length) == 0;
+    }
+    QString toString() const {
+        QString text = QString::fromUtf8(begin, int(end - begin));
+        return escaped ? text.replace("\"\"", "\"") : text;
+    }
+};
+
+Field trimmed(const char *begin, const char *end, bool unquote = true) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+    if (unquote && end - begin >= 2 && *begin == '"' && end[-1] == '"') {
+        ++begin;
+        --end;
+    }
+    return {begin, end};
+}
+
+// 按 RFC 4180 拆分一行：双引号包围的字段可以含逗号，字段内的双引号写成两个
+int splitFields(const char *begin, const char *end, Field *fields, int maxFields) {
+    int count = 0;
+    while (count < maxFields) {
+        const char *quote = begin;
+        while (quote < end && (*quote == ' ' || *quote == '\t')) ++quote;
+        if (quote < end && *quote == '"') {
+            Field field{quote + 1, quote + 1, false};
+            const char *p = quote + 1;
+            for (; p < end; ++p) {
+                if (*p != '"') continue;
+                if (p + 1 < end && p[1] == '"') {
+                    field.escaped = true;
+                    ++p;
+                    continue;
+                }
+                break;
+            }
+            field.end = p;  // 缺少右引号时取到行尾
+            fields[count++] = field;
+            const char *comma = p < end ? static_cast<const char *>(std::memchr(p, ',', end - p)) : nullptr;
+            if (!comma) break;
+            begin = comma + 1;
+            continue;
+        }
+        const char *comma = static_cast<const char *>(std::memchr(begin, ',', end - begin));
+        const char *fieldEnd = comma ? comma : end;
+        fields[count++] = trimmed(begin, fieldEnd);
+        if (!comma) break;
+        begin = comma + 1;
+    }
+    return count;
+}
+
+bool parseInteger(const Field &field, qint64 *value) {
+    const char *p = field.begin;
+    bool negative = p < field.end && *p == '-';
+    if (negative) ++p;
+    if (p == field.end) return false;
+    qint64 result = 0;
+    for (; p < field.end; ++p) {
+        if (*p < '0' || *p > '9' || result > (std::numeric_limits<qint64>::max() - 9) / 10) return false;
+        result = result * 10 + (*p - '0');
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+// 含逗号或双引号的字段按 RFC 4180 加引号，字段内的双引号写成两个
+void appendCsvField(QByteArray &out, const QByteArray &value) {
+    if (value.indexOf(',') < 0 && value.indexOf('"') < 0) {
+        out.append(value);
+        return;
+    }
+    QByteArray escaped = value;
+    out.append('"').append(escaped.replace("\"", "\"\"")).append('"');
+}
+
+// 英文名、中文名或枚举值
+template <typename Enum>
+bool parseClass(const Field &field, const char *const *keys, int count, QString (*name)(Enum), Enum *value) {
+    if (field.isEmpty()) {
+        *value = Enum(0);
+        return true;
+    }
+    qint64 number;
+    if (parseInteger(field, &number)) {
+        if (number < 0 || number >= count) return false;
+        *value = Enum(number);
+        return true;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (field.equals(keys[i])) {
+            *value = Enum(i);
+            return true;
+        }
+    }
+    QString text = field.toString();
+    for (int i = 0; i < count; ++i) {
+        if (text == name(Enum(i))) {
+            *value = Enum(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseTime(const Field &field, qint64 now, qint64 *time) {
+    if (field.isEmpty()) {
+        *time = now;
+        return true;
+    }
+    if (parseInteger(field, time)) return *time >= 0;
+    QString text = field.toString();
+    QDateTime dateTime = QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss");
+    if (!dateTime.isValid()) dateTime = QDateTime::fromString(text, Qt::ISODate);
+    if (!dateTime.isValid()) return false;
+    *time = dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+// 把记录逐条放进新建的停车场，全部成功后才替换目标停车场
+class StateBuilder {
+public:
+    StateBuilder(ParkingLot *target, LotStateImportInfo *info) : target(target), info(info) {}
+
+    // 当前处理的行号或记录号，只在跳过时才格式化进警告
+    void setPosition(const char *unit, qint64 number) {
+        positionUnit = unit;
+        position = number;
+    }
+
+    bool create(int totalSpots, int maxQueueCapacity, QString *error) {
+        if (totalSpots < 1 || totalSpots > kMaxSpots || maxQueueCapacity < 1 || maxQueueCapacity > kMaxSpots) {
+            if (error) *error = QString("无效的车位数或队列容量：%1 / %2").arg(totalSpots).arg(maxQueueCapacity);
+            return false;
+        }
+        lot.emplace(totalSpots, maxQueueCapacity, target->getClock());
+        info->totalSpots = totalSpots;
+        info->maxQueueCapacity = maxQueueCapacity;
+        return true;
+    }
+
+    bool isCreated() const { return lot.has_value(); }
+    qint64 now() const { return target->getClock()->now(); }
+
+    void skip(const QString &reason) {
+        ++info->skipped;
+        if (info->warnings.size() < kMaxWarnings) {
+            info->warnings.append(QString("第 %1 %2：%3").arg(position).arg(QString::fromUtf8(positionUnit), reason));
+        }
+    }
+
+    void addParked(const Vehicle &vehicle, int spot) {
+        if (!accept(vehicle)) return;
+        if (spot < 0 || spot >= lot->getSpotManager().getTotalSpots()) {
+            skip(QString("车位号 %1 超出范围").arg(spot + 1));
+        } else if (!lot->restoreParked(vehicle, spot)) {
+            skip(QString("%1 号车位已被占用").arg(spot + 1));
+        } else {
+            ++info->parked;
+        }
+    }
+
+    void addQueued(const Vehicle &vehicle) {
+        if (!accept(vehicle)) return;
+        if (lot->getQueueManager().isQueueFull()) {
+            skip("等待队列已满");
+        } else {
+            lot->restoreQueued(vehicle);
+            ++info->queued;
+        }
+    }
+
+    void finish() {
+        *target = std::move(*lot);
+    }
+
+private:
+    bool accept(const Vehicle &vehicle) {
+        const PlateKey &plate = vehicle.getPlateKey();
+        if (!plate.isValid()) {
+            skip("车牌号无效");
+            return false;
+        }
+        if (lot->getSpotManager().hasVehicle(plate) || lot->getQueueManager().hasVehicleInQueue(plate)) {
+            skip(QString("车牌 %1 重复").arg(plate.toString()));
+            return false;
+        }
+        return true;
+    }
+
+    ParkingLot *target;
+    LotStateImportInfo *info;
+    std::optional<ParkingLot> lot;
+    const char *positionUnit = "行";
+    qint64 position = 0;
+};
+
+bool importCsv(QIODevice *device, StateBuilder &builder, QString *error, int defaultSpots, int defaultQueue) {
+    qint64 lineNumber = 0;
+    bool failed = false;
+
+    auto processLine = [&](const char *begin, const char *end) {
+        ++lineNumber;
+        if (lineNumber == 1 && end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) begin += 3;  // 表格软件导出的 BOM
+        Field line = trimmed(begin, end, false);
+        if (line.isEmpty()) return;
+
+        // 可选的配置行只能出现在第一行
+        if (*line.begin == '#') {
+            if (lineNumber == 1 && line.end - line.begin >= int(sizeof(kCsvConfigTag) - 1)
+                && std::memcmp(line.begin, kCsvConfigTag, sizeof(kCsvConfigTag) - 1) == 0) {
+                Field fields[4];
+                int count = splitFields(line.begin, line.end, fields, 4);
+                qint64 spots = defaultSpots, queue = defaultQueue;
+                for (int i = 1; i < count; ++i) {
+                    const char *equals = static_cast<const char *>(std::memchr(fields[i].begin, '=', fields[i].end - fields[i].begin));
+                    Field key = equals ? trimmed(fields[i].begin, equals) : fields[i];
+                    Field value = equals ? trimmed(equals + 1, fields[i].end) : Field();
+                    if (key.equals("spots") && parseInteger(value, &spots)) continue;
+                    if (key.equals("queue") && parseInteger(value, &queue)) continue;
+                    if (error) *error = QString("无效的配置项：%1").arg(fields[i].toString());
+                    failed = true;
+                    return;
+                }
+                if (!builder.create(int(qBound<qint64>(0, spots, kMaxSpots + 1)), int(qBound<qint64>(0, queue, kMaxSpots + 1)), error)) {
+                    failed = true;
+                }
+            }
+            return;
+        }
+
+        Field fields[6];
+        int count = splitFields(line.begin, line.end, fields, 6);
+        if (fields[0].equals("state")) return;  // 表头
+        if (!builder.isCreated() && !builder.create(defaultSpots, defaultQueue, error)) {
+            failed = true;
+            return;
+        }
+
+        builder.setPosition("行", lineNumber);
+        bool parked = fields[0].equals("parked");
+        if (!parked && !fields[0].equals("queued")) {
+            builder.skip(QString("未知的状态 %1").arg(fields[0].toString()));
+            return;
+        }
+        if (count < 2) {
+            builder.skip("缺少车牌号");
+            return;
+        }
+        Field empty;
+        qint64 spot = 0;
+        qint64 entryTime = 0;
+        VehicleClass vehicleClass;
+        PriorityClass priorityClass;
+        if (parked && (count < 3 || !parseInteger(fields[2], &spot))) {
+            builder.skip("车位号无效");
+            return;
+        }
+        if (!parseTime(count > 3 ? fields[3] : empty, builder.now(), &entryTime)) {
+            builder.skip("入场时间无效");
+            return;
+        }
+        if (!parseClass(count > 4 ? fields[4] : empty, kVehicleClassKeys, kVehicleClassCount, vehicleClassName, &vehicleClass)
+            || !parseClass(count > 5 ? fields[5] : empty, kPriorityClassKeys, kPriorityClassCount, priorityClassName,
+                           &priorityClass)) {
+            builder.skip("车型或排队类别无效");
+            return;
+        }
+
+        Vehicle vehicle(PlateKey(fields[1].toString()), entryTime, vehicleClass, priorityClass);
+        if (parked) {
+            builder.addParked(vehicle, int(qBound<qint64>(-1, spot - 1, kMaxSpots)));
+        } else {
+            builder.addQueued(vehicle);
+        }
+    };
+
+    // 固定大小的缓冲区：处理完整的行，把最后半行移到开头再读下一块
+    QByteArray buffer(kChunkBytes, Qt::Uninitialized);
+    int used = 0;
+    while (!failed) {
+        if (used == buffer.size()) {
+            if (error) *error = QString("第 %1 行过长").arg(lineNumber + 1);
+            return false;
+        }
+        qint64 read = device->read(buffer.data() + used, buffer.size() - used);
+        if (read < 0) {
+            if (error) *error = QString("读取失败：%1").arg(device->errorString());
+            return false;
+        }
+        int size = used + int(read);
+        const char *data = buffer.constData();
+        int start = 0;
+        while (!failed) {
+            const char *newline = static_cast<const char *>(std::memchr(data + start, '\n', size - start));
+            if (!newline) break;
+            processLine(data + start, newline);
+            start = int(newline - data) + 1;
+        }
+        if (read == 0) {
+            if (!failed && start < size) processLine(data + start, data + size);  // 最后一行没有换行符
+            break;
+        }
+        used = size - start;
+        std::memmove(buffer.data(), data + start, used);
+    }
+    if (!failed && !builder.isCreated()) {
+        failed = !builder.create(defaultSpots, defaultQueue, error);  // 只有配置行或空文件
+    }
+    return !failed;
+}
+
+bool importBinary(QIODevice *device, StateBuilder &builder, QString *error) {
+    char header[kHeaderBytes];
+    if (device->read(header, kHeaderBytes) != kHeaderBytes) {
+        if (error) *error = "文件头不完整";
+        return false;
+    }
+    quint32 version = get<quint32>(header + 4);
+    if (version < 1 || version > kBinaryVersion) {
+        if (error) *error = QString("不支持的文件版本 %1").arg(version);
+        return false;
+    }
+    qint32 parkedCount = get<qint32>(header + 16);
+    qint32 queuedCount = get<qint32>(header + 20);
+    if (parkedCount < 0 || queuedCount < 0 || !builder.create(get<qint32>(header + 8), get<qint32>(header + 12), error)) {
+        if (error && error->isEmpty()) *error = "文件头无效";
+        return false;
+    }
+
+    QByteArray buffer(kChunkBytes / kRecordBytes * kRecordBytes, Qt::Uninitialized);
+    qint64 total = qint64(parkedCount) + queuedCount;
+    for (qint64 record = 0; record < total;) {
+        qint64 wanted = qMin<qint64>(total - record, buffer.size() / kRecordBytes) * kRecordBytes;
+        if (device->read(buffer.data(), wanted) != wanted) {
+            if (error) *error = QString("文件在第 %1 条记录处被截断").arg(record + 1);
+            return false;
+        }
+        for (const char *p = buffer.constData(); p < buffer.constData() + wanted; p += kRecordBytes, ++record) {
+            quint8 vehicleClass = quint8(p[28]);
+            quint8 priorityClass = quint8(p[29]);
+            builder.setPosition("条记录", record + 1);
+            if (vehicleClass >= kVehicleClassCount || priorityClass >= kPriorityClassCount) {
+                builder.skip("车型或排队类别无效");
+                continue;
+            }
+            Vehicle vehicle(PlateKey::fromWords(get<quint64>(p), get<quint64>(p + 8)), get<qint64>(p + 16),
+                            VehicleClass(vehicleClass), PriorityClass(priorityClass));
+            if (record < parkedCount) {
+                builder.addParked(vehicle, get<qint32>(p + 24));
+            } else {
+                builder.addQueued(vehicle);
+            }
+        }
+    }
+    return true;
+}
+
+bool flushTo(QIODevice *device, QByteArray &out, QString *error) {
+    if (device->write(out) != out.size()) {
+        if (error) *error = QString("写入失败：%1").arg(device->errorString());
+        return false;
+    }
+    out.clear();
+    return true;
+}
+
+} // namespace
+
+// LotStateFile 实现
+LotStateFormat LotStateFile::formatForPath(const QString &path) {
+    return path.endsWith(".bin", Qt::CaseInsensitive) ? LotStateFormat::Binary : LotStateFormat::Csv;
+}
+
+bool LotStateFile::exportState(const ParkingLot &parkingLot, QIODevice *device, LotStateFormat format, QString *error) {
+    const ParkingSpotManager &spots = parkingLot.getSpotManager();
+    const QueueManager &queue = parkingLot.getQueueManager();
+    QByteArray out;
+    out.reserve(kChunkBytes + 256);
+    bool ok = true;
+
+    if (format == LotStateFormat::Binary) {
+        out.append(kBinaryMagic, 4);
+        put<quint32>(out, kBinaryVersion);
+        put<qint32>(out, spots.getTotalSpots());
+        put<qint32>(out, queue.getMaxCapacity());
+        put<qint32>(out, spots.getParkedCount());
+        put<qint32>(out, queue.getQueueLength());
+        put<quint64>(out, 0);
+        auto record = [&](const Vehicle &vehicle, int spot) {
+            if (!ok) return;
+            put<quint64>(out, vehicle.getPlateKey().word(0));
+            put<quint64>(out, vehicle.getPlateKey().word(1));
+            put<qint64>(out, vehicle.getEntryTime());
+            put<qint32>(out, spot);
+            put<quint8>(out, quint8(vehicle.getVehicleClass()));
+            put<quint8>(out, quint8(vehicle.getPriorityClass()));
+            put<quint16>(out, 0);
+            if (out.size() >= kChunkBytes) ok = flushTo(device, out, error);
+        };
+        spots.forEachParkedVehicle([&](int spot, const Vehicle &vehicle) { record(vehicle, spot); });
+        queue.forEachQueuedVehicle([&](const Vehicle &vehicle) { record(vehicle, -1); });
+    } else {
+        out.append(kCsvConfigTag);
+        out.append(",spots=").append(QByteArray::number(spots.getTotalSpots()));
+        out.append(",queue=").append(QByteArray::number(queue.getMaxCapacity())).append('\n');
+        out.append("state,plate,spot,entry_time,vehicle_class,priority_class\n");
+        auto row = [&](const char *state, const Vehicle &vehicle, int spot) {
+            if (!ok) return;
+            out.append(state).append(',');
+            appendCsvField(out, vehicle.getLicensePlate().toUtf8());
+            out.append(',');
+            if (spot >= 0) out.append(QByteArray::number(spot + 1));
+            out.append(',').append(QByteArray::number(vehicle.getEntryTime()));
+            out.append(',').append(kVehicleClassKeys[int(vehicle.getVehicleClass())]);
+            out.append(',').append(kPriorityClassKeys[int(vehicle.getPriorityClass())]).append('\n');
+            if (out.size() >= kChunkBytes) ok = flushTo(device, out, error);
+        };
+        spots.forEachParkedVehicle([&](int spot, const Vehicle &vehicle) { row("parked", vehicle, spot); });
+        queue.forEachQueuedVehicle([&](const Vehicle &vehicle) { row("queued", vehicle, -1); });
+    }
+    return ok && flushTo(device, out, error);
+}
+
+bool LotStateFile::importState(QIODevice *device, ParkingLot *parkingLot, LotStateImportInfo *info, QString *error) {
+    QElapsedTimer timer;
+    timer.start();
+    LotStateImportInfo localInfo;
+    if (!info) info = &localInfo;
+    *info = LotStateImportInfo();
+    if (error) error->clear();
+
+    StateBuilder builder(parkingLot, info);
+    bool ok = device->peek(4) == QByteArray(kBinaryMagic, 4)
+                  ? importBinary(device, builder, error)
+                  : importCsv(device, builder, error, parkingLot->getSpotManager().getTotalSpots(),
+                              parkingLot->getQueueManager().getMaxCapacity());
+    if (ok) builder.finish();
+    info->elapsedMSecs = timer.elapsed();
+    return ok;
+}
+
+bool LotStateFile::exportFile(const ParkingLot &parkingLot, const QString &path, QString *error) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = QString("无法写入文件：%1").arg(path);
+        return false;
+    }
+    if (!exportState(parkingLot, &file, formatForPath(path), error)) {
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        if (error) *error = QString("无法写入文件：%1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool LotStateFile::importFile(const QString &path, ParkingLot *parkingLot, LotStateImportInfo *info, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("无法打开文件：%1").arg(path);
+        return false;
+    }
+    return importState(&file, parkingLot, info, error);
+}
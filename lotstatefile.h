@@ -0,0 +1,50 @@
+#ifndef LOTSTATEFILE_H
+#define LOTSTATEFILE_H
+
+#include <QString>
+#include <QStringList>
+
+#include "parkinglot.h"
+
+class QIODevice;
+
+enum class LotStateFormat { Csv, Binary };
+
+struct LotStateImportInfo {
+    int totalSpots = 0;
+    int maxQueueCapacity = 0;
+    int parked = 0;
+    int queued = 0;
+    int skipped = 0;          // 格式错误、车牌重复、车位冲突或队列已满的行
+    QStringList warnings;     // 前 20 条被跳过的原因，带行号或记录号
+    qint64 elapsedMSecs = 0;
+};
+
+// LotStateFile 类
+// 在库车辆、等待队列和车位/队列容量的批量导入导出，用于从旧系统切换、审计和快速启动。
+// CSV 每行一辆车，便于人工查看和其他系统生成：
+//   #park-state,spots=<车位数>,queue=<队列容量>      （可省略，省略时沿用目标停车场的容量）
+//   state,plate,spot,entry_time,vehicle_class,priority_class   （表头，可省略）
+//   parked,京A12345,17,1717200000000,standard,regular
+//   queued,沪B67890,,2024-06-01 08:30:00,compact,electric
+// 车位号从 1 开始，与界面一致；入场时间为毫秒时间戳或本地时间 "yyyy-MM-dd HH:mm:ss"；
+// 车型和排队类别可写英文名、中文名或枚举值；含逗号或双引号的车牌按 RFC 4180 加引号。
+// 二进制格式为 32 字节文件头加每辆车 32 字节的定长记录，车牌直接以 PlateKey 的两个字保存。
+// 两种格式都按 1 MiB 的块流式读写，内存占用与文件大小无关；导入时格式按文件头自动识别。
+class LotStateFile {
+public:
+    static LotStateFormat formatForPath(const QString &path);  // .bin 为二进制，其余为 CSV
+
+    static bool exportState(const ParkingLot &parkingLot, QIODevice *device, LotStateFormat format,
+                            QString *error = nullptr);
+    // 成功时用导入的状态替换 *parkingLot（沿用原来的时钟，不通知观察者）；失败时 *parkingLot 不变。
+    // 单行错误只跳过该行并计入 info->skipped，文件头错误或读取失败才返回 false
+    static bool importState(QIODevice *device, ParkingLot *parkingLot, LotStateImportInfo *info = nullptr,
+                            QString *error = nullptr);
+
+    static bool exportFile(const ParkingLot &parkingLot, const QString &path, QString *error = nullptr);
+    static bool importFile(const QString &path, ParkingLot *parkingLot, LotStateImportInfo *info = nullptr,
+                           QString *error = nullptr);
+};
+
+#endif // LOTSTATEFILE_H
@@ -0,0 +1,212 @@
+#include "lottopology.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+// FenwickTree 实现
+FenwickTree::FenwickTree(const QVector<int> &values) : tree(values) {
+    // 每个位置把自己累加到负责它的上一级，O(n) 建树
+    for (int i = 0; i < tree.size(); ++i) {
+        int parent = i | (i + 1);
+        if (parent < tree.size()) tree[parent] += tree[i];
+    }
+}
+
+void FenwickTree::add(int i, int delta) {
+    for (; i < tree.size(); i |= i + 1) {
+        tree[i] += delta;
+    }
+}
+
+int FenwickTree::prefixSum(int end) const {
+    int sum = 0;
+    for (int i = qMin(end, tree.size()) - 1; i >= 0; i = (i & (i + 1)) - 1) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+int FenwickTree::rangeSum(int from, int to) const {
+    return to > from ? prefixSum(to) - prefixSum(from) : 0;
+}
+
+// LotTopology 实现
+int LotTopology::addNode(const QString &name, TopologyKind kind, int parent, int begin) {
+    int id = nodes.size();
+    nodes.append({name, kind, parent, begin, begin, QVector<int>(), -1});
+    if (parent >= 0) nodes[parent].children.append(id);
+    if (kind == TopologyKind::Level) {
+        nodes[id].levelIndex = levels.size();
+        levels.append(id);
+    }
+    return id;
+}
+
+bool LotTopology::parse(const QString &spec, LotTopology *topology, QString *error) {
+    LotTopology result;
+    result.addNode("全站", TopologyKind::Site, -1, 0);
+    int spot = 0;
+
+    const QStringList lotTexts = spec.split(';');
+    for (const QString &rawLot : lotTexts) {
+        QString lotText = rawLot.trimmed();
+        if (lotText.isEmpty()) continue;
+        int equals = lotText.indexOf('=');
+        if (equals <= 0) {
+            if (error) *error = QString("停车场缺少名称：%1").arg(lotText);
+            return false;
+        }
+        int lot = result.addNode(lotText.left(equals).trimmed(), TopologyKind::Lot, 0, spot);
+
+        const QStringList levelTexts = lotText.mid(equals + 1).split(',');
+        for (int l = 0; l < levelTexts.size(); ++l) {
+            int level = result.addNode(QString("%1层").arg(l + 1), TopologyKind::Level, lot, spot);
+            const QStringList zoneTexts = levelTexts[l].split('+');
+            for (int z = 0; z < zoneTexts.size(); ++z) {
+                bool ok;
+                int count = zoneTexts[z].trimmed().toInt(&ok);
+                if (!ok || count <= 0) {
+                    if (error) *error = QString("无效的区域车位数：%1").arg(zoneTexts[z].trimmed());
+                    return false;
+                }
+                QString zoneName = z < 26 ? QString("%1区").arg(QChar('A' + z)) : QString("%1区").arg(z + 1);
+                int zone = result.addNode(zoneName, TopologyKind::Zone, level, spot);
+                spot += count;
+                result.nodes[zone].end = spot;
+            }
+            result.nodes[level].end = spot;
+        }
+        result.nodes[lot].end = spot;
+    }
+
+    if (result.levels.isEmpty()) {
+        if (error) *error = "拓扑中没有停车场";
+        return false;
+    }
+    result.nodes[0].end = spot;
+    *topology = result;
+    return true;
+}
+
+LotTopology LotTopology::flat(int totalSpots) {
+    LotTopology topology;
+    topology.addNode("全站", TopologyKind::Site, -1, 0);
+    int lot = topology.addNode("停车场", TopologyKind::Lot, 0, 0);
+    int level = topology.addNode("1层", TopologyKind::Level, lot, 0);
+    int zone = topology.addNode("A区", TopologyKind::Zone, level, 0);
+    for (int id : {0, lot, level, zone}) topology.nodes[id].end = qMax(0, totalSpots);
+    return topology;
+}
+
+QVector<int> LotTopology::zoneStarts() const {
+    QVector<int> starts;
+    for (const TopologyNode &node : nodes) {
+        if (node.kind == TopologyKind::Zone) starts.append(node.begin);
+    }
+    return starts;
+}
+
+int LotTopology::levelOf(int spot) const {
+    // 楼层按车位号顺序排列，二分查找起始车位不大于 spot 的最后一层
+    auto it = std::upper_bound(levels.begin(), levels.end(), spot,
+                               [this](int value, int level) { return value < nodes[level].begin; });
+    return it == levels.begin() ? -1 : *(it - 1);
+}
+
+QString LotTopology::pathOf(int id) const {
+    QStringList parts;
+    for (; id > 0; id = nodes[id].parent) parts.prepend(nodes[id].name);
+    return parts.join(" / ");
+}
+
+// TopologyOccupancy 实现
+TopologyOccupancy::TopologyOccupancy(const LotTopology &topology, const ParkingLot *parkingLot)
+    : topology(topology), levelFree(topology.getLevels().size()) {
+    int totalSpots = topology.getTotalSpots();
+    QVector<int> free(totalSpots, 1);
+    parkingLot->getSpotManager().forEachParkedVehicle([&](int spot, const Vehicle &) {
+        if (spot < totalSpots) free[spot] = 0;
+    });
+    freeSpots = FenwickTree(free);
+
+    const QVector<int> &levels = topology.getLevels();
+    for (int i = 0; i < levels.size(); ++i) {
+        levelFree[i] = freeCount(levels[i]);
+    }
+    while (leafBase < levels.size()) leafBase *= 2;
+    levelTree.fill(-1, 2 * leafBase);
+    for (int i = 0; i < levels.size(); ++i) levelTree[leafBase + i] = i;
+    for (int i = leafBase - 1; i >= 1; --i) {
+        int a = levelTree[2 * i];
+        int b = levelTree[2 * i + 1];
+        levelTree[i] = a < 0 ? b : b < 0 ? a : levelFree[b] > levelFree[a] ? b : a;
+    }
+}
+
+int TopologyOccupancy::freeCount(int node) const {
+    const TopologyNode &entry = topology.node(node);
+    return freeSpots.rangeSum(entry.begin, entry.end);
+}
+
+void TopologyOccupancy::updateLevel(int level, int delta) {
+    levelFree[level] += delta;
+    for (int i = (leafBase + level) / 2; i >= 1; i /= 2) {
+        int a = levelTree[2 * i];
+        int b = levelTree[2 * i + 1];
+        levelTree[i] = a < 0 ? b : b < 0 ? a : levelFree[b] > levelFree[a] ? b : a;
+    }
+}
+
+int TopologyOccupancy::bestLevel(int from, int to) const {
+    // 左右两侧分别累积，保证空闲数相同时取序号较小的楼层
+    auto better = [this](int a, int b) { return a < 0 ? b : b < 0 ? a : levelFree[b] > levelFree[a] ? b : a; };
+    int left = -1;
+    int right = -1;
+    for (int l = from + leafBase, r = to + leafBase; l < r; l /= 2, r /= 2) {
+        if (l & 1) left = better(left, levelTree[l++]);
+        if (r & 1) right = better(levelTree[--r], right);
+    }
+    return better(left, right);
+}
+
+int TopologyOccupancy::emptiestLevel() const {
+    int level = bestLevel(0, topology.getLevels().size());
+    return level < 0 ? -1 : topology.getLevels()[level];
+}
+
+int TopologyOccupancy::emptiestLevel(int lot) const {
+    const TopologyNode &node = topology.node(lot);
+    if (node.kind != TopologyKind::Lot || node.children.isEmpty()) return -1;
+    int level = bestLevel(topology.node(node.children.first()).levelIndex,
+                          topology.node(node.children.last()).levelIndex + 1);
+    return level < 0 ? -1 : topology.getLevels()[level];
+}
+
+void TopologyOccupancy::vehicleParked(const Vehicle &, int spot) {
+    int level = topology.levelOf(spot);
+    if (spot >= topology.getTotalSpots() || level < 0) return;
+    freeSpots.add(spot, -1);
+    updateLevel(topology.node(level).levelIndex, -1);
+}
+
+void TopologyOccupancy::vehicleReleased(const Vehicle &, int spot, const ReleaseInfo &) {
+    int level = topology.levelOf(spot);
+    if (spot >= topology.getTotalSpots() || level < 0) return;
+    freeSpots.add(spot, 1);
+    updateLevel(topology.node(level).levelIndex, 1);
+}
+
+// LevelBalancingPolicy 实现
+int LevelBalancingPolicy::choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const {
+    int level = occupancy->emptiestLevel();
+    if (level >= 0) {
+        const TopologyNode &node = occupancy->getTopology().node(level);
+        for (int i = 0; i < kindCount; ++i) {
+            if (allocator.freeOfKind(kinds[i]) == 0) continue;
+            int spot = allocator.firstFree(kinds[i], node.begin, node.end);
+            if (spot >= 0) return spot;
+        }
+    }
+    return NearestEntrancePolicy().choose(allocator, kinds, kindCount);
+}
@@ -0,0 +1,101 @@
+#ifndef LOTTOPOLOGY_H
+#define LOTTOPOLOGY_H
+
+#include <QString>
+#include <QVector>
+
+#include "parkinglot.h"
+#include "spotallocator.h"
+
+// FenwickTree 类
+// 树状数组：单点增减和前缀/区间求和都是 O(log n)，按已有数组建树为 O(n)。
+class FenwickTree {
+public:
+    FenwickTree() = default;
+    explicit FenwickTree(const QVector<int> &values);
+    void add(int i, int delta);
+    int prefixSum(int end) const;          // [0, end) 的和
+    int rangeSum(int from, int to) const;  // [from, to) 的和
+    int size() const { return tree.size(); }
+
+private:
+    QVector<int> tree;  // tree[i] 为 (i - lowbit(i+1), i] 的和
+};
+
+enum class TopologyKind : quint8 { Site, Lot, Level, Zone };
+
+// 拓扑中的一个节点，覆盖连续的车位号区间 [begin, end)
+struct TopologyNode {
+    QString name;
+    TopologyKind kind;
+    int parent;          // 站点为 -1
+    int begin;
+    int end;
+    QVector<int> children;
+    int levelIndex;      // 楼层节点在全站楼层中的序号，其他节点为 -1
+};
+
+// LotTopology 类
+// 站点 → 停车场 → 楼层 → 区域 → 车位的层次结构。同一节点下的车位号连续，
+// 所以任一节点都能用一个车位区间表示，空闲数由 TopologyOccupancy 按区间求和。
+class LotTopology {
+public:
+    // 形如 "北库=40+40,60;南库=30+30+30"：分号分隔停车场，逗号分隔楼层，加号分隔楼层内各区域的车位数
+    static bool parse(const QString &spec, LotTopology *topology, QString *error = nullptr);
+    static LotTopology flat(int totalSpots);  // 单个停车场、单层、单区域
+
+    int getTotalSpots() const { return nodes.isEmpty() ? 0 : nodes[0].end; }
+    const TopologyNode &node(int id) const { return nodes[id]; }
+    int nodeCount() const { return nodes.size(); }
+    const QVector<int> &getLevels() const { return levels; }  // 全站楼层节点，按车位号顺序
+    QVector<int> zoneStarts() const;                          // 各区域的起始车位号，可直接用作 SpotLayout::zoneStarts
+    int levelOf(int spot) const;                              // 车位所在的楼层节点
+    QString pathOf(int id) const;                             // 形如 "北库 / 2层 / B区"，不含站点
+
+private:
+    int addNode(const QString &name, TopologyKind kind, int parent, int begin);
+
+    QVector<TopologyNode> nodes;  // nodes[0] 为站点，子节点排在父节点之后
+    QVector<int> levels;
+};
+
+// TopologyOccupancy 类
+// 作为观察者随入库/出库增量维护空闲车位：按车位号的树状数组给出任一节点的空闲数，
+// 按楼层的线段树给出空闲最多的楼层，两者都是 O(log n)。构造时从停车场当前状态初始化。
+class TopologyOccupancy : public ParkingLotObserver {
+public:
+    TopologyOccupancy(const LotTopology &topology, const ParkingLot *parkingLot);
+
+    const LotTopology &getTopology() const { return topology; }
+    int freeCount(int node) const;
+    int totalCount(int node) const { return topology.node(node).end - topology.node(node).begin; }
+    int emptiestLevel() const;          // 全站空闲最多的楼层节点，相同时取靠前的
+    int emptiestLevel(int lot) const;   // 某个停车场内空闲最多的楼层节点
+
+    void vehicleParked(const Vehicle &vehicle, int spot) override;
+    void vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) override;
+
+private:
+    void updateLevel(int level, int delta);
+    int bestLevel(int from, int to) const;  // 楼层序号区间 [from, to) 内空闲最多的楼层序号
+
+    LotTopology topology;
+    FenwickTree freeSpots;    // 空闲为 1
+    QVector<int> levelFree;
+    QVector<int> levelTree;   // 线段树，内部节点保存子树中空闲最多的楼层序号
+    int leafBase = 1;
+};
+
+// 楼层均衡：把车辆送往空闲最多的楼层，在该楼层内按车辆可用的类型取最靠近入口的车位；
+// 该楼层没有合适车位时退回到全站最靠近入口的车位。occupancy 必须比使用该策略的停车场活得久。
+class LevelBalancingPolicy : public SpotAllocationPolicy {
+public:
+    explicit LevelBalancingPolicy(const TopologyOccupancy *occupancy) : occupancy(occupancy) {}
+    QString name() const override { return "level"; }
+    int choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const override;
+
+private:
+    const TopologyOccupancy *occupancy;
+};
+
+#endif // LOTTOPOLOGY_H
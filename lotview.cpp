@@ -0,0 +1,250 @@
+#include "lotview.h"
+#include "iconcache.h"
+#include "parkinglotmodel.h"
+#include "tracing.h"
+
+#include <QAbstractItemModel>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QToolTip>
+#include <QWheelEvent>
+
+namespace {
+const int kMinCellWidth = 36;
+const int kMaxCellWidth = 240;
+const int kMaxRepaintRange = 256;  // dataChanged 区间超过此数量时直接整屏刷新
+}
+
+// LotView 实现
+LotView::LotView(QWidget *parent) : QAbstractScrollArea(parent) {
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    cellColor = palette().color(QPalette::Button);
+}
+
+void LotView::setModel(QAbstractItemModel *newModel) {
+    if (model) {
+        disconnect(model, nullptr, this, nullptr);
+    }
+    model = newModel;
+    if (model) {
+        connect(model, &QAbstractItemModel::dataChanged, this, &LotView::onDataChanged);
+        connect(model, &QAbstractItemModel::modelReset, this, &LotView::updateLayout);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &LotView::updateLayout);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &LotView::updateLayout);
+    }
+    maskedCells.clear();
+    updateLayout();
+}
+
+void LotView::setFixedColumns(int newColumns) {
+    fixedColumns = qMax(0, newColumns);
+    updateLayout();
+}
+
+void LotView::setCellSize(const QSize &size) {
+    QSize bounded(qBound(kMinCellWidth, size.width(), kMaxCellWidth),
+                  qBound(kMinCellWidth * 3 / 5, size.height(), kMaxCellWidth * 3 / 5));
+    if (bounded == cell) return;
+    cell = bounded;
+    updateLayout();
+}
+
+void LotView::setCellColor(const QColor &color) {
+    cellColor = color;
+    viewport()->update();
+}
+
+int LotView::itemCount() const {
+    return model ? model->rowCount() : 0;
+}
+
+int LotView::rowCount() const {
+    return (itemCount() + columns - 1) / columns;
+}
+
+void LotView::updateLayout() {
+    int stepX = cell.width() + spacing;
+    int stepY = cell.height() + spacing;
+    columns = fixedColumns > 0 ? fixedColumns : qMax(1, (viewport()->width() - spacing) / stepX);
+
+    // 滚动范围只和行列数有关，布局代价与车位数量无关
+    int contentWidth = spacing + columns * stepX;
+    int contentHeight = spacing + rowCount() * stepY;
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth - viewport()->width()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(stepX / 2);
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight - viewport()->height()));
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(stepY / 2);
+    viewport()->update();
+}
+
+QRect LotView::cellRect(int index) const {
+    if (index < 0 || index >= itemCount()) return QRect();
+    int column = index % columns;
+    int row = index / columns;
+    return QRect(spacing + column * (cell.width() + spacing) - horizontalScrollBar()->value(),
+                 spacing + row * (cell.height() + spacing) - verticalScrollBar()->value(),
+                 cell.width(), cell.height());
+}
+
+int LotView::indexAt(const QPoint &pos) const {
+    int x = pos.x() + horizontalScrollBar()->value() - spacing;
+    int y = pos.y() + verticalScrollBar()->value() - spacing;
+    if (x < 0 || y < 0) return -1;
+
+    int stepX = cell.width() + spacing;
+    int stepY = cell.height() + spacing;
+    int column = x / stepX;
+    int row = y / stepY;
+    if (column >= columns || x % stepX >= cell.width() || y % stepY >= cell.height()) {
+        return -1;  // 落在格子间隙里
+    }
+    int index = row * columns + column;
+    return index < itemCount() ? index : -1;
+}
+
+bool LotView::isCellVisible(int index) const {
+    return viewport()->rect().intersects(cellRect(index));
+}
+
+void LotView::scrollToCell(int index) {
+    QRect rect = cellRect(index);
+    if (rect.isNull() || viewport()->rect().contains(rect)) return;
+    verticalScrollBar()->setValue(verticalScrollBar()->value() + rect.top() - (viewport()->height() - rect.height()) / 2);
+    horizontalScrollBar()->setValue(horizontalScrollBar()->value() + rect.left() - spacing);
+}
+
+void LotView::setCellMasked(int index, bool masked) {
+    bool changed = masked ? !maskedCells.contains(index) : maskedCells.remove(index);
+    if (masked) maskedCells.insert(index);
+    if (changed) viewport()->update(cellRect(index));
+}
+
+void LotView::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+    int first = topLeft.row();
+    int last = bottomRight.row();
+    if (last - first >= kMaxRepaintRange) {
+        viewport()->update();
+        return;
+    }
+    // 只为落在视口内的格子申请重绘
+    QRect visible = viewport()->rect();
+    QRect dirty;
+    for (int i = first; i <= last; ++i) {
+        QRect rect = cellRect(i);
+        if (rect.intersects(visible)) dirty |= rect;
+    }
+    if (!dirty.isNull()) viewport()->update(dirty);
+}
+
+void LotView::paintEvent(QPaintEvent *event) {
+    PARK_TRACE_SCOPE(ViewPaint);
+    QPainter painter(viewport());
+    QRect area = event->rect();
+    painter.fillRect(area, palette().color(QPalette::Window));
+    if (!model || itemCount() == 0) return;
+
+    // 由重绘区域直接算出可见的行列范围，只绘制这些格子
+    int stepX = cell.width() + spacing;
+    int stepY = cell.height() + spacing;
+    int offsetX = horizontalScrollBar()->value();
+    int offsetY = verticalScrollBar()->value();
+    int firstRow = qMax(0, (area.top() + offsetY - spacing) / stepY);
+    int lastRow = qMin(rowCount() - 1, (area.bottom() + offsetY) / stepY);
+    int firstColumn = qMax(0, (area.left() + offsetX - spacing) / stepX);
+    int lastColumn = qMin(columns - 1, (area.right() + offsetX) / stepX);
+
+    QSize iconSize(cell.width() * 4 / 5, cell.height() * 3 / 5);
+    QPixmap carPixmap = IconCache::pixmap(":/images/car_icon.png", iconSize);
+    QPixmap emptyPixmap = IconCache::pixmap(":/images/empty_spot.png", iconSize);
+    bool showText = cell.width() >= 64;
+    QFont font = painter.font();
+    font.setPixelSize(qMax(8, cell.height() / 6));
+    painter.setFont(font);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            int index = row * columns + column;
+            if (index >= itemCount()) break;
+
+            QRect rect = cellRect(index);
+            QModelIndex modelIndex = model->index(index, 0);
+            bool occupied = !maskedCells.contains(index)
+                            && model->data(modelIndex, ParkingLotModel::OccupiedRole).toBool();
+
+            painter.fillRect(rect, cellColor);
+            painter.setPen(palette().color(QPalette::Mid));
+            painter.drawRect(rect.adjusted(0, 0, -1, -1));
+
+            const QPixmap &pixmap = occupied ? carPixmap : emptyPixmap;
+            QPoint iconPos(rect.left() + (rect.width() - pixmap.width()) / 2,
+                           rect.top() + (rect.height() - pixmap.height()) / 2);
+            painter.drawPixmap(iconPos, pixmap);
+
+            if (showText) {
+                painter.setPen(cellColor.lightness() < 128 ? Qt::white : Qt::black);
+                painter.drawText(rect.adjusted(3, 1, -3, -1), Qt::AlignLeft | Qt::AlignTop, QString::number(index + 1));
+                QString tag = model->data(modelIndex, ParkingLotModel::SpotTagRole).toString();
+                if (!tag.isEmpty()) {
+                    painter.drawText(rect.adjusted(3, 1, -3, -1), Qt::AlignRight | Qt::AlignTop, tag);
+                }
+                if (occupied) {
+                    painter.drawText(rect.adjusted(3, 1, -3, -1), Qt::AlignHCenter | Qt::AlignBottom,
+                                     model->data(modelIndex, Qt::DisplayRole).toString());
+                }
+            }
+        }
+    }
+}
+
+void LotView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateLayout();
+}
+
+void LotView::mousePressEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        int index = indexAt(event->pos());
+        if (index >= 0) emit cellClicked(index);
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void LotView::wheelEvent(QWheelEvent *event) {
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QAbstractScrollArea::wheelEvent(event);
+        return;
+    }
+
+    // Ctrl+滚轮缩放，保持视口中心附近的格子不动
+    int anchor = indexAt(viewport()->rect().center());
+    double factor = event->angleDelta().y() > 0 ? 1.15 : 1.0 / 1.15;
+    setCellSize(QSize(qRound(cell.width() * factor), qRound(cell.height() * factor)));
+    if (anchor >= 0) {
+        QRect rect = cellRect(anchor);
+        verticalScrollBar()->setValue(verticalScrollBar()->value() + rect.center().y() - viewport()->height() / 2);
+    }
+    event->accept();
+}
+
+bool LotView::viewportEvent(QEvent *event) {
+    if (event->type() == QEvent::ToolTip && model) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        int index = indexAt(helpEvent->pos());
+        if (index >= 0) {
+            QToolTip::showText(helpEvent->globalPos(),
+                               model->data(model->index(index, 0), Qt::ToolTipRole).toString(),
+                               viewport(), cellRect(index));
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QAbstractScrollArea::viewportEvent(event);
+}
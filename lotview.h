@@ -0,0 +1,62 @@
+#ifndef LOTVIEW_H
+#define LOTVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QColor>
+#include <QPointer>
+#include <QSet>
+#include <QSize>
+
+class QAbstractItemModel;
+class QModelIndex;
+
+// LotView 类
+// 以网格方式显示车位/队列模型的虚拟化视图：不为每个格子创建控件，
+// 只绘制可见区域内的格子，点击通过坐标换算命中格子，Ctrl+滚轮缩放。
+// 格子是否有车取自模型的 ParkingLotModel::OccupiedRole。
+class LotView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    explicit LotView(QWidget *parent = nullptr);
+
+    void setModel(QAbstractItemModel *model);
+    void setFixedColumns(int columns);  // 0 表示按视口宽度自动计算列数
+    void setCellSize(const QSize &size);
+    QSize cellSize() const { return cell; }
+    void setCellColor(const QColor &color);
+
+    QRect cellRect(int index) const;          // 视口坐标
+    int indexAt(const QPoint &pos) const;     // 视口坐标，未命中格子返回 -1
+    bool isCellVisible(int index) const;
+    void scrollToCell(int index);
+
+    // 动画进行中的格子先按空车位绘制，等车辆图标“到达”后再显示
+    void setCellMasked(int index, bool masked);
+
+signals:
+    void cellClicked(int index);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
+
+private:
+    void updateLayout();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    int itemCount() const;
+    int rowCount() const;
+
+    QPointer<QAbstractItemModel> model;
+    int fixedColumns = 0;
+    int columns = 1;
+    QSize cell{100, 60};
+    int spacing = 6;
+    QColor cellColor;
+    QSet<int> maskedCells;
+};
+
+#endif // LOTVIEW_H
@@ -1,11 +1,89 @@
 #include "mainwindow.h"
+#include "headlessserver.h"
+#include "lotconfig.h"
+#include "lotstartup.h"
+#include "tracing.h"
 
 #include <QApplication>
+#include <QDir>
+#include <QLockFile>
+#include <QMessageBox>
+
+#include <cstdio>
+#include <memory>
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-    MainWindow w;
+    // 启动配置依次取 PARK_* 环境变量、--config 指定的配置文件和命令行参数。
+    // 先按原始参数读一遍以决定是否创建界面；-style 等 Qt 自带的参数在创建 QApplication 后才被移除，
+    // 所以第一遍出错时按有界面处理，创建应用对象后再正式读取
+    QStringList rawArguments;
+    for (int i = 0; i < argc; ++i) rawArguments.append(QString::fromLocal8Bit(argv[i]));
+    LotConfig config;
+    QString configError;
+    QString helpText;
+    LotConfig::load(rawArguments, &config, &configError, &helpText);
+
+    std::unique_ptr<QCoreApplication> app;
+    if (config.headless) {
+        app.reset(new QCoreApplication(argc, argv));
+    } else {
+        app.reset(new QApplication(argc, argv));
+    }
+    bool configured = LotConfig::load(app->arguments(), &config, &configError, &helpText);
+
+    if (!configured || !helpText.isEmpty()) {
+        QString text = configured ? helpText : configError;
+        if (!qobject_cast<QApplication *>(app.get())) {
+            std::fprintf(stderr, "%s\n", qPrintable(text));
+        } else if (configured) {
+            QMessageBox::information(nullptr, "启动参数", text);
+        } else {
+            QMessageBox::critical(nullptr, "启动参数错误", text);
+        }
+        return configured ? 0 : 1;
+    }
+
+    // 同一状态目录只允许一个实例（界面或无界面服务）写预写日志和快照，锁在进程退出前一直持有；
+    // 持有者异常退出后按进程号判定为过期锁，不按时间过期
+    QString stateDirectory = LotStartup::stateDirectoryFor(config);
+    QDir().mkpath(stateDirectory);
+    QLockFile stateLock(stateDirectory + "/park.lock");
+    stateLock.setStaleLockTime(0);
+    if (!stateLock.tryLock(0)) {
+        QString text = QString("状态目录 %1 正被另一个停车场实例使用").arg(stateDirectory);
+        if (!qobject_cast<QApplication *>(app.get())) {
+            std::fprintf(stderr, "%s\n", qPrintable(text));
+        } else {
+            QMessageBox::critical(nullptr, "无法启动", text);
+        }
+        return 1;
+    }
+
+    // 时钟倍速大于 1 时停车场时间按该倍速流逝，便于演示长时间计费
+    std::unique_ptr<ScaledClock> scaledClock;
+    if (config.clockSpeed > 1.0) {
+        scaledClock.reset(new ScaledClock(config.clockSpeed));
+    }
+    const Clock *clock = scaledClock ? scaledClock.get() : Clock::system();
+
+    // 计时模式为 histogram|timeline 时从启动起就开始计时，之后也可在诊断面板中切换
+    TraceMode traceMode;
+    if (Tracer::parseMode(config.traceMode, &traceMode)) {
+        Tracer::setMode(traceMode);
+    }
+
+    if (config.headless) {
+        // 无界面服务：道闸控制器和缴费机通过本地套接字或 TCP 发送 ParkProtocol 请求
+        HeadlessServer server(config, clock);
+        HeadlessServer::quitOnTerminationSignals();  // Ctrl+C 或 SIGTERM 时正常退出并写快照
+        QString error;
+        bool started = server.start(&error);
+        if (!error.isEmpty()) std::fprintf(stderr, "%s\n", qPrintable(error));
+        return started ? app->exec() : 1;
+    }
+
+    MainWindow w(nullptr, clock, config);
     w.show();
-    return a.exec();
+    return app->exec();
 }
@@ -1,447 +1,653 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include <QMessageBox>
-#include <QDateTime>
+#include "iconcache.h"
+#include "tracing.h"
+#include <QDir>
+#include <QStandardPaths>
 #include <QInputDialog>
-#include <QPropertyAnimation>
-#include <QSequentialAnimationGroup>
 #include <QTimer>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QThread>
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include "log.h"
+#include "animationscheduler.h"
+#include "lotview.h"
+#include "parkinglotmodel.h"
+#include "parkingjournal.h"
+#include "lotanalytics.h"
+#include "platesearchindex.h"
+#include "stayhistory.h"
+#include "statspanel.h"
+#include "diagnosticspanel.h"
+#include "lottopology.h"
+#include "topologypanel.h"
+#include "parkingcommandqueue.h"
+#include "commandbar.h"
+#include "lotstartup.h"
 
-// Vehicle 实现
-Vehicle::Vehicle(const QString &licensePlate)
-    : licensePlate(licensePlate), entryTime(QDateTime::currentDateTime()) {}
+// MainWindow 实现
+MainWindow::MainWindow(QWidget *parent, const Clock *clock, const LotConfig &config)
+    : QMainWindow(parent), ui(new Ui::MainWindow),
+    parkingLot(10, 5, clock), lotThread(new QThread(this)) {
+    ui->setupUi(this);
 
-QString Vehicle::getLicensePlate() const { return licensePlate; }
-QDateTime Vehicle::getEntryTime() const { return entryTime; }
+    refreshTimer = new QTimer(this);
+    refreshTimer->setSingleShot(true);
+    refreshTimer->setInterval(16);  // 约一帧
+    connect(refreshTimer, &QTimer::timeout, this, &MainWindow::refreshDirty);
 
-// ParkingSpotManager 实现
-ParkingSpotManager::ParkingSpotManager(int totalSpots) : totalSpots(totalSpots) {}
+    animationScheduler = new AnimationScheduler(this, this);
+    connect(animationScheduler, &AnimationScheduler::animationFinished, this, &MainWindow::onAnimationFinished);
 
-void ParkingSpotManager::parkVehicle(const Vehicle &vehicle) {
-    if (parkingSpots.size() < totalSpots) {
-        parkingSpots.append(vehicle);
-    }
-}
+    logWindow = new LogWindow();
+    logWindow->setClock(clock);
+    logWindow->show();  // Show the log window on start (you can control when to show it)
 
-void ParkingSpotManager::removeVehicle(const QString &licensePlate) {
-    for (int i = 0; i < parkingSpots.size(); ++i) {
-        if (parkingSpots[i].getLicensePlate() == licensePlate) {
-            parkingSpots.remove(i);  // 移除车辆
-            break;  // 找到后立即退出循环
-        }
+    // 日志同时异步写入应用数据目录下可轮转的文件
+    QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/logs";
+    if (QDir().mkpath(logDir)) {
+        logWindow->setSpillFile(logDir + "/park.log");
     }
-}
-
-bool ParkingSpotManager::isFull() const {
-    return parkingSpots.size() >= totalSpots;
-}
 
-QVector<Vehicle> ParkingSpotManager::getParkedVehicles() const {
-    return parkingSpots;
-}
+    // 初始化窗口大小
+    this->resize(800, 600);
 
-bool ParkingSpotManager::hasVehicle(const QString &licensePlate) const {
-    for (const Vehicle &vehicle : parkingSpots) {
-        if (vehicle.getLicensePlate() == licensePlate) {
-            return true;
+    // 先从预写日志和快照恢复上次的停车场状态，再按需导入状态文件；都没有时才询问未配置的停车位和队列容量
+    LotStartup startup(config, &parkingLot, clock);
+    if (!startup.restore()) {
+        // 用户输入停车位和队列容量
+        bool ok;
+        int totalSpots = startup.configuredSpots();
+        if (totalSpots <= 0) {
+            totalSpots = QInputDialog::getInt(this, "停车位数量", "请输入停车场的停车位数量:", 10, 1, 100000, 1, &ok);
+            if (!ok) totalSpots = 10;
         }
-    }
-    return false;
-}
 
-// QueueManager 实现
-QueueManager::QueueManager(int maxCapacity) : maxCapacity(maxCapacity) {}
+        int maxQueueSize = config.maxQueueCapacity;
+        if (maxQueueSize <= 0) {
+            maxQueueSize = QInputDialog::getInt(this, "等待队列容量", "请输入等待队列的最大容量:", 5, 1, 1000, 1, &ok);
+            if (!ok) maxQueueSize = 5;
+        }
 
-void QueueManager::addVehicleToQueue(const Vehicle &vehicle) {
-    if (waitingQueue.size() < maxCapacity) {
-        waitingQueue.enqueue(vehicle);
+        // 初始化停车场和队列管理器
+        startup.createLot(totalSpots, maxQueueSize);
     }
-}
-
-Vehicle QueueManager::dequeueVehicle() {
-    return waitingQueue.dequeue();
-}
-
-bool QueueManager::isQueueEmpty() const {
-    return waitingQueue.isEmpty();
-}
 
-bool QueueManager::isQueueFull() const {
-    return waitingQueue.size() >= maxCapacity;
-}
-
-QQueue<Vehicle> QueueManager::getWaitingQueue() const {
-    return waitingQueue;
-}
-
-bool QueueManager::hasVehicleInQueue(const QString &licensePlate) const {
-    for (const Vehicle &vehicle : waitingQueue) {
-        if (vehicle.getLicensePlate() == licensePlate) {
-            return true;
-        }
+    // 拓扑、布局和分配策略每次启动重新应用，之后的每次状态变化都写入日志
+    startup.finish();
+    for (const QString &message : startup.getMessages()) {
+        logWindow->addLogMessage(message);
     }
-    return false;
-}
-
-// MainWindow 实现
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow),
-    parkingSpotManager(10), queueManager(5), isAnimating(false) {
-    ui->setupUi(this);
-    logWindow = new LogWindow();
-    logWindow->show();  // Show the log window on start (you can control when to show it)
-
-    // 初始化窗口大小
-    this->resize(800, 600);
-
-    // 用户输入停车位和队列容量
-    bool ok;
-    int totalSpots = QInputDialog::getInt(this, "停车位数量", "请输入停车场的停车位数量:", 10, 1, 100, 1, &ok);
-    if (!ok) totalSpots = 10;
-
-    int maxQueueSize = QInputDialog::getInt(this, "等待队列容量", "请输入等待队列的最大容量:", 5, 1, 20, 1, &ok);
-    if (!ok) maxQueueSize = 5;
-
-    // 初始化停车场和队列管理器
-    parkingSpotManager = ParkingSpotManager(totalSpots);
-    queueManager = QueueManager(maxQueueSize);
+    occupancy = startup.getOccupancy();
+    journal = startup.getJournal();
+
+    analytics = new LotAnalytics(&parkingLot, &tariffEngine);
+    parkingLot.addObserver(analytics);
+
+    searchIndex = new PlateSearchIndex(&parkingLot);
+    parkingLot.addObserver(searchIndex);
+
+    history = new StayHistory(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/history", &tariffEngine);
+    parkingLot.addObserver(history);
+
+    // 入库、出库等命令都在工作线程上批量应用到停车场，结果按批送回界面线程，
+    // 操作员输入和界面刷新不再等待计费和写日志
+    parkingService = new ParkingService(&parkingLot, &tariffEngine);
+    // 历史查询、本月到访和相近车牌都在工作线程上读取，与出库时的追加不会并发
+    parkingService->setHistory(history);
+    parkingService->setSearchIndex(searchIndex);
+    commandQueue = new ParkingCommandQueue(parkingService, &lotMutex);
+    commandQueue->setJournal(journal);  // 命令结果在预写日志落盘后才显示为成功
+    commandQueue->moveToThread(lotThread);
+    connect(commandQueue, &ParkingCommandQueue::batchFinished, this, &MainWindow::onCommandBatchFinished);
+
+    // 定期生成快照缩短下次恢复的重放量；快照的编码和写盘与命令排在工作线程的同一个事件队列里，界面线程不持锁
+    checkpointTimer = new QTimer(this);
+    checkpointTimer->setInterval(60 * 1000);
+    connect(checkpointTimer, &QTimer::timeout, this, [this]() {
+        QMetaObject::invokeMethod(commandQueue, [this]() {
+            QMutexLocker locker(&lotMutex);
+            if (journal->recordsSinceCheckpoint() > 0) journal->checkpoint(parkingLot);
+        });
+    });
+    checkpointTimer->start();
 
     setupUI();
-    updateParkingStatus();
-    updateQueueStatus();
+    lotThread->start();
 }
 
 MainWindow::~MainWindow() {
+    // 先停工作线程，再在当前线程执行完已提交的命令，保证它们都写入日志
+    disconnect(commandQueue, nullptr, this, nullptr);
+    lotThread->quit();
+    lotThread->wait();
+    commandQueue->processPending();
+    delete commandQueue;
+    delete parkingService;
+
+    parkingLot.setAllocationPolicy(std::make_shared<NearestEntrancePolicy>());  // 楼层均衡策略引用 occupancy
+    parkingLot.removeObserver(occupancy);
+    delete occupancy;
+    parkingLot.removeObserver(history);
+    delete history;
+    parkingLot.removeObserver(searchIndex);
+    delete searchIndex;
+    parkingLot.removeObserver(analytics);
+    delete analytics;
+
+    // 退出前写一次快照，等日志全部落盘
+    parkingLot.removeObserver(journal);
+    journal->checkpoint(parkingLot);
+    delete journal;
+
     delete ui;  // 释放 UI 资源
 }
 
 void MainWindow::setupUI() {
     QWidget *mainWidget = new QWidget(this);
-    QGridLayout *mainLayout = new QGridLayout(mainWidget);
-
-    queueButtons.clear();
-    parkingSpotButtons.clear();
-
-    int totalSpots = parkingSpotManager.getTotalSpots();
-    int cols = 5;
-    int rows = (totalSpots + cols - 1) / cols;
-
-    // 初始化等待队列按钮
-    for (int i = 0; i < queueManager.getMaxCapacity(); ++i) {
-        QPushButton *queueButton = new QPushButton(this);
-        queueButton->setFixedSize(100, 50);
-        queueButton->setIcon(QIcon(":/images/empty_spot.png"));
-
-        // 设置队列按钮的背景为深灰色
-        queueButton->setStyleSheet("background-color: #2E2E2E; color: white;");
-
-        // 队列按钮点击事件，显示队列中车辆信息
-        connect(queueButton, &QPushButton::clicked, this, [=]() {
-            QQueue<Vehicle> waitingQueue = queueManager.getWaitingQueue();
-            if (i < waitingQueue.size()) {
-                Vehicle vehicle = waitingQueue.at(i);
-                QString message = QString("车牌号: %1\n进入队列时间: %2")
-                                      .arg(vehicle.getLicensePlate())
-                                      .arg(vehicle.getEntryTime().toString("yyyy-MM-dd hh:mm:ss"));
-                QMessageBox::information(this, "等待车辆信息", message);
-            } else {
-                QMessageBox::information(this, "等待车辆信息", "该位置无等待车辆");
-            }
-        });
+    QVBoxLayout *mainLayout = new QVBoxLayout(mainWidget);
+    QHBoxLayout *lotLayout = new QHBoxLayout();
+
+    lotModel = new ParkingLotModel(&parkingLot, this);
+    queueModel = new WaitingQueueModel(&parkingLot, this);
+    lotModel->setLotMutex(&lotMutex);
+    queueModel->setLotMutex(&lotMutex);
+
+    // 等待队列：单列，深灰色背景
+    queueView = new LotView(mainWidget);
+    queueView->setFixedColumns(1);
+    queueView->setCellColor(QColor("#2E2E2E"));
+    queueView->setModel(queueModel);
+    queueView->setFixedWidth(queueView->cellSize().width() + 32);
+    connect(queueView, &LotView::cellClicked, this, &MainWindow::onQueueSlotClicked);
+
+    // 停车位：按视口宽度自动排列，只绘制可见格子，点击按坐标命中
+    lotView = new LotView(mainWidget);
+    lotView->setModel(lotModel);
+    connect(lotView, &LotView::cellClicked, this, &MainWindow::onSpotClicked);
+
+    // 车牌查找：边输入边显示候选，支持部分车牌和易混字符
+    searchEdit = new QLineEdit(mainWidget);
+    searchEdit->setPlaceholderText("查找车牌：可输入部分车牌，0/O、8/B、1/I 等易混字符也能匹配");
+    searchEdit->setClearButtonEnabled(true);
+    searchResults = new QListWidget(mainWidget);
+    searchResults->setMaximumHeight(120);
+    searchResults->hide();
+    connect(searchEdit, &QLineEdit::textChanged, this, &MainWindow::refreshSearchResults);
+    connect(searchEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (searchResults->count() > 0) onSearchResultClicked(searchResults->item(0));
+    });
+    connect(searchResults, &QListWidget::itemClicked, this, &MainWindow::onSearchResultClicked);
+    mainLayout->addWidget(searchEdit);
+    mainLayout->addWidget(searchResults);
 
-        mainLayout->addWidget(queueButton, i, 0);
-        queueButtons.append(queueButton);
-    }
+    lotLayout->addWidget(queueView);
+    lotLayout->addWidget(lotView, 1);
+    mainLayout->addLayout(lotLayout, 1);
 
-    // 初始化停车位按钮
-    for (int i = 0; i < totalSpots; ++i) {
-        QPushButton *parkSpotButton = new QPushButton(this);
-        parkSpotButton->setIcon(QIcon(":/images/empty_spot.png"));
-
-        // 停车位点击事件，显示车辆信息
-        connect(parkSpotButton, &QPushButton::clicked, this, [=]() {
-            QVector<Vehicle> parkedVehicles = parkingSpotManager.getParkedVehicles();
-            if (i < parkedVehicles.size()) {
-                Vehicle vehicle = parkedVehicles[i];
-                QString message = QString("车牌号: %1\n停车时间: %2")
-                                      .arg(vehicle.getLicensePlate())
-                                      .arg(vehicle.getEntryTime().toString("yyyy-MM-dd hh:mm:ss"));
-                QMessageBox::information(this, "停车位信息", message);
-            } else {
-                QMessageBox::information(this, "停车位信息", "该车位空置");
-            }
-        });
+    // 命令栏：非模态输入，结果显示在栏内
+    commandBar = new CommandBar(mainWidget);
+    connect(commandBar, &CommandBar::commandsSubmitted, this, &MainWindow::onCommandsSubmitted);
+    mainLayout->addWidget(commandBar);
 
-        mainLayout->addWidget(parkSpotButton, i / cols, (i % cols) + 1);
-        parkingSpotButtons.append(parkSpotButton);
-    }
+    int totalSpots = parkingLot.getSpotManager().getTotalSpots();
+    spotDirty = QVector<bool>(totalSpots, false);
+    dirtySpots.clear();
+    queueDirty = false;
 
     parkButton = new QPushButton("停车", this);
     releaseButton = new QPushButton("取车", this);
     queryButton = new QPushButton("查询", this);
     aboutButton = new QPushButton("关于", this);
+    settleButton = new QPushButton("日结算", this);
+    statsButton = new QPushButton("统计", this);
+    historyButton = new QPushButton("历史", this);
+    diagnosticsButton = new QPushButton("诊断", this);
+    topologyButton = new QPushButton("楼层", this);
+    exportButton = new QPushButton("导出", this);
 
     connect(parkButton, &QPushButton::clicked, this, &MainWindow::onParkButtonClicked);
     connect(releaseButton, &QPushButton::clicked, this, &MainWindow::onReleaseButtonClicked);
     connect(queryButton, &QPushButton::clicked, this, &MainWindow::onQueryButtonClicked);
     connect(aboutButton, &QPushButton::clicked, this, &MainWindow::onAboutButtonClicked);
-
-    mainLayout->addWidget(parkButton, rows, 2);
-    mainLayout->addWidget(releaseButton, rows + 1, 2);
-    mainLayout->addWidget(queryButton, rows, 4);
-    mainLayout->addWidget(aboutButton, rows + 1, 4);
+    connect(settleButton, &QPushButton::clicked, this, &MainWindow::onSettleButtonClicked);
+    connect(statsButton, &QPushButton::clicked, this, &MainWindow::onStatsButtonClicked);
+    connect(historyButton, &QPushButton::clicked, this, &MainWindow::onHistoryButtonClicked);
+    connect(diagnosticsButton, &QPushButton::clicked, this, &MainWindow::onDiagnosticsButtonClicked);
+    connect(topologyButton, &QPushButton::clicked, this, &MainWindow::onTopologyButtonClicked);
+    connect(exportButton, &QPushButton::clicked, this, &MainWindow::onExportButtonClicked);
+
+    QGridLayout *buttonLayout = new QGridLayout();
+    buttonLayout->addWidget(parkButton, 0, 0);
+    buttonLayout->addWidget(releaseButton, 1, 0);
+    buttonLayout->addWidget(queryButton, 0, 1);
+    buttonLayout->addWidget(aboutButton, 1, 1);
+    buttonLayout->addWidget(settleButton, 0, 2);
+    buttonLayout->addWidget(statsButton, 1, 2);
+    buttonLayout->addWidget(historyButton, 0, 3);
+    buttonLayout->addWidget(diagnosticsButton, 1, 3);
+    buttonLayout->addWidget(topologyButton, 0, 4);
+    buttonLayout->addWidget(exportButton, 1, 4);
+    mainLayout->addLayout(buttonLayout);
 
     setCentralWidget(mainWidget);
 }
 
-void MainWindow::resizeEvent(QResizeEvent *event) {
-    // 动态调整按钮大小
-    int availableWidth = centralWidget()->width();
-    int availableHeight = centralWidget()->height();
-    int cols = 5;
-    int rows = (parkingSpotManager.getTotalSpots() + cols - 1) / cols;
-    int buttonWidth = availableWidth / (cols + 1);
-    int buttonHeight = availableHeight / (rows + 3);
+void MainWindow::onSpotClicked(int spot) {
+    std::optional<Vehicle> vehicle;
+    {
+        QMutexLocker locker(&lotMutex);
+        vehicle = parkingLot.getSpotManager().getVehicleAt(spot);
+    }
+    if (!vehicle) {
+        commandBar->addResult(QString("%1 号车位空置").arg(spot + 1));
+        return;
+    }
+    // 车牌填入命令栏并切换到出库，回车即可取车
+    commandBar->addResult(QString("%1 号车位：%2，停车时间 %3")
+                              .arg(spot + 1)
+                              .arg(vehicle->getLicensePlate())
+                              .arg(formatTimestamp(vehicle->getEntryTime())));
+    commandBar->setAction(ParkCommandType::Release);
+    commandBar->setInputText(vehicle->getLicensePlate());
+}
 
-    buttonWidth = qBound(80, buttonWidth, 150);
-    buttonHeight = qBound(50, buttonHeight, 150);
+void MainWindow::onQueueSlotClicked(int position) {
+    QString message;
+    QString licensePlate;
+    {
+        QMutexLocker locker(&lotMutex);
+        if (const Vehicle *vehicle = parkingLot.getQueueManager().getVehicleAt(position)) {
+            licensePlate = vehicle->getLicensePlate();
+            message = QString("排队第 %1 位：%2，%3，进入队列时间 %4")
+                          .arg(position + 1)
+                          .arg(licensePlate)
+                          .arg(priorityClassName(vehicle->getPriorityClass()))
+                          .arg(formatTimestamp(vehicle->getEntryTime()));
+        }
+    }
+    if (licensePlate.isEmpty()) {
+        commandBar->addResult("该位置无等待车辆");
+        return;
+    }
+    // 代替原来的确认对话框：车牌填入命令栏并切换到取消排队，回车即让该车辆放弃排队
+    commandBar->addResult(message);
+    commandBar->setAction(ParkCommandType::Cancel);
+    commandBar->setInputText(licensePlate);
+}
 
-    QSize buttonSize(buttonWidth, buttonHeight);
-    QSize iconSize(buttonWidth * 0.8, buttonHeight * 0.8);
+void MainWindow::markSpotDirty(int spot) {
+    if (spot < 0 || spot >= spotDirty.size()) return;
+    if (!spotDirty[spot]) {
+        spotDirty[spot] = true;
+        dirtySpots.append(spot);
+    }
+    if (!refreshTimer->isActive()) refreshTimer->start();
+}
 
-    for (QPushButton *button : parkingSpotButtons) {
-        button->setFixedSize(buttonSize);
-        button->setIconSize(iconSize);
+void MainWindow::markQueueDirty() {
+    queueDirty = true;
+    if (!refreshTimer->isActive()) refreshTimer->start();
+}
+
+void MainWindow::refreshDirty() {
+    PARK_TRACE_SCOPE(UiRefresh);
+    // 通知模型后，视图只重绘落在可见区域内的格子
+    if (!dirtySpots.isEmpty()) {
+        for (int spot : dirtySpots) {
+            spotDirty[spot] = false;
+        }
+        lotModel->notifySpotsChanged(dirtySpots);
+        dirtySpots.clear();
     }
 
-    for (QPushButton *button : queueButtons) {
-        button->setFixedSize(buttonSize);
-        button->setIconSize(iconSize);
+    if (queueDirty) {
+        queueDirty = false;
+        queueModel->notifyQueueChanged();
     }
 
-    QMainWindow::resizeEvent(event);
+    // 停车场状态变化后，正在显示的查找结果随之更新
+    if (searchResults->isVisible()) {
+        refreshSearchResults();
+    }
 }
 
-void MainWindow::updateParkingStatus() {
-    QVector<Vehicle> parkedVehicles = parkingSpotManager.getParkedVehicles();
-    for (int i = 0; i < parkingSpotButtons.size(); ++i) {
-        parkingSpotButtons[i]->setIcon(QIcon(i < parkedVehicles.size() ? ":/images/car_icon.png" : ":/images/empty_spot.png"));
+void MainWindow::refreshSearchResults() {
+    searchResults->clear();
+    QString query = searchEdit->text();
+    if (query.trimmed().isEmpty()) {
+        searchResults->hide();
+        return;
     }
-}
 
-void MainWindow::updateQueueStatus() {
-    QQueue<Vehicle> waitingQueue = queueManager.getWaitingQueue();
-    QSize parkingIconSize = parkingSpotButtons.isEmpty() ? QSize(80, 80) : parkingSpotButtons[0]->iconSize();
-    for (int i = 0; i < queueButtons.size(); ++i) {
-        queueButtons[i]->setIcon(QIcon(i < waitingQueue.size() ? ":/images/car_icon.png" : ":/images/empty_spot.png"));
-        queueButtons[i]->setIconSize(parkingIconSize);
+    QVector<PlateSearchHit> hits;
+    {
+        QMutexLocker locker(&lotMutex);
+        hits = searchIndex->search(query);
+    }
+    for (const PlateSearchHit &hit : hits) {
+        QString text = QString("%1    %2").arg(hit.plate.toString(), platePresenceName(hit.presence));
+        if (hit.presence == PlatePresence::Parked) {
+            text += QString(" · %1 号车位").arg(hit.spot + 1);
+        } else if (hit.presence == PlatePresence::Departed) {
+            text += QString(" · %1").arg(formatTimestamp(hit.time));
+        }
+        QListWidgetItem *item = new QListWidgetItem(text, searchResults);
+        item->setData(Qt::UserRole, hit.plate.toString());
     }
+    if (hits.isEmpty()) {
+        QListWidgetItem *item = new QListWidgetItem("没有匹配的车牌", searchResults);
+        item->setFlags(Qt::NoItemFlags);
+    }
+    searchResults->show();
 }
 
-void MainWindow::playVehicleAnimation(QPushButton *targetButton, const QString &vehicleIconPath, bool isEntering) {
-    if (isAnimating) return; // 如果有动画在进行，跳过
-
-    isAnimating = true; // 标记动画开始
+void MainWindow::onSearchResultClicked(QListWidgetItem *item) {
+    PlateKey plate(item->data(Qt::UserRole).toString());
+    if (!plate.isValid()) return;
+
+    // 按停车场当前状态显示，列表可能还停留在上一帧
+    int spot;
+    bool queued;
+    {
+        QMutexLocker locker(&lotMutex);
+        spot = parkingLot.getSpotManager().findSpot(plate);
+        queued = spot < 0 && parkingLot.getQueueManager().hasVehicleInQueue(plate);
+    }
+    if (spot >= 0) {
+        lotView->scrollToCell(spot);
+        onSpotClicked(spot);
+    } else if (queued) {
+        commandBar->addResult(QString("车牌号 %1 正在等待队列中").arg(plate.toString()));
+    } else {
+        commandBar->addResult(QString("车牌号 %1 已离场").arg(plate.toString()));
+    }
+}
 
-    clearAnimations(); // 清理任何遗留的动画
+QString MainWindow::similarPlates(const ParkReply &reply) const {
+    return reply.similarPlates.isEmpty() ? QString() : QString("\n\n相近的在场车牌：%1").arg(reply.similarPlates.join("、"));
+}
 
-    QSize iconSize = targetButton->iconSize();
-    movingCarLabel = new QLabel(this);
+void MainWindow::playVehicleAnimation(int spot, bool isEntering) {
+    markSpotDirty(spot); // 状态已提交，按车位的实际状态刷新
 
-    movingCarLabel->setPixmap(QPixmap(vehicleIconPath).scaled(iconSize, Qt::KeepAspectRatio));
-    movingCarLabel->setGeometry(targetButton->x(), isEntering ? this->height() : targetButton->y(), iconSize.width(), iconSize.height());
-    movingCarLabel->show();
-    movingCarLabel->raise();
+    // 目标车位不在可见区域时不播放动画
+    if (!lotView->isCellVisible(spot)) return;
 
-    QPropertyAnimation *animation = new QPropertyAnimation(movingCarLabel, "geometry", this);
-    animation->setDuration(2000); // 动画时间可以根据需要进行调整
+    QRect cellRect = lotView->cellRect(spot);
+    QRect targetRect(lotView->viewport()->mapTo(this, cellRect.topLeft()), cellRect.size());
 
+    // 入库动画期间车位先显示为空，车辆到达后再显示
     if (isEntering) {
-        animation->setStartValue(QRect(targetButton->x(), this->height(), iconSize.width(), iconSize.height())); // 从窗口底部进入
-        animation->setEndValue(targetButton->geometry()); // 到达停车位
-    } else {
-        animation->setStartValue(targetButton->geometry()); // 从停车位开始
-        animation->setEndValue(QRect(targetButton->x(), this->height() + 100, iconSize.width(), iconSize.height())); // 移出窗口之外（+100确保完全移出）
+        ++arrivingCars[spot];
+        lotView->setCellMasked(spot, true);
     }
+    animationScheduler->animate(spot, targetRect, isEntering);
+}
 
-    QSequentialAnimationGroup *animationGroup = new QSequentialAnimationGroup(this);
-    animationGroup->addAnimation(animation);
+void MainWindow::onAnimationFinished(int spot, bool isEntering) {
+    if (!isEntering) return;
+    auto it = arrivingCars.find(spot);
+    if (it != arrivingCars.end() && --it.value() <= 0) {
+        arrivingCars.erase(it);
+        lotView->setCellMasked(spot, false); // 按车位的实际状态显示
+    }
+}
 
-    connect(animationGroup, &QSequentialAnimationGroup::finished, this, [=]() {
-        targetButton->setIcon(QIcon(vehicleIconPath)); // 更新车位图标
-        movingCarLabel->deleteLater();
-        movingCarLabel = nullptr;
-        isAnimating = false; // 动画结束，重置标志
-        animationGroup->deleteLater();
-    });
+void MainWindow::onParkButtonClicked() {
+    // 车型和类别在命令栏中选择，车辆需要排队时按所选类别排队
+    commandBar->setAction(ParkCommandType::Park);
+}
 
-    animationGroup->start(QAbstractAnimation::DeleteWhenStopped);
+void MainWindow::onReleaseButtonClicked() {
+    commandBar->setAction(ParkCommandType::Release);
 }
 
-void MainWindow::clearAnimations() {
-    if (movingCarLabel) {
-        movingCarLabel->clear();
-        movingCarLabel->deleteLater();
-        movingCarLabel = nullptr;
-    }
+void MainWindow::onQueryButtonClicked() {
+    commandBar->setAction(ParkCommandType::Query);
 }
 
-void MainWindow::onParkButtonClicked() {
-    if (isAnimating) return; // 如果有动画在进行，跳过
+void MainWindow::onAboutButtonClicked() {
+    onCommandsSubmitted({ParkCommand()});  // 默认命令即为状态查询
+}
 
-    clearAnimations(); // 清理旧动画
+void MainWindow::onCommandsSubmitted(const QVector<ParkCommand> &commands) {
+    commandQueue->submit(commands);
+    commandBar->setPendingCount(commandQueue->pendingCount());
+}
 
-    QString licensePlate = QInputDialog::getText(this, "车辆入库", "请输入车牌号:");
-    if (licensePlate.isEmpty()) return;
+void MainWindow::onCommandBatchFinished(quint64, const QVector<ParkReply> &replies) {
+    // 少量命令逐条播放动画并显示结果；粘贴的大批车牌只刷新车位，结果栏只列出未成功的车牌和汇总
+    const bool animate = replies.size() <= 16;
+    int succeeded = 0;
+    for (const ParkReply &reply : replies) {
+        if (reply.status == ParkReplyStatus::Ok || reply.status == ParkReplyStatus::Queued) ++succeeded;
+        showCommandReply(reply, animate);
+    }
+    if (replies.size() == 1 && replies[0].spot >= 0) {
+        lotView->scrollToCell(replies[0].spot);
+    }
+    if (replies.size() > 1) {
+        commandBar->addResult(QString("批量处理 %1 条：成功 %2 条，未成功 %3 条")
+                                  .arg(replies.size())
+                                  .arg(succeeded)
+                                  .arg(replies.size() - succeeded),
+                              succeeded == replies.size());
+    }
+    commandBar->setPendingCount(commandQueue->pendingCount());
+}
 
-    if (parkingSpotManager.hasVehicle(licensePlate) || queueManager.hasVehicleInQueue(licensePlate)) {
-        QMessageBox::warning(this, "检查车牌号错误", "车牌号已存在！");
+void MainWindow::showCommandReply(const ParkReply &reply, bool animate) {
+    const QString licensePlate = reply.vehicle.getLicensePlate();
+    QString result;
+    bool ok = reply.status == ParkReplyStatus::Ok;
+
+    if (reply.status == ParkReplyStatus::StorageError) {
+        // 停车场已按命令修改，但修改没能写入预写日志，重启后会丢失：刷新界面，不按成功处理
+        markSpotDirty(reply.spot);
+        markSpotDirty(reply.promotedSpot);
+        markQueueDirty();
+        logWindow->addLogMessage(QString("车号 %1 的操作未能写入预写日志：%2").arg(licensePlate, reply.message));
+        commandBar->addResult(QString("%1：未能写入预写日志，操作未确认（%2）").arg(licensePlate, reply.message), false);
         return;
     }
 
-    if (parkingSpotManager.isFull()) {
-        if (queueManager.isQueueFull()) {
-            QMessageBox::warning(this, "排队失败", "等待队列已满！");
+    switch (reply.type) {
+    case ParkCommandType::Park:
+        switch (reply.status) {
+        case ParkReplyStatus::Ok:
+            if (animate) playVehicleAnimation(reply.spot, true);
+            else markSpotDirty(reply.spot);
+            logWindow->addLogEvent(LogEventType::Parked, licensePlate, QString("车号 %1 进入了停车场").arg(licensePlate));
+            result = QString("%1：已入库，%2 号车位").arg(licensePlate).arg(reply.spot + 1);
+            break;
+        case ParkReplyStatus::Queued:
+            ok = true;
+            markQueueDirty();
+            logWindow->addLogEvent(LogEventType::Queued, licensePlate, QString("车号 %1 进入了等待队列").arg(licensePlate));
+            result = QString("%1：已进入等待队列").arg(licensePlate);
+            break;
+        case ParkReplyStatus::Duplicate:
+            result = QString("%1：车牌号已存在").arg(licensePlate);
+            break;
+        case ParkReplyStatus::QueueFull:
+            result = QString("%1：等待队列已满").arg(licensePlate);
+            break;
+        case ParkReplyStatus::NoSuitableSpot:
+            result = QString("%1：停车场没有能容纳%2的车位").arg(licensePlate, vehicleClassName(reply.vehicle.getVehicleClass()));
+            break;
+        default:
+            result = QString("%1：车牌号无效").arg(licensePlate);
+            break;
+        }
+        break;
+
+    case ParkCommandType::Release:
+        if (!ok) {
+            result = QString("%1：没有找到该车牌号的车辆！").arg(licensePlate) + similarPlates(reply);
+            break;
+        }
+        // 从停车位中移除车辆后下一帧车位即显示为空，空出的车位已交给等待队列的队首车辆
+        if (animate) playVehicleAnimation(reply.spot, false);
+        else markSpotDirty(reply.spot);
+        logWindow->addLogEvent(LogEventType::Released, licensePlate, QString("车号 %1 被取出了车库").arg(licensePlate));
+        if (reply.promotedSpot >= 0) {
+            markQueueDirty();
+            if (animate) playVehicleAnimation(reply.promotedSpot, true);
+            else markSpotDirty(reply.promotedSpot);
+            logWindow->addLogEvent(LogEventType::Promoted, reply.promoted.getLicensePlate(),
+                                   QString("车号 %1 从等待队列进入了停车场").arg(reply.promoted.getLicensePlate()));
+        }
+        result = QString("%1：已出库，需支付费用 %2 元").arg(licensePlate, TariffEngine::formatCents(reply.feeCents));
+        break;
+
+    case ParkCommandType::Query: {
+        // 本月到访和相近车牌已在工作线程上查好，这里只格式化，不持锁
+        if (ok) {
+            qint64 elapsedSeconds = (parkingLot.getClock()->now() - reply.vehicle.getEntryTime()) / 1000;
+            result = QString("%1：%2 号车位，入库时间 %3，已停 %4 小时 %5 分钟，当前费用 %6 元")
+                         .arg(licensePlate)
+                         .arg(reply.spot + 1)
+                         .arg(formatTimestamp(reply.vehicle.getEntryTime()))
+                         .arg(elapsedSeconds / 3600)
+                         .arg((elapsedSeconds % 3600) / 60)
+                         .arg(TariffEngine::formatCents(reply.feeCents));
+            result += monthlyVisits(reply);
+        } else if (reply.status == ParkReplyStatus::Queued) {
+            ok = true;
+            result = QString("%1：正在等待队列中").arg(licensePlate);
         } else {
-            queueManager.addVehicleToQueue(Vehicle(licensePlate));
-            updateQueueStatus();
-            logWindow->addLogMessage(QString("车号 %1 进入了等待队列").arg(licensePlate));
-            QMessageBox::information(this, "排队成功", "车辆已进入等待队列.");
+            result = QString("%1：停车场中没有找到该车牌号的车辆！").arg(licensePlate)
+                     + monthlyVisits(reply) + similarPlates(reply);
         }
-    } else {
-        int index = parkingSpotManager.getParkedVehicles().size();
-        parkVehicleInSpot(Vehicle(licensePlate), index);
-        logWindow->addLogMessage(QString("车号 %1 进入了停车场").arg(licensePlate));
-        QMessageBox::information(this, "入库成功", "车辆已成功入库.");
+        break;
     }
-}
 
-void MainWindow::onReleaseButtonClicked() {
-    if (isAnimating) return; // 如果有动画在进行，跳过
-
-    clearAnimations(); // 清理旧的动画
-
-    QString licensePlate = QInputDialog::getText(this, "车辆出库", "请输入车牌号:");
-    if (!licensePlate.isEmpty()) {
-        QVector<Vehicle> parkedVehicles = parkingSpotManager.getParkedVehicles();
-        for (int i = 0; i < parkedVehicles.size(); ++i) {
-            if (parkedVehicles[i].getLicensePlate() == licensePlate) {
-                double cost = calculateParkingCost(parkedVehicles[i].getEntryTime());
-
-                // 获取停车位按钮
-                QPushButton *parkingButton = parkingSpotButtons[i];
-                QSize iconSize = parkingButton->iconSize();
-
-                // **首先立即设置车位为空车位图标**
-                parkingButton->setIcon(QIcon(":/images/empty_spot.png"));
-
-                // 延迟播放动画，确保图标移除后再播放动画
-                QTimer::singleShot(100, this, [=]() {
-                    // 播放车辆出库动画
-                    playVehicleAnimation(parkingButton, ":/images/car_icon.png", false);
-
-                    // 动画结束后，重新排列停车位图标
-                    QTimer::singleShot(2100, this, [=]() {
-                        rearrangeParkingSpots(); // 更新停车位状态
-
-                        // 检查是否有等待车辆可以进入
-                        if (!queueManager.isQueueEmpty()) {
-                            Vehicle waitingVehicle = queueManager.dequeueVehicle();
-                            updateQueueStatus();  // 更新队列状态
-
-                            // 获取下一个空闲车位
-                            int nextFreeIndex = parkingSpotManager.getParkedVehicles().size();
-                            if (nextFreeIndex < parkingSpotButtons.size()) {
-                                // 将排队中的车辆移到下一个空车位，并播放动画
-                                parkVehicleInSpot(waitingVehicle, nextFreeIndex);
-                            }
-                        }
-                    });
-                });
-
-                // 从停车位中移除车辆
-                parkingSpotManager.removeVehicle(licensePlate);
-
-                // 弹出提示消息
-                logWindow->addLogMessage(QString("车号 %1 被取出了车库").arg(licensePlate));
-                QMessageBox::information(this, "出库成功", QString("车辆已出库，需支付费用：%1 元").arg(cost));
-
-                return;
-            }
+    case ParkCommandType::About:
+        result = QString("总车位 %1，空车位 %2，等待队列 %3/%4，区域数 %5，分配策略 %6")
+                     .arg(reply.totalSpots)
+                     .arg(reply.freeSpots)
+                     .arg(reply.queueLength)
+                     .arg(reply.queueCapacity)
+                     .arg(reply.zoneCount)
+                     .arg(reply.policyName);
+        break;
+
+    case ParkCommandType::Cancel:
+        if (ok) {
+            markQueueDirty();
+            logWindow->addLogEvent(LogEventType::Cancelled, licensePlate, QString("车号 %1 放弃排队离开").arg(licensePlate));
+            result = QString("%1：已放弃排队").arg(licensePlate);
+        } else {
+            result = QString("%1：等待队列中没有该车牌号的车辆").arg(licensePlate);
         }
+        break;
+
+    case ParkCommandType::Settle: {
+        const SettlementReport &report = reply.settlement;
+        QStringList lines;
+        lines.append(QString("日结算：在场车辆 %1 辆，应收合计 %2 元，单车最高 %3 元，耗时 %4 毫秒")
+                         .arg(report.vehicles)
+                         .arg(TariffEngine::formatCents(report.totalCents))
+                         .arg(TariffEngine::formatCents(report.maxCents))
+                         .arg(reply.elapsedMSecs));
+        for (int i = 0; i < kVehicleClassCount; ++i) {
+            lines.append(QString("    %1: %2 辆 / %3 元")
+                             .arg(vehicleClassName(VehicleClass(i)))
+                             .arg(report.classVehicles[i])
+                             .arg(TariffEngine::formatCents(report.classCents[i])));
+        }
+        logWindow->addLogMessage(QString("日结算：%1 辆在场车辆应收 %2 元").arg(report.vehicles).arg(TariffEngine::formatCents(report.totalCents)));
+        commandBar->addResults(lines);
+        return;
+    }
 
-        // 如果未找到车牌号，给出提示
-        QMessageBox::warning(this, "出库失败", "没有找到该车牌号的车辆！");
+    case ParkCommandType::History:
+        if (ok) {
+            commandBar->addResults(QStringList{reply.message} + reply.lines);
+            return;
+        }
+        result = QString("历史记录：%1").arg(reply.message);
+        break;
+
+    case ParkCommandType::Export:
+        if (ok) {
+            logWindow->addLogMessage(QString("已导出停车场状态到 %1：在库 %2 辆，排队 %3 辆")
+                                         .arg(reply.message)
+                                         .arg(reply.totalSpots - reply.freeSpots)
+                                         .arg(reply.queueLength));
+            result = QString("已导出到 %1").arg(reply.message);
+        } else {
+            result = QString("导出失败：%1").arg(reply.message);
+        }
+        break;
     }
-}
 
-void MainWindow::parkVehicleInSpot(const Vehicle &vehicle, int index) {
-    clearAnimations(); // 清理旧动画，防止冲突
+    if (reply.status == ParkReplyStatus::BadRequest) result = reply.message.isEmpty() ? QString("无效的命令") : reply.message;
+    // 大批量时成功的结果只计入汇总
+    if (animate || !ok) commandBar->addResult(result.simplified(), ok);
+}
 
-    parkingSpotManager.parkVehicle(vehicle); // 停车前的状态更新
-    playVehicleAnimation(parkingSpotButtons[index], ":/images/car_icon.png", true); // 播放停车动画
+void MainWindow::onStatsButtonClicked() {
+    // 统计面板是独立的非模态窗口，只在可见时刷新
+    if (!statsPanel) {
+        statsPanel = new StatsPanel(analytics, &parkingLot, this);
+        statsPanel->setLotMutex(&lotMutex);
+    }
+    statsPanel->show();
+    statsPanel->raise();
+    statsPanel->activateWindow();
 }
 
-void MainWindow::onQueryButtonClicked() {
-    QString licensePlate = QInputDialog::getText(this, "查询车辆信息", "请输入车牌号:");
-    if (licensePlate.isEmpty()) return;
-
-    QVector<Vehicle> parkedVehicles = parkingSpotManager.getParkedVehicles();
-    for (const Vehicle &vehicle : parkedVehicles) {
-        if (vehicle.getLicensePlate() == licensePlate) {
-            QDateTime entryTime = vehicle.getEntryTime();
-            qint64 elapsedSeconds = entryTime.secsTo(QDateTime::currentDateTime());
-            double cost = calculateParkingCost(entryTime);
-            int hours = elapsedSeconds / 3600;
-            int minutes = (elapsedSeconds % 3600) / 60;
-            QString message = QString("车牌号: %1\n入库时间: %2\n停留时间: %3 小时 %4 分钟\n当前停车费用: %5 元")
-                                  .arg(vehicle.getLicensePlate())
-                                  .arg(entryTime.toString("yyyy-MM-dd hh:mm:ss"))
-                                  .arg(hours)
-                                  .arg(minutes)
-                                  .arg(cost);
-            QMessageBox::information(this, "车辆信息", message);
-            return;
-        }
+void MainWindow::onDiagnosticsButtonClicked() {
+    // 计时模式在面板中切换，关闭时各计时点只剩一次原子读
+    if (!diagnosticsPanel) {
+        diagnosticsPanel = new DiagnosticsPanel(this);
     }
-    QMessageBox::warning(this, "查询失败", "停车场中没有找到该车牌号的车辆！");
+    diagnosticsPanel->show();
+    diagnosticsPanel->raise();
+    diagnosticsPanel->activateWindow();
 }
 
-void MainWindow::onAboutButtonClicked() {
-    int totalParkingSpots = parkingSpotManager.getTotalSpots();
-    int availableParkingSpots = totalParkingSpots - parkingSpotManager.getParkedVehicles().size();
-    int totalQueueSpots = queueManager.getMaxCapacity();
-    int vehiclesInQueue = queueManager.getWaitingQueue().size();
-    QString message = QString("停车场总车位: %1\n停车场空车位: %2\n等待队列总位置: %3\n当前等待车辆: %4")
-                          .arg(totalParkingSpots)
-                          .arg(availableParkingSpots)
-                          .arg(totalQueueSpots)
-                          .arg(vehiclesInQueue);
-    QMessageBox::information(this, "关于停车场状态", message);
+void MainWindow::onTopologyButtonClicked() {
+    // 各停车场、楼层的余位都是聚合值，刷新不扫描车位
+    if (!topologyPanel) {
+        topologyPanel = new TopologyPanel(occupancy, this);
+        topologyPanel->setLotMutex(&lotMutex);
+    }
+    topologyPanel->show();
+    topologyPanel->raise();
+    topologyPanel->activateWindow();
 }
 
-double MainWindow::calculateParkingCost(const QDateTime &entryTime) const {
-    const double ratePerHour = 5.0;
-    qint64 elapsedSeconds = entryTime.secsTo(QDateTime::currentDateTime());
-    double hoursParked = static_cast<double>(elapsedSeconds) / 3600.0;
-    return ratePerHour * hoursParked;
+void MainWindow::onExportButtonClicked() {
+    // 导出在工作线程上执行，路径预填为应用数据目录下带时间的文件名，可在命令栏中修改
+    commandBar->setAction(ParkCommandType::Export);
+    commandBar->setInputText(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)
+                             + QDateTime::currentDateTime().toString("'/park-state-'yyyyMMdd-hhmmss'.csv'"));
 }
 
-void MainWindow::rearrangeParkingSpots() {
-    // 获取当前已停车辆
-    QVector<Vehicle> parkedVehicles = parkingSpotManager.getParkedVehicles();
+QString MainWindow::monthlyVisits(const ParkReply &reply) const {
+    if (reply.monthlyVisits == 0) return QString();
+    return QString("\n本月到访: %1 次，最近一次离场: %2").arg(reply.monthlyVisits).arg(formatTimestamp(reply.lastExitTime));
+}
 
-    // 重新按照顺序更新车位图标
-    for (int i = 0; i < parkingSpotButtons.size(); ++i) {
-        if (i < parkedVehicles.size()) {
-            // 有车辆停放时，更新为车的图标
-            parkingSpotButtons[i]->setIcon(QIcon(":/images/car_icon.png"));
-        } else {
-            // 没有车辆时，设置为空车位
-            parkingSpotButtons[i]->setIcon(QIcon(":/images/empty_spot.png"));
-        }
-    }
+void MainWindow::onHistoryButtonClicked() {
+    // 时段默认为最近两小时，清空后回车查询最近 30 天每日营收
+    const QString format = "yyyy-MM-dd hh:mm";
+    qint64 now = parkingLot.getClock()->now();
+    commandBar->setAction(ParkCommandType::History);
+    commandBar->setInputText(QString("%1 ~ %2")
+                                 .arg(QDateTime::fromMSecsSinceEpoch(now - 2 * 3600 * 1000).toString(format))
+                                 .arg(QDateTime::fromMSecsSinceEpoch(now).toString(format)));
+}
 
-    // 确保 UI 和内部状态保持一致
-    updateParkingStatus();
+void MainWindow::onSettleButtonClicked() {
+    // 按当前时间对所有在场车辆一次性计价，在工作线程上执行，报表显示在命令栏
+    ParkCommand command;
+    command.type = ParkCommandType::Settle;
+    onCommandsSubmitted({command});
 }
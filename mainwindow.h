@@ -3,62 +3,35 @@
 
 #include <QMainWindow>
 #include <QPushButton>
-#include <QVBoxLayout>
-#include <QDateTime>
 #include <QVector>
-#include <QQueue>
 #include <QString>
-#include <QGridLayout>
-#include <QInputDialog>
-#include <QResizeEvent>
-#include <QLabel>
-#include <QSequentialAnimationGroup>
-#include "log.h"  // Include the log header
-
-// Vehicle 类
-class Vehicle {
-public:
-    Vehicle(const QString &licensePlate);
-    QString getLicensePlate() const;
-    QDateTime getEntryTime() const;
-
-private:
-    QString licensePlate;
-    QDateTime entryTime;
-};
-
-// ParkingSpotManager 类
-class ParkingSpotManager {
-public:
-    ParkingSpotManager(int totalSpots);
-    void parkVehicle(const Vehicle &vehicle);
-    void removeVehicle(const QString &licensePlate);
-    bool isFull() const;
-    QVector<Vehicle> getParkedVehicles() const;
-    bool hasVehicle(const QString &licensePlate) const;
-    int getTotalSpots() const { return totalSpots; }
-
-private:
-    int totalSpots;
-    QVector<Vehicle> parkingSpots;
-};
-
-// QueueManager 类
-class QueueManager {
-public:
-    QueueManager(int maxCapacity);
-    void addVehicleToQueue(const Vehicle &vehicle);
-    Vehicle dequeueVehicle();
-    bool isQueueEmpty() const;
-    bool isQueueFull() const;
-    QQueue<Vehicle> getWaitingQueue() const;
-    bool hasVehicleInQueue(const QString &licensePlate) const;
-    int getMaxCapacity() const { return maxCapacity; }
-
-private:
-    QQueue<Vehicle> waitingQueue;
-    int maxCapacity;
-};
+#include <QHash>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMutex>
+#include "parkinglot.h"
+#include "tariff.h"
+#include "lotconfig.h"
+#include "parkingservice.h"
+
+// 只以指针持有的成员前置声明，核心头文件改动时界面不必全部重新编译
+class QThread;
+class QTimer;
+class AnimationScheduler;
+class CommandBar;
+class DiagnosticsPanel;
+class LogWindow;
+class LotAnalytics;
+class LotView;
+class ParkingCommandQueue;
+class ParkingJournal;
+class ParkingLotModel;
+class PlateSearchIndex;
+class StatsPanel;
+class StayHistory;
+class TopologyOccupancy;
+class TopologyPanel;
+class WaitingQueueModel;
 
 // MainWindow 类
 QT_BEGIN_NAMESPACE
@@ -69,44 +42,89 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    // clock 为停车场使用的时钟，可传入加速时钟做快进演示；config 为合并后的启动配置
+    MainWindow(QWidget *parent = nullptr, const Clock *clock = Clock::system(), const LotConfig &config = LotConfig());
     ~MainWindow();
 
-protected:
-    void resizeEvent(QResizeEvent *event) override;
-
 private:
     Ui::MainWindow *ui;
     LogWindow *logWindow;  // Add the log window as a member
 
-    ParkingSpotManager parkingSpotManager;
-    QueueManager queueManager;
-
-    QVector<QPushButton*> parkingSpotButtons;
-    QVector<QPushButton*> queueButtons;
-    QLabel *movingCarLabel = nullptr;
+    ParkingLot parkingLot;
+    // 停车场由工作线程上的命令队列修改；界面线程读取停车场及其观察者前先锁 lotMutex，
+    // 且不在持锁期间弹出对话框
+    QMutex lotMutex;
+    QThread *lotThread;
+    ParkingService *parkingService = nullptr;
+    ParkingCommandQueue *commandQueue = nullptr;
+    ParkingJournal *journal = nullptr;  // 预写日志与快照，重启后恢复停车场状态
+    QTimer *checkpointTimer;
+    TariffEngine tariffEngine;  // 分时段、按车型、带封顶的计费规则
+    LotAnalytics *analytics = nullptr;  // 增量运营统计
+    StatsPanel *statsPanel = nullptr;
+    DiagnosticsPanel *diagnosticsPanel = nullptr;
+    PlateSearchIndex *searchIndex = nullptr;  // 在场、排队和最近离场车牌的模糊查找
+    StayHistory *history = nullptr;           // 出库车辆的列式历史记录
+    TopologyOccupancy *occupancy = nullptr;   // 各停车场、楼层、区域的空闲车位聚合
+    TopologyPanel *topologyPanel = nullptr;
+
+    // 车位和等待队列都通过模型/虚拟化视图显示，不再为每个格子创建按钮
+    ParkingLotModel *lotModel = nullptr;
+    WaitingQueueModel *queueModel = nullptr;
+    LotView *lotView = nullptr;
+    LotView *queueView = nullptr;
+
+    // 增量刷新：只通知状态变化的车位和队列位置，每帧最多一次
+    QVector<bool> spotDirty;
+    QVector<int> dirtySpots;
+    bool queueDirty = false;
+    QTimer *refreshTimer;
+
+    // 动画与模型解耦：状态立即提交，动画并发播放
+    AnimationScheduler *animationScheduler;
+    QHash<int, int> arrivingCars;  // 车位号 -> 正在入库动画中的车辆数
 
     QPushButton *parkButton;
     QPushButton *releaseButton;
     QPushButton *queryButton;
     QPushButton *aboutButton;
-
-    bool isAnimating; // 用于避免动画冲突
+    QPushButton *settleButton;
+    QPushButton *statsButton;
+    QPushButton *historyButton;
+    QPushButton *diagnosticsButton;
+    QPushButton *topologyButton;
+    QPushButton *exportButton;
+    CommandBar *commandBar;
+    QLineEdit *searchEdit;
+    QListWidget *searchResults;
 
     void setupUI();
-    void updateParkingStatus();
-    void updateQueueStatus();
-    double calculateParkingCost(const QDateTime &entryTime) const;
-    void parkVehicleInSpot(const Vehicle &vehicle, int index);
-    void playVehicleAnimation(QPushButton *targetButton, const QString &vehicleIconPath, bool isEntering);
-    void rearrangeParkingSpots();
-    void clearAnimations();
+    void markSpotDirty(int spot);
+    void markQueueDirty();
+    void refreshDirty();
+    void playVehicleAnimation(int spot, bool isEntering);
+    QString similarPlates(const ParkReply &reply) const;  // 找不到车牌时提示相近的在场车牌
+    QString monthlyVisits(const ParkReply &reply) const;  // 本月到访次数和最近一次离场
+    void showCommandReply(const ParkReply &reply, bool animate);  // 日志、动画和命令栏中的结果
 
 private slots:
     void onParkButtonClicked();
     void onReleaseButtonClicked();
     void onQueryButtonClicked();
     void onAboutButtonClicked();
+    void onSettleButtonClicked();
+    void onStatsButtonClicked();
+    void onHistoryButtonClicked();
+    void onDiagnosticsButtonClicked();
+    void onTopologyButtonClicked();
+    void onExportButtonClicked();
+    void refreshSearchResults();
+    void onSearchResultClicked(QListWidgetItem *item);
+    void onCommandsSubmitted(const QVector<ParkCommand> &commands);
+    void onCommandBatchFinished(quint64 batchId, const QVector<ParkReply> &replies);
+    void onSpotClicked(int spot);
+    void onQueueSlotClicked(int position);
+    void onAnimationFinished(int spot, bool isEntering);
 };
 
 #endif // MAINWINDOW_H
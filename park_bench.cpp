@@ -0,0 +1,514 @@
+// park_bench: 无界面的核心性能基准
+// 在 10 ~ 1,000,000 个车位规模下测量入库、查询、出库和出队的吞吐量与延迟分位数，
+// 并对 ConcurrentParkingEngine 做多线程压力测试，观察随线程数的扩展情况；
+// 闸机事件突发检查每次处理只发出一次 batchApplied，检查失败时以非零状态退出。
+// 用法: park_bench [最大车位数] [最大线程数]
+#include "clock.h"
+#include "lottopology.h"
+#include "lotstatefile.h"
+#include "concurrentparkingengine.h"
+#include "gateeventprocessor.h"
+#include "parkinglot.h"
+#include "parkingspotmanager.h"
+#include "platesearchindex.h"
+#include "queuemanager.h"
+#include "spotallocator.h"
+#include "stayhistory.h"
+#include "tariff.h"
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+volatile int benchSink = 0;  // 防止查询结果被优化掉
+
+struct OpStats {
+    double opsPerSecond = 0;
+    qint64 p50 = 0;
+    qint64 p99 = 0;
+    qint64 p999 = 0;
+    qint64 max = 0;
+};
+
+// 逐次计时执行 count 次 op(i)，返回吞吐量和延迟分位数（纳秒）
+template <typename Op>
+OpStats measure(int count, Op &&op) {
+    std::vector<qint64> samples(count);
+    BenchClock::time_point begin = BenchClock::now();
+    for (int i = 0; i < count; ++i) {
+        BenchClock::time_point t0 = BenchClock::now();
+        op(i);
+        samples[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - t0).count();
+    }
+    double seconds = std::chrono::duration<double>(BenchClock::now() - begin).count();
+
+    OpStats stats;
+    if (count == 0) return stats;
+    std::sort(samples.begin(), samples.end());
+    auto pick = [&](double q) { return samples[std::min<size_t>(samples.size() - 1, size_t(q * samples.size()))]; };
+    stats.opsPerSecond = seconds > 0 ? count / seconds : 0;
+    stats.p50 = pick(0.50);
+    stats.p99 = pick(0.99);
+    stats.p999 = pick(0.999);
+    stats.max = samples.back();
+    return stats;
+}
+
+void report(int spots, const char *op, const OpStats &stats) {
+    std::printf("%10d  %-8s %14.0f %9lld %9lld %9lld %10lld\n", spots, op, stats.opsPerSecond,
+                static_cast<long long>(stats.p50), static_cast<long long>(stats.p99),
+                static_cast<long long>(stats.p999), static_cast<long long>(stats.max));
+}
+
+void benchLot(int spots, std::mt19937 &rng) {
+    // 车辆对象提前构造，避免把字符串格式化和取时间算进被测路径
+    QVector<Vehicle> vehicles;
+    vehicles.reserve(spots);
+    for (int i = 0; i < spots; ++i) {
+        vehicles.append(Vehicle(QString("B%1").arg(i, 7, 10, QChar('0')), Clock::system()->now()));
+    }
+    std::vector<int> order(spots);
+    for (int i = 0; i < spots; ++i) order[i] = i;
+
+    ParkingSpotManager lot(spots);
+    report(spots, "park", measure(spots, [&](int i) { lot.parkVehicle(vehicles[i]); }));
+
+    std::shuffle(order.begin(), order.end(), rng);
+    const PlateKey missing(QString("X0000000"));
+    int found = 0;
+    report(spots, "query", measure(spots, [&](int i) {
+        found += lot.findSpot(i % 8 == 7 ? missing : vehicles[order[i]].getPlateKey()) >= 0;
+    }));
+
+    std::shuffle(order.begin(), order.end(), rng);
+    report(spots, "release", measure(spots, [&](int i) {
+        lot.removeVehicle(vehicles[order[i]].getPlateKey());
+    }));
+
+    QueueManager queue(spots);
+    report(spots, "enqueue", measure(spots, [&](int i) { queue.addVehicleToQueue(vehicles[i]); }));
+    report(spots, "dequeue", measure(spots, [&](int) { queue.dequeueVehicle(); }));
+
+    // 放弃排队：按车牌从队列中间任意位置移除
+    for (int i = 0; i < spots; ++i) queue.addVehicleToQueue(vehicles[i]);
+    std::shuffle(order.begin(), order.end(), rng);
+    report(spots, "cancel", measure(spots, [&](int i) {
+        queue.removeVehicleFromQueue(vehicles[order[i]].getPlateKey());
+    }));
+
+    benchSink = found;
+}
+
+// 每个线程在自己的车牌集合上循环“入库，滞后 window 辆出库”，返回总吞吐量（次/秒）
+double stressEngine(int threads, int spots, int opsPerThread) {
+    const int window = 64;
+    ConcurrentParkingEngine engine(spots, 1024);
+
+    // 线程号和序号都用 36 进制，规范化后仍互不相同且不超过 PlateKey 的长度
+    std::vector<QVector<PlateKey>> plates(threads);
+    for (int t = 0; t < threads; ++t) {
+        plates[t].reserve(opsPerThread);
+        for (int i = 0; i < opsPerThread; ++i) {
+            plates[t].append(PlateKey(QString("T%1X%2").arg(t, 0, 36).arg(i, 0, 36)));
+        }
+    }
+
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            const QVector<PlateKey> &own = plates[t];
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < opsPerThread; ++i) {
+                engine.parkOrEnqueue(own[i]);
+                if (i >= window) {
+                    if (!engine.releaseVehicle(own[i - window]).released) {
+                        engine.cancelQueuedVehicle(own[i - window]);
+                    }
+                }
+            }
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+
+    BenchClock::time_point begin = BenchClock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(BenchClock::now() - begin).count();
+
+    // 每次循环约一次入库加一次出库
+    return seconds > 0 ? 2.0 * threads * opsPerThread / seconds : 0;
+}
+
+// 对 spots 辆随机入场时间、随机车型的车辆做批量结算，返回每轮平均耗时（毫秒）
+double benchSettlement(int spots, std::mt19937 &rng) {
+    TariffEngine engine;
+    const qint64 now = 1717200000000LL;
+    std::uniform_int_distribution<qint64> stay(0, 3LL * 24 * 3600 * 1000);
+    std::uniform_int_distribution<int> vehicleClass(0, kVehicleClassCount - 1);
+    std::vector<qint64> entries(spots);
+    std::vector<quint8> classes(spots);
+    std::vector<qint64> cents(spots);
+    for (int i = 0; i < spots; ++i) {
+        entries[i] = now - stay(rng);
+        classes[i] = quint8(vehicleClass(rng));
+    }
+
+    const int rounds = 20;
+    BenchClock::time_point begin = BenchClock::now();
+    for (int round = 0; round < rounds; ++round) {
+        engine.settle(entries.data(), classes.data(), spots, now + round * 60000, cents.data());
+        benchSink = benchSink + int(cents[round % spots]);
+    }
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - begin).count() / rounds;
+}
+
+// 8 个区域、含小型/大型车位和保留车位的布局先停到 90%，再测量“出库一辆、入库一辆”的混合车型周转
+void benchAllocation(int spots, const QString &policyName, std::mt19937 &rng) {
+    ParkingSpotManager lot(SpotLayout::generate(spots, 8, 20, 5, 4, 4));
+    lot.setAllocationPolicy(spotAllocationPolicy(policyName));
+
+    const int churn = qMin(spots, 200000);
+    std::uniform_int_distribution<int> pickClass(0, 99);
+    QVector<Vehicle> vehicles;
+    vehicles.reserve(spots + churn);
+    for (int i = 0; i < spots + churn; ++i) {
+        int roll = pickClass(rng);
+        VehicleClass vehicleClass = roll < 20 ? VehicleClass::Compact : roll < 95 ? VehicleClass::Standard : VehicleClass::Oversize;
+        PriorityClass priorityClass = roll % 25 == 0 ? PriorityClass::Disabled : roll % 25 == 1 ? PriorityClass::Electric
+                                                                                                 : PriorityClass::Regular;
+        vehicles.append(Vehicle(QString("A%1").arg(i, 7, 10, QChar('0')), 0, vehicleClass, priorityClass));
+    }
+
+    QVector<int> parked;  // vehicles 中的下标
+    parked.reserve(spots);
+    for (int i = 0; i < spots && parked.size() < spots * 9 / 10; ++i) {
+        if (lot.parkVehicle(vehicles[i]) >= 0) parked.append(i);
+    }
+
+    std::uniform_int_distribution<int> pickParked(0, parked.size() - 1);
+    int next = spots;
+    QByteArray name = policyName.toLatin1();
+    report(spots, name.constData(), measure(churn, [&](int) {
+        int victim = pickParked(rng);
+        lot.removeVehicle(vehicles[parked[victim]].getPlateKey());
+        int arriving = next++;
+        // 没有合适的空车位时原车停回去，保持占用率不变
+        if (lot.parkVehicle(vehicles[arriving]) >= 0) parked[victim] = arriving;
+        else lot.parkVehicle(vehicles[parked[victim]]);
+    }));
+}
+
+// 4 个停车场 × 5 层 × 4 个区域的站点，在楼层均衡策略下测量入库、出库，以及楼层余位和最空楼层查询
+void benchTopology(int spots, std::mt19937 &rng) {
+    const int zoneSpots = qMax(1, spots / 80);
+    QStringList lots;
+    for (int lot = 0; lot < 4; ++lot) {
+        QStringList levels;
+        for (int level = 0; level < 5; ++level) levels.append(QString("%1+%1+%1+%1").arg(zoneSpots));
+        lots.append(QString("L%1=%2").arg(lot).arg(levels.join(',')));
+    }
+    LotTopology topology;
+    LotTopology::parse(lots.join(';'), &topology);
+    spots = topology.getTotalSpots();
+
+    SpotLayout layout = SpotLayout::uniform(spots);
+    layout.zoneStarts = topology.zoneStarts();
+    ParkingLot lot(layout, 1);
+    TopologyOccupancy occupancy(topology, &lot);
+    lot.addObserver(&occupancy);
+    lot.setAllocationPolicy(std::make_shared<LevelBalancingPolicy>(&occupancy));
+
+    QVector<Vehicle> vehicles;
+    vehicles.reserve(spots);
+    for (int i = 0; i < spots; ++i) vehicles.append(Vehicle(QString("T%1").arg(i, 7, 10, QChar('0')), 0));
+    std::vector<int> order(spots);
+    for (int i = 0; i < spots; ++i) order[i] = i;
+
+    report(spots, "park", measure(spots * 9 / 10, [&](int i) { lot.parkOrEnqueue(vehicles[i]); }));
+    const QVector<int> &levels = topology.getLevels();
+    std::uniform_int_distribution<int> pickLevel(0, levels.size() - 1);
+    int found = 0;
+    report(spots, "level", measure(100000, [&](int) { found += occupancy.freeCount(levels[pickLevel(rng)]); }));
+    report(spots, "emptiest", measure(100000, [&](int) { found += occupancy.emptiestLevel(); }));
+    std::shuffle(order.begin(), order.begin() + spots * 9 / 10, rng);
+    report(spots, "release", measure(spots * 9 / 10, [&](int i) { lot.releaseVehicle(vehicles[order[i]].getPlateKey()); }));
+    lot.removeObserver(&occupancy);
+    benchSink = found;
+}
+
+// 在 plates 辆随机车牌的在场车辆上测量前缀、子串和编辑距离 1 的车牌查找
+void benchSearch(int plates, std::mt19937 &rng) {
+    const QString provinces("京沪粤苏浙川鲁豫");
+    const QString letters("ABCDEFGHJKLMNPQRSTUVWXYZ");
+    const QString alphabet = letters + "0123456789";
+    std::uniform_int_distribution<int> pickProvince(0, provinces.size() - 1);
+    std::uniform_int_distribution<int> pickLetter(0, letters.size() - 1);
+    std::uniform_int_distribution<int> pickChar(0, alphabet.size() - 1);
+
+    ParkingLot lot(plates, 1);
+    PlateSearchIndex index(&lot);
+    lot.addObserver(&index);
+    QVector<PlateKey> parked;
+    parked.reserve(plates);
+    while (parked.size() < plates) {
+        QString plate = QString(provinces[pickProvince(rng)]) + letters[pickLetter(rng)];
+        for (int i = 0; i < 5; ++i) plate += alphabet[pickChar(rng)];
+        Vehicle vehicle(plate, Clock::system()->now());
+        if (lot.parkOrEnqueue(vehicle).status == ParkingLot::ParkStatus::Parked) {
+            parked.append(vehicle.getPlateKey());
+        }
+    }
+
+    // 查询串提前生成：车牌前 4 位、中间 4 位、以及任意一位被改错的整牌
+    const int queries = 10000;
+    std::uniform_int_distribution<int> pickPlate(0, plates - 1);
+    QVector<QString> prefixes, substrings, typos;
+    for (int i = 0; i < queries; ++i) {
+        QString plate = parked[pickPlate(rng)].toString();
+        prefixes.append(plate.left(4));
+        substrings.append(plate.mid(2, 4));
+        plate[2 + i % 5] = alphabet[pickChar(rng)];
+        typos.append(plate);
+    }
+
+    int found = 0;
+    report(plates, "prefix", measure(queries, [&](int i) { found += index.search(prefixes[i]).size(); }));
+    report(plates, "substr", measure(queries, [&](int i) { found += index.search(substrings[i]).size(); }));
+    report(plates, "fuzzy", measure(queries, [&](int i) { found += index.search(typos[i]).size(); }));
+    benchSink = found;
+}
+
+// 向临时目录追加 stays 条出库记录（每 30 秒一条，平均每个车牌到访 20 次），
+// 测量追加吞吐量、磁盘占用，以及按车牌、按两小时时段和按日营收的查询延迟
+void benchHistory(int stays, std::mt19937 &rng) {
+    QTemporaryDir dir;
+    if (!dir.isValid()) return;
+    TariffEngine tariff;
+    StayHistory history(dir.path(), &tariff);
+
+    const int plates = qMax(1, stays / 20);
+    QVector<PlateKey> keys;
+    keys.reserve(plates);
+    for (int i = 0; i < plates; ++i) keys.append(PlateKey(QString("H%1").arg(i, 6, 36, QChar('0'))));
+    std::uniform_int_distribution<int> pickPlate(0, plates - 1);
+    std::uniform_int_distribution<qint64> dwell(5LL * 60 * 1000, 8LL * 3600 * 1000);
+    const qint64 start = 1717200000000LL;
+    const qint64 step = 30 * 1000;
+
+    BenchClock::time_point begin = BenchClock::now();
+    for (int i = 0; i < stays; ++i) {
+        qint64 exit = start + i * step;
+        history.append({keys[pickPlate(rng)], i % 1000, exit - dwell(rng), exit, i % 5000, VehicleClass::Standard});
+    }
+    double seconds = std::chrono::duration<double>(BenchClock::now() - begin).count();
+    std::printf("%10d stays: append %.0f/s, %.1f bytes/stay on disk, %d segments\n", stays,
+                seconds > 0 ? stays / seconds : 0, double(history.diskBytes()) / stays, history.segmentCount());
+
+    const qint64 end = start + stays * step;
+    std::uniform_int_distribution<qint64> pickTime(start, end);
+    int found = 0;
+    report(stays, "plate", measure(1000, [&](int) {
+        found += history.staysOf(keys[pickPlate(rng)], start, end + 1).size();
+    }));
+    report(stays, "range", measure(1000, [&](int) {
+        qint64 from = pickTime(rng);
+        found += history.staysBetween(from, from + 2 * 3600 * 1000).size();
+    }));
+    report(stays, "daily", measure(20, [&](int) { found += history.revenueByDay(start, end + 1, 480).size(); }));
+    benchSink = found;
+}
+
+// 导出并重新导入 vehicles 辆在场车辆和 1000 辆排队车辆，分别测 CSV 和二进制格式
+void benchStateFile(int vehicles, std::mt19937 &rng) {
+    const int queued = 1000;
+    ParkingLot lot(vehicles, queued);
+    std::uniform_int_distribution<qint64> stay(0, 3LL * 24 * 3600 * 1000);
+    std::uniform_int_distribution<int> vehicleClass(0, kVehicleClassCount - 1);
+    const qint64 now = 1717200000000LL;
+    for (int i = 0; i < vehicles + queued; ++i) {
+        Vehicle vehicle(QString("S%1").arg(i, 7, 10, QChar('0')), now - stay(rng), VehicleClass(vehicleClass(rng)));
+        if (i < vehicles) lot.restoreParked(vehicle, i);
+        else lot.restoreQueued(vehicle);
+    }
+
+    QTemporaryDir dir;
+    for (const char *suffix : {"csv", "bin"}) {
+        QString path = dir.filePath(QString("state.%1").arg(suffix));
+        BenchClock::time_point begin = BenchClock::now();
+        bool exported = LotStateFile::exportFile(lot, path);
+        double exportMs = std::chrono::duration<double, std::milli>(BenchClock::now() - begin).count();
+
+        ParkingLot imported(1, 1);
+        begin = BenchClock::now();
+        bool ok = exported && LotStateFile::importFile(path, &imported);
+        double importMs = std::chrono::duration<double, std::milli>(BenchClock::now() - begin).count();
+        benchSink = benchSink + imported.getQueueManager().getQueueLength();
+        std::printf("%10d  %-8s %12.1f %12.1f %10.1f%s\n", vehicles, suffix, exportMs, importMs,
+                    QFileInfo(path).size() / 1048576.0, ok ? "" : "  (failed)");
+    }
+}
+
+// 多个闸机线程同时推入一轮事件（先全部进场，再全部出场），生产者结束后才处理事件循环，
+// 所以每轮只应投递一次处理请求、发出一次 batchApplied，且汇总包含全部事件。返回检查是否通过
+bool benchGateBurst(int threads, int eventsPerThread) {
+    const int total = threads * eventsPerThread;
+    ParkingLot lot(total, 16);
+    GateEventProcessor processor(&lot, total);
+
+    int batches = 0;
+    GateBatchSummary last;
+    QObject::connect(&processor, &GateEventProcessor::batchApplied, [&](const GateBatchSummary &summary) {
+        ++batches;
+        last = summary;
+    });
+
+    bool ok = true;
+    for (GateEventType type : {GateEventType::Enter, GateEventType::Exit}) {
+        batches = 0;
+        last = GateBatchSummary();
+        std::vector<std::thread> producers;
+        BenchClock::time_point begin = BenchClock::now();
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&, t]() {
+                GateEvent event;
+                event.type = type;
+                event.gate = t;
+                for (int i = 0; i < eventsPerThread; ++i) {
+                    event.licensePlate = QString("G%1X%2").arg(t, 0, 36).arg(i, 0, 36);
+                    while (!processor.submit(event)) std::this_thread::yield();
+                }
+            });
+        }
+        for (std::thread &producer : producers) producer.join();
+        double pushSeconds = std::chrono::duration<double>(BenchClock::now() - begin).count();
+
+        begin = BenchClock::now();
+        QElapsedTimer timeout;
+        timeout.start();
+        while (batches == 0 && timeout.elapsed() < 10000) {
+            QCoreApplication::processEvents();
+        }
+        QCoreApplication::processEvents();  // 多余的处理请求会在这里发出第二个 batchApplied
+        double drainMs = std::chrono::duration<double, std::milli>(BenchClock::now() - begin).count();
+
+        int expected = type == GateEventType::Enter ? last.parked : last.released;
+        bool passed = batches == 1 && last.applied == total && expected == total && last.rejected == 0;
+        ok = ok && passed;
+        std::printf("%8d  %-6s %14.0f %10.1f %8d %9d%s
+", threads, type == GateEventType::Enter ? "enter" : "exit",
+                    pushSeconds > 0 ? total / pushSeconds : 0, drainMs, batches, last.applied,
+                    passed ? "" : "  (FAILED)");
+    }
+    return ok;
+}
+
+// 不同计时模式下一次空作用域计时的开销（纳秒）
+double benchTraceOverhead(TraceMode mode) {
+    const int iterations = 10000000;
+    Tracer::setMode(mode);
+    BenchClock::time_point begin = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) {
+        PARK_TRACE_SCOPE(Park);
+        benchSink = benchSink + 1;
+    }
+    double nanoseconds = std::chrono::duration<double, std::nano>(BenchClock::now() - begin).count();
+    Tracer::setMode(TraceMode::Off);
+    Tracer::reset();
+    return nanoseconds / iterations;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);  // 闸机事件处理器通过事件循环投递处理请求
+    int maxSpots = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    if (maxSpots < 10) maxSpots = 10;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : int(std::thread::hardware_concurrency());
+    if (maxThreads < 1) maxThreads = 1;
+
+    std::mt19937 rng(20240601);
+    std::printf("%10s  %-8s %14s %9s %9s %9s %10s\n", "spots", "op", "ops/s", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+    for (int spots = 10; spots <= maxSpots; spots *= 10) {
+        benchLot(spots, rng);
+    }
+
+    std::printf("\nspot allocation churn (8 zones, mixed sizes and reserved bays, 90%% full)\n");
+    std::printf("%10s  %-8s %14s %9s %9s %9s %10s\n", "spots", "policy", "ops/s", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+    for (int spots = 1000; spots <= qMax(1000, maxSpots); spots *= 10) {
+        benchAllocation(spots, "nearest", rng);
+        benchAllocation(spots, "balance", rng);
+    }
+
+    std::printf("\nsite topology (4 lots x 5 levels x 4 zones, level balancing)\n");
+    std::printf("%10s  %-8s %14s %9s %9s %9s %10s\n", "spots", "op", "ops/s", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+    for (int spots = 1000; spots <= qMax(1000, maxSpots); spots *= 10) {
+        benchTopology(spots, rng);
+    }
+
+    std::printf("\nbatch tariff settlement\n");
+    std::printf("%10s %12s\n", "vehicles", "ms/pass");
+    for (int spots = 1000; spots <= qMax(1000, maxSpots); spots *= 10) {
+        std::printf("%10d %12.3f\n", spots, benchSettlement(spots, rng));
+    }
+
+    int searchPlates = qMin(100000, maxSpots);
+    std::printf("\nplate search (%d plates, top 20)\n", searchPlates);
+    std::printf("%10s  %-8s %14s %9s %9s %9s %10s\n", "plates", "op", "ops/s", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+    benchSearch(searchPlates, rng);
+
+    std::printf("\nstay history\n");
+    std::printf("%10s  %-8s %14s %9s %9s %9s %10s\n", "stays", "op", "ops/s", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)");
+    benchHistory(qMin(1000000, maxSpots), rng);
+
+    std::printf("\nlot state export/import (parked + 1000 queued)\n");
+    std::printf("%10s  %-8s %12s %12s %10s\n", "vehicles", "format", "export(ms)", "import(ms)", "size(MiB)");
+    for (int vehicles = 1000; vehicles <= qMax(1000, maxSpots); vehicles *= 10) {
+        benchStateFile(vehicles, rng);
+    }
+
+    std::printf("\ntrace scope overhead (ns/scope)\n");
+    std::printf("%10s %10s %10s\n", "off", "histogram", "timeline");
+    double traceOff = benchTraceOverhead(TraceMode::Off);
+    double traceHistogram = benchTraceOverhead(TraceMode::Histogram);
+    double traceTimeline = benchTraceOverhead(TraceMode::Timeline);
+    std::printf("%10.2f %10.2f %10.2f\n", traceOff, traceHistogram, traceTimeline);
+
+    std::printf("\nconcurrent engine stress (100000 spots, 200000 park+release per thread)\n");
+    std::printf("%8s %14s %9s\n", "threads", "ops/s", "speedup");
+    double baseline = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double opsPerSecond = stressEngine(threads, 100000, 200000);
+        if (threads == 1) baseline = opsPerSecond;
+        std::printf("%8d %14.0f %9.2f\n", threads, opsPerSecond, baseline > 0 ? opsPerSecond / baseline : 0);
+    }
+
+    std::printf("\ngate event burst (65536 events per round, one batchApplied per drain)\n");
+    std::printf("%8s  %-6s %14s %10s %8s %9s\n", "threads", "event", "push/s", "drain(ms)", "batches", "applied");
+    bool gateOk = true;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        gateOk = benchGateBurst(threads, 65536 / threads) && gateOk;
+    }
+    return gateOk ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// park_load: 无界面服务的压测客户端
+// 每个连接一个线程，按流水线深度连续发送 ParkProtocol 请求，统计整体吞吐量和逐请求的往返延迟分位数。
+// 默认负载为同一车牌先入库再出库的循环，在库车辆数不超过“连接数 × 流水线深度”，不会把停车场停满。
+// 用法示例: park --headless --spots 10000 &
+//           park_load --connections 8 --pipeline 32 --requests 200000
+//           park_load --tcp 7878 --mode query
+#include "parkprotocol.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QLocalSocket>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using LoadClock = std::chrono::steady_clock;
+
+enum class LoadMode { Cycle, Query, About };
+
+struct LoadConfig {
+    QString localName = "park";
+    int tcpPort = 0;               // 非 0 时改用 TCP
+    int connections = 4;
+    int pipeline = 16;
+    int requests = 100000;         // 每个连接
+    LoadMode mode = LoadMode::Cycle;
+};
+
+const int kStatusCount = int(ParkReplyStatus::Failed) + 1;
+
+struct ConnectionResult {
+    std::vector<qint64> latencies;  // 纳秒
+    qint64 statusCounts[kStatusCount] = {};
+    QString error;
+};
+
+// 车牌为 "L" + 2 位连接号 + 5 位序号，出库后序号才会被重用
+QByteArray plateFor(int connection, int index) {
+    return QString("L%1%2").arg(connection % 100, 2, 10, QChar('0')).arg(index % 100000, 5, 10, QChar('0')).toUtf8();
+}
+
+void appendCommand(QByteArray &out, const LoadConfig &config, int connection, int sequence) {
+    switch (config.mode) {
+    case LoadMode::Cycle:
+        ParkProtocol::appendRequest(out, quint32(sequence),
+                                    sequence % 2 == 0 ? ParkCommandType::Park : ParkCommandType::Release,
+                                    plateFor(connection, sequence / 2));
+        break;
+    case LoadMode::Query:
+        ParkProtocol::appendRequest(out, quint32(sequence), ParkCommandType::Query, plateFor(connection, sequence));
+        break;
+    case LoadMode::About:
+        ParkProtocol::appendRequest(out, quint32(sequence), ParkCommandType::About, QByteArray());
+        break;
+    }
+}
+
+void runConnection(const LoadConfig &config, int connection, ConnectionResult *result) {
+    // 套接字在本线程创建，用阻塞式的 waitFor* 接口，不需要事件循环
+    std::unique_ptr<QTcpSocket> tcp;
+    std::unique_ptr<QLocalSocket> local;
+    QIODevice *socket;
+    if (config.tcpPort > 0) {
+        tcp.reset(new QTcpSocket);
+        tcp->connectToHost(QHostAddress::LocalHost, quint16(config.tcpPort));
+        if (!tcp->waitForConnected(3000)) {
+            result->error = tcp->errorString();
+            return;
+        }
+        tcp->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        socket = tcp.get();
+    } else {
+        local.reset(new QLocalSocket);
+        local->connectToServer(config.localName);
+        if (!local->waitForConnected(3000)) {
+            result->error = local->errorString();
+            return;
+        }
+        socket = local.get();
+    }
+    auto flush = [&]() { return tcp ? tcp->flush() : local->flush(); };
+    auto waitForReadyRead = [&]() { return tcp ? tcp->waitForReadyRead(5000) : local->waitForReadyRead(5000); };
+
+    const int total = config.requests;
+    std::vector<LoadClock::time_point> sentAt(total);
+    result->latencies.reserve(total);
+    QByteArray out;
+    QByteArray in;
+    int sent = 0;
+    int received = 0;
+    while (received < total) {
+        out.clear();
+        while (sent < total && sent - received < config.pipeline) {
+            appendCommand(out, config, connection, sent);
+            sentAt[sent++] = LoadClock::now();
+        }
+        if (!out.isEmpty()) {
+            socket->write(out);
+            flush();
+        }
+
+        if (!waitForReadyRead()) {
+            result->error = QString("等待应答超时：%1").arg(socket->errorString());
+            return;
+        }
+        in.append(socket->readAll());
+        LoadClock::time_point now = LoadClock::now();
+
+        int offset = 0;
+        const char *payload;
+        int length;
+        ParkProtocol::FrameResult frame;
+        while ((frame = ParkProtocol::readFrame(in, &offset, &payload, &length)) == ParkProtocol::FrameResult::Complete) {
+            quint32 requestId;
+            ParkReply reply;
+            // 超出范围的状态也按无法解析处理，不能混进某个已知状态的计数
+            if (!ParkProtocol::decodeReply(payload, length, &requestId, &reply) || requestId >= quint32(sent)
+                || int(reply.status) >= kStatusCount) {
+                result->error = "无法解析的应答";
+                return;
+            }
+            result->latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sentAt[requestId]).count());
+            ++result->statusCounts[int(reply.status)];
+            ++received;
+        }
+        if (frame == ParkProtocol::FrameResult::Invalid) {
+            result->error = "应答帧长度无效";
+            return;
+        }
+        in.remove(0, offset);
+    }
+}
+
+const char *statusName(ParkReplyStatus status) {
+    switch (status) {
+    case ParkReplyStatus::Ok: return "ok";
+    case ParkReplyStatus::Queued: return "queued";
+    case ParkReplyStatus::Duplicate: return "duplicate";
+    case ParkReplyStatus::QueueFull: return "queue-full";
+    case ParkReplyStatus::InvalidPlate: return "invalid-plate";
+    case ParkReplyStatus::NoSuitableSpot: return "no-spot";
+    case ParkReplyStatus::NotFound: return "not-found";
+    case ParkReplyStatus::BadRequest: return "bad-request";
+    case ParkReplyStatus::StorageError: return "storage-error";
+    case ParkReplyStatus::Failed: return "failed";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("park_load");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("无界面停车场服务压测");
+    parser.addHelpOption();
+    QCommandLineOption localOption("local", "本地套接字名", "name", "park");
+    QCommandLineOption tcpOption("tcp", "改用 127.0.0.1 上的 TCP 端口", "port");
+    QCommandLineOption connectionsOption("connections", "并发连接数（每个连接一个线程）", "n", "4");
+    QCommandLineOption pipelineOption("pipeline", "每个连接未收到应答的最大请求数", "n", "16");
+    QCommandLineOption requestsOption("requests", "每个连接发送的请求数", "n", "100000");
+    QCommandLineOption modeOption("mode", "负载：cycle（入库/出库交替）| query | about", "mode", "cycle");
+    parser.addOptions({localOption, tcpOption, connectionsOption, pipelineOption, requestsOption, modeOption});
+    parser.process(app);
+
+    LoadConfig config;
+    config.localName = parser.value(localOption);
+    config.tcpPort = parser.value(tcpOption).toInt();
+    config.connections = qBound(1, parser.value(connectionsOption).toInt(), 99);
+    config.pipeline = qMax(1, parser.value(pipelineOption).toInt());
+    config.requests = qMax(1, parser.value(requestsOption).toInt());
+    QString mode = parser.value(modeOption);
+    if (mode == "cycle") config.mode = LoadMode::Cycle;
+    else if (mode == "query") config.mode = LoadMode::Query;
+    else if (mode == "about") config.mode = LoadMode::About;
+    else {
+        std::fprintf(stderr, "未知的负载类型: %s\n", qPrintable(mode));
+        return 1;
+    }
+
+    std::vector<ConnectionResult> results(config.connections);
+    std::vector<std::thread> threads;
+    LoadClock::time_point begin = LoadClock::now();
+    for (int i = 0; i < config.connections; ++i) {
+        threads.emplace_back(runConnection, std::cref(config), i, &results[i]);
+    }
+    for (std::thread &thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(LoadClock::now() - begin).count();
+
+    std::vector<qint64> latencies;
+    qint64 statusCounts[kStatusCount] = {};
+    for (int i = 0; i < config.connections; ++i) {
+        if (!results[i].error.isEmpty()) {
+            std::fprintf(stderr, "连接 %d: %s\n", i, qPrintable(results[i].error));
+        }
+        latencies.insert(latencies.end(), results[i].latencies.begin(), results[i].latencies.end());
+        for (int s = 0; s < kStatusCount; ++s) statusCounts[s] += results[i].statusCounts[s];
+    }
+    if (latencies.empty()) return 1;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, size_t(p * latencies.size()))] / 1000.0; };
+    std::printf("%d connections x %d requests, pipeline %d, %s\n", config.connections, config.requests, config.pipeline,
+                config.tcpPort > 0 ? qPrintable(QString("tcp:%1").arg(config.tcpPort)) : qPrintable(config.localName));
+    std::printf("%12s %14s %10s %10s %10s %10s\n", "replies", "req/s", "p50(us)", "p99(us)", "p99.9(us)", "max(us)");
+    std::printf("%12zu %14.0f %10.1f %10.1f %10.1f %10.1f\n", latencies.size(), latencies.size() / seconds,
+                percentile(0.5), percentile(0.99), percentile(0.999), latencies.back() / 1000.0);
+    for (int s = 0; s < kStatusCount; ++s) {
+        if (statusCounts[s] > 0) std::printf("  %-14s %lld\n", statusName(ParkReplyStatus(s)), statusCounts[s]);
+    }
+    return 0;
+}
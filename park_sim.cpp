@@ -0,0 +1,350 @@
+// park_sim: 无界面的离散事件仿真
+// 用泊松到达或记录的到达轨迹驱动 ParkingLot 的入库/排队/出库/放行逻辑，时间由 ManualClock 推进，
+// 输出排队等待时间分位数、拒绝率（等待队列已满）、放弃排队比例和占用率曲线，用于容量规划和整体性能基准。
+// 用法示例: park_sim --spots 200 --queue 20 --rate 90 --dwell lognormal:150,0.8 --hours 72
+#include "clock.h"
+#include "parkinglot.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace {
+
+const qint64 kMSecsPerMinute = 60 * 1000;
+
+enum class SimEventType : quint8 { Arrival, Departure, Abandon, Sample };
+
+struct SimEvent {
+    qint64 time;
+    quint64 sequence;   // 同一时刻的事件按产生顺序处理，保证结果可复现
+    SimEventType type;
+    int vehicle;
+
+    bool operator>(const SimEvent &other) const {
+        return time != other.time ? time > other.time : sequence > other.sequence;
+    }
+};
+
+// 停留时长分布，单位分钟: exp:均值 / lognormal:均值,sigma / uniform:最小,最大 / fixed:时长
+struct DwellDistribution {
+    enum Kind { Exponential, LogNormal, Uniform, Fixed } kind = Exponential;
+    double a = 120;
+    double b = 0;
+
+    static bool parse(const QString &spec, DwellDistribution *out) {
+        QStringList parts = spec.split(':');
+        QStringList args = parts.value(1).split(',');
+        bool ok = parts.size() == 2;
+        double a = ok ? args.value(0).toDouble(&ok) : 0;
+        double b = 0;
+        if (ok && args.size() > 1) b = args.value(1).toDouble(&ok);
+        if (!ok || a <= 0) return false;
+
+        QString kind = parts.value(0);
+        if (kind == "exp") out->kind = Exponential;
+        else if (kind == "lognormal") out->kind = LogNormal;
+        else if (kind == "uniform") out->kind = Uniform;
+        else if (kind == "fixed") out->kind = Fixed;
+        else return false;
+        if ((out->kind == LogNormal && b <= 0) || (out->kind == Uniform && b < a)) return false;
+        out->a = a;
+        out->b = b;
+        return true;
+    }
+
+    qint64 sample(std::mt19937_64 &rng) const {
+        double minutes = a;
+        switch (kind) {
+        case Exponential:
+            minutes = std::exponential_distribution<double>(1.0 / a)(rng);
+            break;
+        case LogNormal:
+            // 按均值和形状参数换算 mu，使分布均值等于 a
+            minutes = std::lognormal_distribution<double>(std::log(a) - b * b / 2, b)(rng);
+            break;
+        case Uniform:
+            minutes = std::uniform_real_distribution<double>(a, b)(rng);
+            break;
+        case Fixed:
+            break;
+        }
+        return qMax<qint64>(1000, qint64(minutes * kMSecsPerMinute));
+    }
+};
+
+struct SimConfig {
+    int spots = 100;
+    int queueCapacity = 20;
+    double arrivalsPerHour = 60;
+    DwellDistribution dwell;
+    qint64 patience = 0;            // 排队超过该时长放弃，0 表示一直等待
+    qint64 duration = 24 * 60 * kMSecsPerMinute;
+    qint64 sampleInterval = 60 * kMSecsPerMinute;
+    quint64 seed = 1;
+    QString traceFile;
+};
+
+struct SimResult {
+    qint64 events = 0;
+    qint64 arrivals = 0;
+    qint64 parkedDirectly = 0;
+    qint64 queued = 0;
+    qint64 rejected = 0;
+    qint64 abandoned = 0;
+    qint64 departures = 0;
+    std::vector<qint64> waits;      // 从排队到入库的等待时长（毫秒）
+    std::vector<double> curveTime;  // 占用率曲线，单位小时
+    std::vector<int> curveParked;
+    std::vector<int> curveQueued;
+    double wallSeconds = 0;
+};
+
+class Simulation {
+public:
+    explicit Simulation(const SimConfig &config)
+        : config(config), clock(0), lot(config.spots, config.queueCapacity, &clock), rng(config.seed) {}
+
+    bool loadTrace(QString *error) {
+        // 轨迹文件每行 "到达秒数,停留秒数"，# 开头的行为注释
+        QFile file(config.traceFile);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            *error = QString("无法打开轨迹文件: %1").arg(config.traceFile);
+            return false;
+        }
+        QTextStream in(&file);
+        int lineNumber = 0;
+        while (!in.atEnd()) {
+            QString line = in.readLine().trimmed();
+            ++lineNumber;
+            if (line.isEmpty() || line.startsWith('#')) continue;
+            QStringList fields = line.split(',');
+            bool arrivalOk = false, dwellOk = false;
+            double arrival = fields.value(0).toDouble(&arrivalOk);
+            double dwell = fields.value(1).toDouble(&dwellOk);
+            if (!arrivalOk || !dwellOk || arrival < 0 || dwell <= 0) {
+                *error = QString("轨迹文件第 %1 行格式错误: %2").arg(lineNumber).arg(line);
+                return false;
+            }
+            int vehicle = newVehicle(qint64(dwell * 1000));
+            schedule(qint64(arrival * 1000), SimEventType::Arrival, vehicle);
+        }
+        return true;
+    }
+
+    SimResult run() {
+        if (config.traceFile.isEmpty()) {
+            scheduleNextArrival(0);
+        }
+        for (qint64 t = 0; t <= config.duration; t += config.sampleInterval) {
+            schedule(t, SimEventType::Sample, -1);
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        while (!events.empty()) {
+            SimEvent event = events.top();
+            if (event.time > config.duration) break;
+            events.pop();
+            clock.setTime(event.time);
+            ++result.events;
+            handle(event);
+        }
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return std::move(result);
+    }
+
+private:
+    int newVehicle(qint64 dwell) {
+        dwells.push_back(dwell);
+        queuedAt.push_back(-1);
+        return int(dwells.size()) - 1;
+    }
+
+    // 车辆编号按 36 进制编进车牌，8 个字符以内可容纳数百亿辆车
+    static PlateKey plateOf(int vehicle) {
+        return PlateKey(QStringLiteral("S") + QString::number(vehicle, 36));
+    }
+
+    static int vehicleOf(const PlateKey &plate) {
+        return plate.toString().mid(1).toInt(nullptr, 36);
+    }
+
+    void schedule(qint64 time, SimEventType type, int vehicle) {
+        events.push(SimEvent{time, nextSequence++, type, vehicle});
+    }
+
+    void scheduleNextArrival(qint64 now) {
+        if (config.arrivalsPerHour <= 0) return;
+        double meanGap = 60.0 * kMSecsPerMinute / config.arrivalsPerHour;
+        qint64 gap = qint64(std::exponential_distribution<double>(1.0 / meanGap)(rng));
+        schedule(now + gap, SimEventType::Arrival, newVehicle(config.dwell.sample(rng)));
+    }
+
+    void handle(const SimEvent &event) {
+        switch (event.type) {
+        case SimEventType::Arrival:
+            arrive(event);
+            break;
+        case SimEventType::Departure:
+            lot.releaseVehicle(plateOf(event.vehicle));
+            ++result.departures;
+            promote(event.time);
+            break;
+        case SimEventType::Abandon:
+            if (queuedAt[event.vehicle] >= 0 && lot.cancelQueuedVehicle(plateOf(event.vehicle))) {
+                queuedAt[event.vehicle] = -1;
+                ++result.abandoned;
+            }
+            break;
+        case SimEventType::Sample:
+            result.curveTime.push_back(double(event.time) / (60.0 * kMSecsPerMinute));
+            result.curveParked.push_back(lot.getSpotManager().getParkedCount());
+            result.curveQueued.push_back(lot.getQueueManager().getQueueLength());
+            break;
+        }
+    }
+
+    void arrive(const SimEvent &event) {
+        ++result.arrivals;
+        if (config.traceFile.isEmpty()) {
+            scheduleNextArrival(event.time);
+        }
+
+        ParkingLot::ParkResult park = lot.parkOrEnqueue(Vehicle(plateOf(event.vehicle), event.time));
+        switch (park.status) {
+        case ParkingLot::ParkStatus::Parked:
+            ++result.parkedDirectly;
+            schedule(event.time + dwells[event.vehicle], SimEventType::Departure, event.vehicle);
+            break;
+        case ParkingLot::ParkStatus::Queued:
+            ++result.queued;
+            queuedAt[event.vehicle] = event.time;
+            if (config.patience > 0) {
+                schedule(event.time + config.patience, SimEventType::Abandon, event.vehicle);
+            }
+            break;
+        case ParkingLot::ParkStatus::QueueFull:
+        case ParkingLot::ParkStatus::Duplicate:
+        case ParkingLot::ParkStatus::InvalidPlate:
+        case ParkingLot::ParkStatus::NoSuitableSpot:
+            ++result.rejected;
+            break;
+        }
+    }
+
+    void promote(qint64 now) {
+        ParkingLot::SpotResult promoted = lot.promoteNextVehicle();
+        if (promoted.spot < 0) return;
+        int vehicle = vehicleOf(promoted.vehicle.getPlateKey());
+        result.waits.push_back(now - queuedAt[vehicle]);
+        queuedAt[vehicle] = -1;
+        schedule(now + dwells[vehicle], SimEventType::Departure, vehicle);
+    }
+
+    SimConfig config;
+    ManualClock clock;
+    ParkingLot lot;
+    std::mt19937_64 rng;
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events;
+    quint64 nextSequence = 0;
+    std::vector<qint64> dwells;     // 每辆车的停留时长，到达时确定
+    std::vector<qint64> queuedAt;   // 进入队列的时刻，不在队列中为 -1
+    SimResult result;
+};
+
+double percentile(const std::vector<qint64> &sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t index = std::min(sorted.size() - 1, size_t(q * sorted.size()));
+    return double(sorted[index]) / kMSecsPerMinute;
+}
+
+void printReport(const SimConfig &config, SimResult &result) {
+    std::sort(result.waits.begin(), result.waits.end());
+    double arrivals = qMax<qint64>(1, result.arrivals);
+
+    std::printf("spots %d, queue capacity %d, simulated %.1f h\n", config.spots, config.queueCapacity,
+                double(config.duration) / (60.0 * kMSecsPerMinute));
+    std::printf("arrivals          %12lld\n", static_cast<long long>(result.arrivals));
+    std::printf("parked directly   %12lld  (%6.2f%%)\n", static_cast<long long>(result.parkedDirectly),
+                100.0 * result.parkedDirectly / arrivals);
+    std::printf("queued            %12lld  (%6.2f%%)\n", static_cast<long long>(result.queued),
+                100.0 * result.queued / arrivals);
+    std::printf("rejected (full)   %12lld  (%6.2f%%)\n", static_cast<long long>(result.rejected),
+                100.0 * result.rejected / arrivals);
+    std::printf("abandoned queue   %12lld  (%6.2f%%)\n", static_cast<long long>(result.abandoned),
+                100.0 * result.abandoned / arrivals);
+    std::printf("departures        %12lld\n", static_cast<long long>(result.departures));
+    std::printf("queue wait (min)  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f  (%zu promoted)\n",
+                percentile(result.waits, 0.50), percentile(result.waits, 0.90), percentile(result.waits, 0.99),
+                result.waits.empty() ? 0.0 : double(result.waits.back()) / kMSecsPerMinute, result.waits.size());
+    std::printf("events            %12lld in %.3f s (%.0f events/s)\n", static_cast<long long>(result.events),
+                result.wallSeconds, result.wallSeconds > 0 ? result.events / result.wallSeconds : 0.0);
+
+    std::printf("\n%10s %10s %10s %10s\n", "hour", "parked", "occupancy", "queued");
+    for (size_t i = 0; i < result.curveTime.size(); ++i) {
+        std::printf("%10.2f %10d %9.1f%% %10d\n", result.curveTime[i], result.curveParked[i],
+                    100.0 * result.curveParked[i] / config.spots, result.curveQueued[i]);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("park_sim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("停车场离散事件仿真");
+    parser.addHelpOption();
+    QCommandLineOption spotsOption("spots", "停车位数量", "n", "100");
+    QCommandLineOption queueOption("queue", "等待队列容量", "n", "20");
+    QCommandLineOption rateOption("rate", "泊松到达率（辆/小时）", "r", "60");
+    QCommandLineOption dwellOption("dwell", "停留时长分布（分钟）: exp:均值 | lognormal:均值,sigma | uniform:最小,最大 | fixed:时长",
+                                   "spec", "exp:120");
+    QCommandLineOption patienceOption("patience", "排队超过该分钟数放弃，0 表示一直等待", "minutes", "0");
+    QCommandLineOption hoursOption("hours", "仿真时长（小时）", "h", "24");
+    QCommandLineOption sampleOption("sample", "占用率采样间隔（分钟）", "minutes", "60");
+    QCommandLineOption seedOption("seed", "随机数种子", "n", "1");
+    QCommandLineOption traceOption("trace", "到达轨迹文件，每行 \"到达秒数,停留秒数\"，指定后忽略 --rate/--dwell", "file");
+    parser.addOptions({spotsOption, queueOption, rateOption, dwellOption, patienceOption, hoursOption,
+                       sampleOption, seedOption, traceOption});
+    parser.process(app);
+
+    SimConfig config;
+    config.spots = qMax(1, parser.value(spotsOption).toInt());
+    config.queueCapacity = qMax(1, parser.value(queueOption).toInt());
+    config.arrivalsPerHour = parser.value(rateOption).toDouble();
+    config.patience = qint64(parser.value(patienceOption).toDouble() * kMSecsPerMinute);
+    config.duration = qint64(qMax(0.0, parser.value(hoursOption).toDouble()) * 60 * kMSecsPerMinute);
+    config.sampleInterval = qMax<qint64>(kMSecsPerMinute, qint64(parser.value(sampleOption).toDouble() * kMSecsPerMinute));
+    config.seed = parser.value(seedOption).toULongLong();
+    config.traceFile = parser.value(traceOption);
+    if (!DwellDistribution::parse(parser.value(dwellOption), &config.dwell)) {
+        std::fprintf(stderr, "无效的停留时长分布: %s\n", qPrintable(parser.value(dwellOption)));
+        return 1;
+    }
+
+    Simulation simulation(config);
+    if (!config.traceFile.isEmpty()) {
+        QString error;
+        if (!simulation.loadTrace(&error)) {
+            std::fprintf(stderr, "%s\n", qPrintable(error));
+            return 1;
+        }
+    }
+    SimResult result = simulation.run();
+    printReport(config, result);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "parkingcommandqueue.h"
+#include "parkingjournal.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+
+// ParkingCommandQueue 实现
+ParkingCommandQueue::ParkingCommandQueue(ParkingService *service, QMutex *lotMutex, QObject *parent)
+    : QObject(parent), service(service), lotMutex(lotMutex), pendingCommands(0), drainScheduled(false) {
+    qRegisterMetaType<QVector<ParkReply>>("QVector<ParkReply>");
+}
+
+quint64 ParkingCommandQueue::submit(const QVector<ParkCommand> &commands) {
+    if (commands.isEmpty()) return 0;
+    quint64 id;
+    {
+        QMutexLocker locker(&pendingMutex);
+        id = nextBatchId++;
+        pending.append({id, commands});
+    }
+    pendingCommands.fetch_add(commands.size(), std::memory_order_relaxed);
+    // 与闸机事件处理器相同：一次突发只投递一个处理请求
+    if (!drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, "processPending", Qt::QueuedConnection);
+    }
+    return id;
+}
+
+void ParkingCommandQueue::processPending() {
+    drainScheduled.store(false, std::memory_order_release);
+    QVector<Batch> batches;
+    {
+        QMutexLocker locker(&pendingMutex);
+        batches.swap(pending);
+    }
+
+    for (const Batch &batch : batches) {
+        QVector<ParkReply> replies;
+        replies.reserve(batch.commands.size());
+        // 粘贴的大批命令分段持锁，段与段之间让出 lotMutex，界面线程刷新缓存不会被整批阻塞
+        for (int begin = 0; begin < batch.commands.size(); begin += kCommandsPerLock) {
+            const int end = qMin(begin + kCommandsPerLock, int(batch.commands.size()));
+            QMutexLocker locker(lotMutex);
+            for (int i = begin; i < end; ++i) {
+                replies.append(service->execute(batch.commands[i]));
+            }
+        }
+        // 停车历史的写盘和不持锁等待落盘都放在锁外，界面在此期间照常读取
+        service->flushHistory();
+        QString error;
+        if (journal && !journal->sync(&error)) {
+            ParkingService::markNotDurable(replies, error);
+        }
+        pendingCommands.fetch_sub(batch.commands.size(), std::memory_order_relaxed);
+        emit batchFinished(batch.id, replies);
+    }
+}
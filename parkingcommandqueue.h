@@ -0,0 +1,56 @@
+#ifndef PARKINGCOMMANDQUEUE_H
+#define PARKINGCOMMANDQUEUE_H
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+#include <atomic>
+
+#include "parkingservice.h"
+
+class ParkingJournal;
+
+Q_DECLARE_METATYPE(ParkReply)
+
+// ParkingCommandQueue 类
+// 异步命令入口：任意线程调用 submit 提交一批命令后立即得到批次号；队列在自己所属的线程
+// （通常是停车场的工作线程）上依次交给 ParkingService 执行，每批执行完发出一次 batchFinished，
+// 跨线程连接时结果按排队连接送回。执行期间持有 lotMutex，其他线程读取停车场及挂在上面的观察者时也要先锁它；
+// 一批命令每执行 kCommandsPerLock 条释放一次锁，所以其他线程可能看到执行到一半的批次。
+// 设置了预写日志时，每批在释放 lotMutex 后等日志落盘再发出结果；落盘失败的修改以 StorageError 应答。
+class ParkingCommandQueue : public QObject {
+    Q_OBJECT
+
+public:
+    static const int kCommandsPerLock = 64;
+
+    ParkingCommandQueue(ParkingService *service, QMutex *lotMutex, QObject *parent = nullptr);
+
+    void setJournal(ParkingJournal *journal) { this->journal = journal; }
+    quint64 submit(const QVector<ParkCommand> &commands);  // 线程安全，空批次返回 0
+    int pendingCount() const { return pendingCommands.load(std::memory_order_relaxed); }  // 已提交未执行的命令数
+
+public slots:
+    void processPending();
+
+signals:
+    void batchFinished(quint64 batchId, const QVector<ParkReply> &replies);
+
+private:
+    struct Batch {
+        quint64 id;
+        QVector<ParkCommand> commands;
+    };
+
+    ParkingService *service;
+    QMutex *lotMutex;
+    ParkingJournal *journal = nullptr;
+    QMutex pendingMutex;
+    QVector<Batch> pending;
+    quint64 nextBatchId = 1;
+    std::atomic<int> pendingCommands;
+    std::atomic<bool> drainScheduled;
+};
+
+#endif // PARKINGCOMMANDQUEUE_H
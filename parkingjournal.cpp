@@ -0,0 +1,462 @@
+#include "parkingjournal.h"
+#include "tracing.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+enum RecordType : quint8 {
+    ConfigRecord = 1,   // spot = 车位总数，aux = 队列容量
+    ParkedRecord,       // aux = 车辆类型 | 排队优先级 << 8
+    ReleasedRecord,
+    QueuedRecord,       // aux 同 ParkedRecord
+    DequeuedRecord,
+    CancelledRecord
+};
+
+const char kSnapshotMagic[4] = {'P', 'K', 'S', 'N'};
+const quint32 kSnapshotVersion = 3;  // 版本 2 起每辆车带车辆类型，版本 3 起带排队优先级
+const int kRecordFixedBytes = 1 + 8 + 8 + 4 + 4 + 2;  // 类型、序号、时间、车位、附加值、车牌长度
+
+QString journalPath(const QString &directory) { return directory + "/journal.bin"; }
+QString snapshotPath(const QString &directory) { return directory + "/snapshot.bin"; }
+
+// FNV-1a，用于识别写了一半的尾部记录
+quint32 checksum(const char *data, qint64 size) {
+    quint32 hash = 2166136261u;
+    for (qint64 i = 0; i < size; ++i) {
+        hash ^= quint8(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void put(QByteArray &out, T value) {
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void putString(QByteArray &out, const QString &text) {
+    QByteArray utf8 = text.toUtf8();
+    put<quint16>(out, quint16(utf8.size()));
+    out.append(utf8);
+}
+
+// 在内存映射的数据上顺序解码，越界时 ok 置为 false
+struct Reader {
+    const uchar *data;
+    qint64 size;
+    qint64 pos = 0;
+    bool ok = true;
+
+    template <typename T>
+    T get() {
+        if (pos + qint64(sizeof(T)) > size) {
+            ok = false;
+            return T();
+        }
+        T value;
+        std::memcpy(&value, data + pos, sizeof(value));
+        pos += sizeof(value);
+        return qFromLittleEndian(value);
+    }
+
+    QString getString() {
+        quint16 length = get<quint16>();
+        if (!ok || pos + length > size) {
+            ok = false;
+            return QString();
+        }
+        QString text = QString::fromUtf8(reinterpret_cast<const char *>(data + pos), length);
+        pos += length;
+        return text;
+    }
+};
+
+bool syncFile(QFileDevice &file) {
+    if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+// 车辆类型和排队优先级打包进一个整数：低 8 位为类型，其上 8 位为优先级
+int packClasses(const Vehicle &vehicle) {
+    return int(vehicle.getVehicleClass()) | int(vehicle.getPriorityClass()) << 8;
+}
+
+Vehicle vehicleAt(const QString &licensePlate, qint64 timestamp, int classes) {
+    int vehicleClass = classes & 0xff;
+    int priorityClass = (classes >> 8) & 0xff;
+    if (vehicleClass >= kVehicleClassCount) vehicleClass = 0;
+    if (priorityClass >= kPriorityClassCount) priorityClass = 0;
+    return Vehicle(licensePlate, timestamp, VehicleClass(vehicleClass), PriorityClass(priorityClass));
+}
+
+int readClasses(Reader &reader, quint32 version) {
+    int vehicleClass = version >= 2 ? reader.get<quint8>() : 0;
+    int priorityClass = version >= 3 ? reader.get<quint8>() : 0;
+    return vehicleClass | priorityClass << 8;
+}
+
+bool loadSnapshot(const QString &directory, ParkingLot *parkingLot, ParkingJournal::RecoveryInfo *info) {
+    QFile file(snapshotPath(directory));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < 36) {
+        return false;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (!data) {
+        return false;
+    }
+
+    qint64 size = file.size();
+    Reader reader{data, size - 4};
+    quint32 stored = qFromLittleEndian<quint32>(data + size - 4);
+    if (std::memcmp(data, kSnapshotMagic, 4) != 0
+        || stored != checksum(reinterpret_cast<const char *>(data), size - 4)) {
+        qWarning("停车场快照已损坏，忽略: %s", qPrintable(file.fileName()));
+        return false;
+    }
+
+    reader.pos = 4;
+    quint32 version = reader.get<quint32>();
+    qint64 sequence = reader.get<qint64>();
+    qint32 totalSpots = reader.get<qint32>();
+    qint32 maxQueue = reader.get<qint32>();
+    qint32 parkedCount = reader.get<qint32>();
+    qint32 queuedCount = reader.get<qint32>();
+    if (!reader.ok || version < 1 || version > kSnapshotVersion) {
+        return false;
+    }
+
+    *parkingLot = ParkingLot(totalSpots, maxQueue, parkingLot->getClock());
+    for (qint32 i = 0; i < parkedCount && reader.ok; ++i) {
+        qint32 spot = reader.get<qint32>();
+        qint64 entryTime = reader.get<qint64>();
+        int classes = readClasses(reader, version);
+        QString licensePlate = reader.getString();
+        if (reader.ok) parkingLot->restoreParked(vehicleAt(licensePlate, entryTime, classes), spot);
+    }
+    for (qint32 i = 0; i < queuedCount && reader.ok; ++i) {
+        qint64 entryTime = reader.get<qint64>();
+        int classes = readClasses(reader, version);
+        QString licensePlate = reader.getString();
+        if (reader.ok) parkingLot->restoreQueued(vehicleAt(licensePlate, entryTime, classes));
+    }
+
+    info->totalSpots = totalSpots;
+    info->maxQueueCapacity = maxQueue;
+    info->lastSequence = sequence;
+    info->snapshotVehicles = parkedCount + queuedCount;
+    return reader.ok;
+}
+
+} // namespace
+
+// ParkingJournal 实现
+bool ParkingJournal::recover(const QString &directory, ParkingLot *parkingLot, RecoveryInfo *info) {
+    QElapsedTimer timer;
+    timer.start();
+    *info = RecoveryInfo();
+
+    bool configured = loadSnapshot(directory, parkingLot, info);
+
+    QFile file(journalPath(directory));
+    qint64 validEnd = -1;
+    if (file.open(QIODevice::ReadOnly) && file.size() > 0) {
+        qint64 size = file.size();
+        const uchar *data = file.map(0, size);
+        validEnd = data ? 0 : size;
+
+        Reader reader{data, size};
+        while (data && reader.pos < size) {
+            quint32 length = reader.get<quint32>();
+            qint64 payload = reader.pos;
+            if (!reader.ok || length < quint32(kRecordFixedBytes) || payload + length + 4 > size) {
+                break;  // 崩溃时写了一半的尾部记录
+            }
+            quint32 stored = qFromLittleEndian<quint32>(data + payload + length);
+            if (stored != checksum(reinterpret_cast<const char *>(data + payload), length)) {
+                break;
+            }
+
+            Reader record{data + payload, qint64(length)};
+            quint8 type = record.get<quint8>();
+            qint64 sequence = record.get<qint64>();
+            qint64 timestamp = record.get<qint64>();
+            qint32 spot = record.get<qint32>();
+            qint32 aux = record.get<qint32>();
+            QString licensePlate = record.getString();
+            reader.pos = payload + length + 4;
+            validEnd = reader.pos;
+
+            if (!record.ok || sequence <= info->lastSequence) {
+                continue;  // 已包含在快照中
+            }
+            if (type == ConfigRecord) {
+                if (!configured) {
+                    *parkingLot = ParkingLot(spot, aux, parkingLot->getClock());
+                    info->totalSpots = spot;
+                    info->maxQueueCapacity = aux;
+                    configured = true;
+                }
+            } else if (!configured) {
+                continue;
+            } else if (type == ParkedRecord) {
+                parkingLot->restoreParked(vehicleAt(licensePlate, timestamp, aux), spot);
+            } else if (type == ReleasedRecord) {
+                parkingLot->restoreReleased(PlateKey(licensePlate));
+            } else if (type == QueuedRecord) {
+                parkingLot->restoreQueued(vehicleAt(licensePlate, timestamp, aux));
+            } else if (type == DequeuedRecord || type == CancelledRecord) {
+                parkingLot->restoreRemovedFromQueue(PlateKey(licensePlate));
+            }
+            info->lastSequence = sequence;
+            ++info->replayedRecords;
+        }
+
+        if (data) {
+            file.unmap(const_cast<uchar *>(data));
+        }
+        if (validEnd == size) validEnd = -1;
+    }
+    file.close();
+    if (validEnd >= 0) {
+        QFile::resize(journalPath(directory), validEnd);  // 截掉损坏的尾部，后续从这里继续追加
+    }
+
+    info->elapsedMSecs = timer.elapsed();
+    return configured;
+}
+
+ParkingJournal::ParkingJournal(const QString &directory, int totalSpots, int maxQueueCapacity, qint64 lastSequence,
+                               const Clock *clock)
+    : directory(directory), clock(clock), nextSequence(lastSequence + 1), durableSequence(lastSequence) {
+    QDir().mkpath(directory);
+    journalFile.setFileName(journalPath(directory));
+
+    // 新日志以配置记录开头，没有快照时也能据此重建停车场
+    QFileInfo journalInfo(journalFile);
+    if (!journalInfo.exists() || journalInfo.size() == 0) {
+        append(ConfigRecord, 0, totalSpots, maxQueueCapacity, QString());
+    }
+
+    writer = std::thread(&ParkingJournal::writerLoop, this);
+}
+
+ParkingJournal::~ParkingJournal() {
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        dataReady.wakeAll();
+    }
+    writer.join();
+}
+
+void ParkingJournal::append(quint8 type, qint64 timestamp, int spot, int aux, const QString &licensePlate) {
+    PARK_TRACE_SCOPE(JournalAppend);
+    QByteArray plate = licensePlate.toUtf8();
+
+    QMutexLocker locker(&mutex);
+    // 直接编码到待写缓冲区：长度、负载、校验和
+    int start = pending.size();
+    put<quint32>(pending, quint32(kRecordFixedBytes + plate.size()));
+    put<quint8>(pending, type);
+    put<qint64>(pending, nextSequence++);
+    put<qint64>(pending, timestamp);
+    put<qint32>(pending, spot);
+    put<qint32>(pending, aux);
+    put<quint16>(pending, quint16(plate.size()));
+    pending.append(plate);
+    put<quint32>(pending, checksum(pending.constData() + start + 4, pending.size() - start - 4));
+    ++sinceCheckpoint;
+    dataReady.wakeOne();
+}
+
+void ParkingJournal::checkpoint(const ParkingLot &parkingLot) {
+    PARK_TRACE_SCOPE(Checkpoint);
+    const ParkingSpotManager &spots = parkingLot.getSpotManager();
+    const QueueManager &queue = parkingLot.getQueueManager();
+
+    QByteArray snapshot;
+    snapshot.reserve(36 + spots.getParkedCount() * 26 + queue.getQueueLength() * 22);
+    snapshot.append(kSnapshotMagic, 4);
+    put<quint32>(snapshot, kSnapshotVersion);
+    int sequenceOffset = snapshot.size();
+    put<qint64>(snapshot, 0);  // 序号在加锁后回填
+    put<qint32>(snapshot, spots.getTotalSpots());
+    put<qint32>(snapshot, queue.getMaxCapacity());
+    put<qint32>(snapshot, spots.getParkedCount());
+    put<qint32>(snapshot, queue.getQueueLength());
+    spots.forEachParkedVehicle([&](int spot, const Vehicle &vehicle) {
+        put<qint32>(snapshot, spot);
+        put<qint64>(snapshot, vehicle.getEntryTime());
+        put<quint8>(snapshot, quint8(vehicle.getVehicleClass()));
+        put<quint8>(snapshot, quint8(vehicle.getPriorityClass()));
+        putString(snapshot, vehicle.getLicensePlate());
+    });
+    // 按放行顺序写出，恢复时依次入队即可还原各优先级内的先后次序
+    queue.forEachQueuedVehicle([&](const Vehicle &vehicle) {
+        put<qint64>(snapshot, vehicle.getEntryTime());
+        put<quint8>(snapshot, quint8(vehicle.getVehicleClass()));
+        put<quint8>(snapshot, quint8(vehicle.getPriorityClass()));
+        putString(snapshot, vehicle.getLicensePlate());
+    });
+
+    QMutexLocker locker(&mutex);
+    // 调用方持有停车场的锁（界面中为 lotMutex，无界面服务中两者在同一线程），
+    // 编码期间没有新的状态修改，此刻已追加的记录正好都被快照覆盖
+    qint64 sequence = qToLittleEndian<qint64>(nextSequence - 1);
+    std::memcpy(snapshot.data() + sequenceOffset, &sequence, sizeof(sequence));
+    put<quint32>(snapshot, checksum(snapshot.constData(), snapshot.size()));
+
+    beforeSnapshot.append(pending);
+    pending.clear();
+    pendingSnapshot = snapshot;
+    sinceCheckpoint = 0;
+    dataReady.wakeOne();
+}
+
+bool ParkingJournal::sync(QString *error) {
+    PARK_TRACE_SCOPE(JournalSync);
+    QMutexLocker locker(&mutex);
+    qint64 target = nextSequence - 1;
+    while (durableSequence < target && ioError.isEmpty()) {
+        committed.wait(&mutex);
+    }
+    if (durableSequence >= target) return true;
+    if (error) *error = ioError;
+    return false;
+}
+
+void ParkingJournal::setCommitCallback(std::function<void()> callback) {
+    QMutexLocker locker(&mutex);
+    commitCallback = std::move(callback);
+}
+
+qint64 ParkingJournal::getLastSequence() const {
+    QMutexLocker locker(&mutex);
+    return nextSequence - 1;
+}
+
+qint64 ParkingJournal::getDurableSequence() const {
+    QMutexLocker locker(&mutex);
+    return durableSequence;
+}
+
+QString ParkingJournal::getError() const {
+    QMutexLocker locker(&mutex);
+    return ioError;
+}
+
+qint64 ParkingJournal::recordsSinceCheckpoint() const {
+    QMutexLocker locker(&mutex);
+    return sinceCheckpoint;
+}
+
+// 成组提交：每轮把这段时间内积累的全部记录一次写入并 fsync，
+// fsync 期间新到的记录自然汇成下一组。任何一步失败都不推进 durableSequence
+void ParkingJournal::writerLoop() {
+    QString error;
+    if (!journalFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        error = QString("无法打开停车场日志文件 %1：%2").arg(journalFile.fileName(), journalFile.errorString());
+    }
+
+    for (;;) {
+        QByteArray before, snapshot, after;
+        qint64 upTo;
+        bool exiting;
+        {
+            QMutexLocker locker(&mutex);
+            if (!error.isEmpty() && ioError.isEmpty()) {
+                ioError = error;
+                qWarning("%s", qPrintable(ioError));
+                committed.wakeAll();
+                if (commitCallback) commitCallback();
+            }
+            while (!stopping && pending.isEmpty() && beforeSnapshot.isEmpty() && pendingSnapshot.isEmpty()) {
+                dataReady.wait(&mutex);
+            }
+            before.swap(beforeSnapshot);
+            snapshot.swap(pendingSnapshot);
+            after.swap(pending);
+            upTo = nextSequence - 1;
+            exiting = stopping;
+        }
+
+        // 出错后日志中间缺了记录，再往后写也无法正确重放，只丢弃
+        if (error.isEmpty() && !before.isEmpty() && journalFile.write(before) != before.size()) {
+            error = QString("写入停车场日志失败：%1").arg(journalFile.errorString());
+        }
+        if (error.isEmpty() && !snapshot.isEmpty()) {
+            if (!syncFile(journalFile)) {
+                error = QString("停车场日志 fsync 失败：%1").arg(journalFile.errorString());
+            } else {
+                // 快照写失败不影响日志本身，日志保留全部记录，下次检查点再试
+                QSaveFile snapshotFile(snapshotPath(directory));
+                if (snapshotFile.open(QIODevice::WriteOnly) && snapshotFile.write(snapshot) == snapshot.size()
+                    && syncFile(snapshotFile) && snapshotFile.commit()) {
+                    journalFile.resize(0);  // 快照已覆盖日志中的全部记录
+                } else {
+                    qWarning("写入停车场快照失败：%s", qPrintable(snapshotFile.errorString()));
+                }
+            }
+        }
+        if (error.isEmpty() && !after.isEmpty() && journalFile.write(after) != after.size()) {
+            error = QString("写入停车场日志失败：%1").arg(journalFile.errorString());
+        }
+        if (error.isEmpty() && !syncFile(journalFile)) {
+            error = QString("停车场日志 fsync 失败：%1").arg(journalFile.errorString());
+        }
+
+        {
+            QMutexLocker locker(&mutex);
+            if (error.isEmpty()) {
+                durableSequence = upTo;
+            } else if (ioError.isEmpty()) {
+                ioError = error;
+                qWarning("%s", qPrintable(ioError));
+            }
+            committed.wakeAll();
+            // 在锁内调用，清除回调的线程返回后不会再被回调
+            if (commitCallback) commitCallback();
+        }
+        if (exiting) break;
+    }
+}
+
+void ParkingJournal::vehicleParked(const Vehicle &vehicle, int spot) {
+    append(ParkedRecord, vehicle.getEntryTime(), spot, packClasses(vehicle), vehicle.getLicensePlate());
+}
+
+void ParkingJournal::vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) {
+    append(ReleasedRecord, release.exitTime, spot, 0, vehicle.getLicensePlate());
+}
+
+void ParkingJournal::vehicleQueued(const Vehicle &vehicle) {
+    append(QueuedRecord, vehicle.getEntryTime(), -1, packClasses(vehicle), vehicle.getLicensePlate());
+}
+
+void ParkingJournal::vehicleDequeued(const Vehicle &vehicle) {
+    append(DequeuedRecord, clock->now(), -1, 0, vehicle.getLicensePlate());
+}
+
+void ParkingJournal::queueCancelled(const Vehicle &vehicle) {
+    append(CancelledRecord, clock->now(), -1, 0, vehicle.getLicensePlate());
+}
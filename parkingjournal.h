@@ -0,0 +1,88 @@
+#ifndef PARKINGJOURNAL_H
+#define PARKINGJOURNAL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <functional>
+#include <thread>
+
+#include "parkinglot.h"
+
+// ParkingJournal 类
+// 停车场的预写日志与快照持久化，目录中包含两个文件：
+//   journal.bin  - 只追加的二进制事件日志（入库/出库/排队/出队/取消排队），每条带序号和校验和
+//   snapshot.bin - 某个序号时刻的紧凑快照，启动时以内存映射方式读取
+// 作为 ParkingLotObserver 挂在停车场上，事件只在调用线程编码进内存缓冲区；
+// 后台线程成组写盘并 fsync（group commit），因此不会给闸机路径增加可见延迟。
+// 启动时先加载快照，再重放日志中序号更大的尾部记录。
+// 写盘或 fsync 失败后日志进入错误状态：之后的记录不再写入也不算落盘，sync 返回 false，
+// 调用方应把操作报告为失败而不是已确认。
+class ParkingJournal : public ParkingLotObserver {
+public:
+    struct RecoveryInfo {
+        int totalSpots = 0;
+        int maxQueueCapacity = 0;
+        qint64 lastSequence = 0;      // 已恢复的最大序号
+        int snapshotVehicles = 0;     // 快照中的车辆数（含排队）
+        int replayedRecords = 0;      // 重放的日志记录数
+        qint64 elapsedMSecs = 0;
+    };
+
+    // 从目录恢复停车场状态；目录中没有任何持久化数据时返回 false
+    static bool recover(const QString &directory, ParkingLot *parkingLot, RecoveryInfo *info);
+
+    // lastSequence 取自 recover 的结果，新日志从它之后继续编号
+    ParkingJournal(const QString &directory, int totalSpots, int maxQueueCapacity, qint64 lastSequence = 0,
+                   const Clock *clock = Clock::system());
+    ~ParkingJournal() override;
+
+    ParkingJournal(const ParkingJournal &) = delete;
+    ParkingJournal &operator=(const ParkingJournal &) = delete;
+
+    // 把当前状态编码为快照交给写盘线程，写完后清空已被快照覆盖的日志
+    void checkpoint(const ParkingLot &parkingLot);
+    // 阻塞直到已追加的记录全部落盘；日志处于错误状态时立即返回 false 并给出原因
+    bool sync(QString *error = nullptr);
+    // 不阻塞的落盘确认：记下 getLastSequence()，在回调中比较 getDurableSequence()。
+    // 回调在写盘线程上、每轮写盘结束（落盘或出错）后调用，只应投递事件，不能再调用日志的方法
+    void setCommitCallback(std::function<void()> callback);
+    qint64 getLastSequence() const;     // 已追加的最大序号
+    qint64 getDurableSequence() const;  // 已 fsync 的最大序号
+    QString getError() const;  // 没有写盘错误时为空
+    qint64 recordsSinceCheckpoint() const;
+
+    void vehicleParked(const Vehicle &vehicle, int spot) override;
+    void vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) override;
+    void vehicleQueued(const Vehicle &vehicle) override;
+    void vehicleDequeued(const Vehicle &vehicle) override;
+    void queueCancelled(const Vehicle &vehicle) override;
+
+private:
+    void append(quint8 type, qint64 timestamp, int spot, int aux, const QString &licensePlate);
+    void writerLoop();
+
+    QString directory;
+    const Clock *clock;             // 出库、出队等事件的记录时间
+
+    mutable QMutex mutex;
+    QWaitCondition dataReady;
+    QWaitCondition committed;
+    QByteArray pending;             // 尚未写盘的日志记录
+    QByteArray beforeSnapshot;      // 快照之前追加、必须先于快照写入的记录
+    QByteArray pendingSnapshot;
+    qint64 nextSequence;
+    qint64 durableSequence;         // 已 fsync 的最大序号
+    QString ioError;                // 第一次写盘失败的原因，之后不再写日志
+    std::function<void()> commitCallback;
+    qint64 sinceCheckpoint = 0;
+    bool stopping = false;
+
+    QFile journalFile;              // 只在写盘线程中访问
+    std::thread writer;
+};
+
+#endif // PARKINGJOURNAL_H
@@ -0,0 +1,137 @@
+#include "parkinglot.h"
+#include "tracing.h"
+
+// ParkingLot 实现
+ParkingLot::ParkingLot(int totalSpots, int maxQueueCapacity, const Clock *clock)
+    : spotManager(totalSpots), queueManager(maxQueueCapacity), clock(clock) {}
+
+ParkingLot::ParkingLot(const SpotLayout &layout, int maxQueueCapacity, const Clock *clock)
+    : spotManager(layout), queueManager(maxQueueCapacity), clock(clock) {}
+
+ParkingLot::ParkResult ParkingLot::parkOrEnqueue(const Vehicle &vehicle) {
+    PARK_TRACE_SCOPE(Park);
+    const PlateKey &plate = vehicle.getPlateKey();
+    if (!plate.isValid()) {
+        return {ParkStatus::InvalidPlate, -1};
+    }
+    if (spotManager.hasVehicle(plate) || queueManager.hasVehicleInQueue(plate)) {
+        return {ParkStatus::Duplicate, -1};
+    }
+
+    if (!spotManager.fits(vehicle)) {
+        // 排队也等不到合适的车位
+        for (ParkingLotObserver *observer : observers) observer->vehicleRejected(vehicle);
+        return {ParkStatus::NoSuitableSpot, -1};
+    }
+    if (!spotManager.canPark(vehicle)) {
+        if (queueManager.isQueueFull()) {
+            for (ParkingLotObserver *observer : observers) observer->vehicleRejected(vehicle);
+            return {ParkStatus::QueueFull, -1};
+        }
+        queueManager.addVehicleToQueue(vehicle);
+        for (ParkingLotObserver *observer : observers) observer->vehicleQueued(vehicle);
+        return {ParkStatus::Queued, -1};
+    }
+
+    int spot = spotManager.parkVehicle(vehicle);
+    for (ParkingLotObserver *observer : observers) observer->vehicleParked(vehicle, spot);
+    return {ParkStatus::Parked, spot};
+}
+
+ParkingLot::SpotResult ParkingLot::releaseVehicle(const PlateKey &plate) {
+    ReleaseInfo release;
+    release.exitTime = clock->now();
+    return releaseVehicle(plate, release);
+}
+
+ParkingLot::SpotResult ParkingLot::releaseVehicle(const PlateKey &plate, const ReleaseInfo &release) {
+    PARK_TRACE_SCOPE(Release);
+    int spot = spotManager.findSpot(plate);
+    if (spot < 0) {
+        return {-1, Vehicle()};
+    }
+    Vehicle vehicle = *spotManager.getVehicleAt(spot);
+    spotManager.removeVehicle(plate);
+    for (ParkingLotObserver *observer : observers) observer->vehicleReleased(vehicle, spot, release);
+    return {spot, vehicle};
+}
+
+ParkingLot::SpotResult ParkingLot::promoteNextVehicle() {
+    PARK_TRACE_SCOPE(Promote);
+    if (queueManager.isQueueEmpty() || spotManager.isFull()) {
+        return {-1, Vehicle()};
+    }
+    // 通常队首车辆就有合适的车位；队首的大车等不到车位时，后面能停进腾出车位的车辆先放行
+    Vehicle vehicle;
+    if (spotManager.canPark(*queueManager.peekNextVehicle())) {
+        vehicle = queueManager.dequeueVehicle();
+    } else {
+        // 能否停车只取决于车型和排队类别：先按组合算一次，队列中没有可停的组合时不必遍历，
+        // 否则按放行顺序找到第一辆可停的车辆即停止
+        bool eligible[kPriorityClassCount][kVehicleClassCount];
+        bool any = false;
+        for (int p = 0; p < kPriorityClassCount; ++p) {
+            for (int v = 0; v < kVehicleClassCount; ++v) {
+                eligible[p][v] = queueManager.getClassLength(PriorityClass(p), VehicleClass(v)) > 0
+                                 && spotManager.canPark(Vehicle(PlateKey(), 0, VehicleClass(v), PriorityClass(p)));
+                any = any || eligible[p][v];
+            }
+        }
+        const Vehicle *queued = any ? queueManager.findQueuedVehicle([&](const Vehicle &candidate) {
+            return eligible[int(candidate.getPriorityClass())][int(candidate.getVehicleClass())];
+        }) : nullptr;
+        if (!queued) {
+            return {-1, Vehicle()};
+        }
+        vehicle = *queued;
+        queueManager.removeVehicleFromQueue(vehicle.getPlateKey());
+    }
+    int spot = spotManager.parkVehicle(vehicle);
+    for (ParkingLotObserver *observer : observers) {
+        observer->vehicleDequeued(vehicle);
+        observer->vehicleParked(vehicle, spot);
+    }
+    return {spot, vehicle};
+}
+
+bool ParkingLot::cancelQueuedVehicle(const PlateKey &plate) {
+    PARK_TRACE_SCOPE(CancelQueue);
+    Vehicle vehicle;
+    if (!queueManager.removeVehicleFromQueue(plate, &vehicle)) {
+        return false;
+    }
+    for (ParkingLotObserver *observer : observers) observer->queueCancelled(vehicle);
+    return true;
+}
+
+bool ParkingLot::setSpotLayout(const SpotLayout &layout) {
+    return spotManager.setLayout(layout);
+}
+
+void ParkingLot::setAllocationPolicy(std::shared_ptr<const SpotAllocationPolicy> policy) {
+    spotManager.setAllocationPolicy(std::move(policy));
+}
+
+void ParkingLot::addObserver(ParkingLotObserver *observer) {
+    if (!observers.contains(observer)) observers.append(observer);
+}
+
+void ParkingLot::removeObserver(ParkingLotObserver *observer) {
+    observers.removeAll(observer);
+}
+
+bool ParkingLot::restoreParked(const Vehicle &vehicle, int spot) {
+    return spotManager.parkVehicleAt(vehicle, spot);
+}
+
+void ParkingLot::restoreReleased(const PlateKey &plate) {
+    spotManager.removeVehicle(plate);
+}
+
+void ParkingLot::restoreQueued(const Vehicle &vehicle) {
+    queueManager.addVehicleToQueue(vehicle);
+}
+
+void ParkingLot::restoreRemovedFromQueue(const PlateKey &plate) {
+    queueManager.removeVehicleFromQueue(plate);
+}
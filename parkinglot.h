@@ -0,0 +1,78 @@
+#ifndef PARKINGLOT_H
+#define PARKINGLOT_H
+
+#include <QVector>
+#include "clock.h"
+#include "parkingspotmanager.h"
+#include "queuemanager.h"
+#include "vehicle.h"
+
+// 出库时已结算的离场时间和费用，由计费的调用方给出，观察者照此记账，不再各自读时钟和计价
+struct ReleaseInfo {
+    qint64 exitTime = 0;
+    qint64 feeCents = -1;   // 调用方没有计费（闸机、模拟）时为 -1
+};
+
+// ParkingLotObserver 接口
+// 订阅停车场状态变化（持久化、统计等），回调在修改状态的线程上同步执行，应保持轻量。
+class ParkingLotObserver {
+public:
+    virtual ~ParkingLotObserver() = default;
+    virtual void vehicleParked(const Vehicle &, int /*spot*/) {}
+    virtual void vehicleReleased(const Vehicle &, int /*spot*/, const ReleaseInfo &) {}
+    virtual void vehicleQueued(const Vehicle &) {}
+    virtual void vehicleDequeued(const Vehicle &) {}   // 队首车辆被放行，随后会收到 vehicleParked
+    virtual void queueCancelled(const Vehicle &) {}    // 车辆放弃排队
+    virtual void vehicleRejected(const Vehicle &) {}   // 等待队列已满或没有能容纳该车型的车位，车辆被拒绝
+};
+
+// ParkingLot 类
+// 把车位管理和等待队列组合成一个停车场，集中实现“入库或排队”“出库”“放行队首”的规则，
+// 界面操作和闸机事件都通过它修改状态，保证两条路径的规则一致。
+class ParkingLot {
+public:
+    enum class ParkStatus { Parked, Queued, Duplicate, QueueFull, InvalidPlate, NoSuitableSpot };
+    struct ParkResult {
+        ParkStatus status;
+        int spot;           // Parked 时为车位号，否则为 -1
+    };
+
+    struct SpotResult {
+        int spot;           // 涉及的车位号，操作未发生时为 -1
+        Vehicle vehicle;
+    };
+
+    ParkingLot(int totalSpots, int maxQueueCapacity, const Clock *clock = Clock::system());
+    ParkingLot(const SpotLayout &layout, int maxQueueCapacity, const Clock *clock = Clock::system());
+
+    ParkResult parkOrEnqueue(const Vehicle &vehicle);
+    SpotResult releaseVehicle(const PlateKey &plate);  // 以当前时刻离场，不计费
+    SpotResult releaseVehicle(const PlateKey &plate, const ReleaseInfo &release);
+    SpotResult promoteNextVehicle();  // 按放行顺序把第一辆有合适空车位的排队车辆停入车位
+    bool cancelQueuedVehicle(const PlateKey &plate);
+
+    const ParkingSpotManager &getSpotManager() const { return spotManager; }
+    const QueueManager &getQueueManager() const { return queueManager; }
+    const Clock *getClock() const { return clock; }  // 入场时间、计费和日志共用的时钟
+
+    // 车位布局和分配策略不写入持久化日志，恢复状态后由调用方重新设置
+    bool setSpotLayout(const SpotLayout &layout);  // 车位数必须不变
+    void setAllocationPolicy(std::shared_ptr<const SpotAllocationPolicy> policy);
+
+    void addObserver(ParkingLotObserver *observer);
+    void removeObserver(ParkingLotObserver *observer);
+
+    // 从快照或日志恢复状态时使用，不通知观察者
+    bool restoreParked(const Vehicle &vehicle, int spot);
+    void restoreReleased(const PlateKey &plate);
+    void restoreQueued(const Vehicle &vehicle);
+    void restoreRemovedFromQueue(const PlateKey &plate);
+
+private:
+    ParkingSpotManager spotManager;
+    QueueManager queueManager;
+    QVector<ParkingLotObserver *> observers;
+    const Clock *clock;
+};
+
+#endif // PARKINGLOT_H
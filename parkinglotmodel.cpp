@@ -0,0 +1,161 @@
+#include "parkinglotmodel.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+// ParkingLotModel 实现
+ParkingLotModel::ParkingLotModel(const ParkingLot *parkingLot, QObject *parent)
+    : QAbstractListModel(parent), parkingLot(parkingLot),
+    uniformLayout(parkingLot->getSpotManager().getAllocator().getLayout().isUniform()) {
+    // 模型在工作线程启动前创建，此时不需要加锁
+    reloadSpots();
+}
+
+void ParkingLotModel::reloadSpots() {
+    const ParkingSpotManager &spotManager = parkingLot->getSpotManager();
+    spotVehicles.fill(Vehicle(), spotManager.getTotalSpots());
+    spotManager.forEachParkedVehicle([this](int spot, const Vehicle &vehicle) { spotVehicles[spot] = vehicle; });
+}
+
+int ParkingLotModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : spotVehicles.size();
+}
+
+QVariant ParkingLotModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= spotVehicles.size()) return QVariant();
+
+    const Vehicle &cached = spotVehicles[index.row()];
+    const Vehicle *vehicle = cached.getPlateKey().isValid() ? &cached : nullptr;
+    switch (role) {
+    case OccupiedRole:
+        return vehicle != nullptr;
+    case Qt::DisplayRole:
+        return vehicle ? vehicle->getLicensePlate() : QString();
+    case EntryTimeRole:
+        return vehicle ? QVariant(vehicle->getEntryTime()) : QVariant();
+    case SpotTagRole:
+        return spotTag(index.row());
+    case Qt::ToolTipRole: {
+        QString tag = spotTag(index.row());
+        QString spotName = tag.isEmpty() ? QString("%1 号车位").arg(index.row() + 1)
+                                         : QString("%1 号车位（%2）").arg(index.row() + 1).arg(tag);
+        return vehicle ? QString("%1\n车牌号: %2\n停车时间: %3")
+                             .arg(spotName)
+                             .arg(vehicle->getLicensePlate())
+                             .arg(formatTimestamp(vehicle->getEntryTime()))
+                       : QString("%1：空置").arg(spotName);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QString ParkingLotModel::spotTag(int spot) const {
+    // 布局在启动时确定，之后不再变化，读取不需要加锁
+    if (uniformLayout) return QString();
+    const SpotLayout &layout = parkingLot->getSpotManager().getAllocator().getLayout();
+    PriorityClass reservation = PriorityClass(layout.reservations[spot]);
+    if (reservation != PriorityClass::Regular) return priorityClassName(reservation);
+    VehicleClass size = VehicleClass(layout.sizes[spot]);
+    return size == VehicleClass::Standard ? QString() : vehicleClassName(size);
+}
+
+void ParkingLotModel::notifySpotsChanged(QVector<int> spots) {
+    if (spots.isEmpty()) return;
+    std::sort(spots.begin(), spots.end());
+    {
+        QMutexLocker locker(lotMutex);
+        const ParkingSpotManager &spotManager = parkingLot->getSpotManager();
+        for (int spot : spots) {
+            if (spot < 0 || spot >= spotVehicles.size()) continue;
+            spotVehicles[spot] = spotManager.getVehicleAt(spot).value_or(Vehicle());
+        }
+    }
+
+    const QVector<int> roles{OccupiedRole, Qt::DisplayRole, EntryTimeRole, Qt::ToolTipRole};
+    int first = spots.first();
+    int last = first;
+    for (int i = 1; i <= spots.size(); ++i) {
+        if (i < spots.size() && spots[i] <= last + 1) {
+            last = qMax(last, spots[i]);
+            continue;
+        }
+        emit dataChanged(index(first), index(last), roles);
+        if (i < spots.size()) {
+            first = last = spots[i];
+        }
+    }
+}
+
+void ParkingLotModel::resetLot() {
+    beginResetModel();
+    uniformLayout = parkingLot->getSpotManager().getAllocator().getLayout().isUniform();
+    {
+        QMutexLocker locker(lotMutex);
+        reloadSpots();
+    }
+    endResetModel();
+}
+
+// WaitingQueueModel 实现
+WaitingQueueModel::WaitingQueueModel(const ParkingLot *parkingLot, QObject *parent)
+    : QAbstractListModel(parent), parkingLot(parkingLot) {
+    reloadQueue();
+}
+
+void WaitingQueueModel::reloadQueue() {
+    const QueueManager &queueManager = parkingLot->getQueueManager();
+    queueCapacity = queueManager.getMaxCapacity();
+    queuedVehicles.clear();
+    queuedVehicles.reserve(queueManager.getQueueLength());
+    queueManager.forEachQueuedVehicle([this](const Vehicle &vehicle) { queuedVehicles.append(vehicle); });
+}
+
+int WaitingQueueModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : queueCapacity;
+}
+
+QVariant WaitingQueueModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) return QVariant();
+
+    const Vehicle *vehicle = index.row() < queuedVehicles.size() ? &queuedVehicles[index.row()] : nullptr;
+    switch (role) {
+    case ParkingLotModel::OccupiedRole:
+        return vehicle != nullptr;
+    case Qt::DisplayRole:
+        return vehicle ? vehicle->getLicensePlate() : QString();
+    case ParkingLotModel::EntryTimeRole:
+        return vehicle ? QVariant(vehicle->getEntryTime()) : QVariant();
+    case Qt::ToolTipRole:
+        return vehicle ? QString("排队第 %1 位\n车牌号: %2\n排队类别: %3")
+                             .arg(index.row() + 1)
+                             .arg(vehicle->getLicensePlate())
+                             .arg(priorityClassName(vehicle->getPriorityClass()))
+                       : QString("该位置无等待车辆");
+    default:
+        return QVariant();
+    }
+}
+
+void WaitingQueueModel::notifyQueueChanged() {
+    // 出队、放弃排队或优先车辆插队都会改变后面车辆的位置，所以从队首开始通知
+    int shownQueueLength = queuedVehicles.size();
+    {
+        QMutexLocker locker(lotMutex);
+        reloadQueue();
+    }
+    int last = qMin(qMax(int(queuedVehicles.size()), shownQueueLength), rowCount()) - 1;
+    if (last >= 0) {
+        emit dataChanged(index(0), index(last));
+    }
+}
+
+void WaitingQueueModel::resetQueue() {
+    beginResetModel();
+    {
+        QMutexLocker locker(lotMutex);
+        reloadQueue();
+    }
+    endResetModel();
+}
@@ -0,0 +1,67 @@
+#ifndef PARKINGLOTMODEL_H
+#define PARKINGLOTMODEL_H
+
+#include <QAbstractListModel>
+#include <QMutex>
+#include <QVector>
+#include "parkinglot.h"
+
+// ParkingLotModel 类
+// 停车场车位的只读列表模型，每一行对应一个车位。界面线程保留各车位车辆的副本，
+// 只在 notifySpotsChanged/resetLot 时锁一次 lotMutex 复制变化的车位，绘制时 data() 不持锁。
+class ParkingLotModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        OccupiedRole = Qt::UserRole + 1,  // bool，车位/队列位置上是否有车
+        EntryTimeRole,                    // qint64 毫秒时间戳，入场或进入队列的时间
+        SpotTagRole                       // QString，保留类别或非标准尺寸，不区分车位的布局为空
+    };
+
+    explicit ParkingLotModel(const ParkingLot *parkingLot, QObject *parent = nullptr);
+    void setLotMutex(QMutex *mutex) { lotMutex = mutex; }  // 停车场在工作线程上修改时，刷新副本前先锁它
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // 复制这些车位的当前车辆，把相邻的车位合并成区间后发出 dataChanged，视图只重绘可见部分
+    void notifySpotsChanged(QVector<int> spots);
+    void resetLot();
+
+private:
+    QString spotTag(int spot) const;
+    void reloadSpots();  // 调用方持有 lotMutex
+
+    const ParkingLot *parkingLot;
+    QMutex *lotMutex = nullptr;
+    bool uniformLayout = true;
+    QVector<Vehicle> spotVehicles;  // 空车位为无效车牌
+};
+
+// WaitingQueueModel 类
+// 等待队列的只读列表模型，行数为队列容量，前 getQueueLength() 行有车。
+// 与 ParkingLotModel 相同，data() 只读界面线程上的队列副本。
+class WaitingQueueModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit WaitingQueueModel(const ParkingLot *parkingLot, QObject *parent = nullptr);
+    void setLotMutex(QMutex *mutex) { lotMutex = mutex; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void notifyQueueChanged();  // 队列内容整体前移，通知从队首到原长度/新长度中较大者
+    void resetQueue();
+
+private:
+    void reloadQueue();  // 调用方持有 lotMutex
+
+    const ParkingLot *parkingLot;
+    QMutex *lotMutex = nullptr;
+    int queueCapacity = 0;
+    QVector<Vehicle> queuedVehicles;  // 按放行顺序
+};
+
+#endif // PARKINGLOTMODEL_H
@@ -0,0 +1,223 @@
+#include "parkingservice.h"
+#include "lotstatefile.h"
+#include "platesearchindex.h"
+#include "stayhistory.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+// ParkingService 实现
+bool ParkingService::changesState(const ParkReply &reply) {
+    switch (reply.type) {
+    case ParkCommandType::Park:
+        return reply.status == ParkReplyStatus::Ok || reply.status == ParkReplyStatus::Queued;
+    case ParkCommandType::Release:
+    case ParkCommandType::Cancel:
+        return reply.status == ParkReplyStatus::Ok;
+    default:
+        return false;
+    }
+}
+
+void ParkingService::markNotDurable(QVector<ParkReply> &replies, const QString &error) {
+    for (ParkReply &reply : replies) {
+        if (!changesState(reply)) continue;
+        reply.status = ParkReplyStatus::StorageError;
+        reply.message = error;
+    }
+}
+
+void ParkingService::flushHistory() {
+    if (history) history->flush();
+}
+
+ParkReply ParkingService::execute(const ParkCommand &command) {
+    ParkReply reply;
+    reply.type = command.type;
+    const ParkingSpotManager &spotManager = parkingLot->getSpotManager();
+    qint64 now = parkingLot->getClock()->now();
+
+    if (command.type < ParkCommandType::Park || command.type > ParkCommandType::Export) {
+        reply.status = ParkReplyStatus::BadRequest;
+        return reply;
+    }
+    const bool needsPlate = command.type <= ParkCommandType::Cancel && command.type != ParkCommandType::About;
+    if (needsPlate && !command.plate.isValid()) {
+        reply.status = ParkReplyStatus::InvalidPlate;
+        return reply;
+    }
+    reply.vehicle = Vehicle(command.plate, 0, command.vehicleClass, command.priorityClass);  // 失败时也带上车牌
+
+    switch (command.type) {
+    case ParkCommandType::Park: {
+        reply.vehicle = Vehicle(command.plate, now, command.vehicleClass, command.priorityClass);
+        ParkingLot::ParkResult result = parkingLot->parkOrEnqueue(reply.vehicle);
+        reply.spot = result.spot;
+        switch (result.status) {
+        case ParkingLot::ParkStatus::Parked: reply.status = ParkReplyStatus::Ok; break;
+        case ParkingLot::ParkStatus::Queued: reply.status = ParkReplyStatus::Queued; break;
+        case ParkingLot::ParkStatus::Duplicate: reply.status = ParkReplyStatus::Duplicate; break;
+        case ParkingLot::ParkStatus::QueueFull: reply.status = ParkReplyStatus::QueueFull; break;
+        case ParkingLot::ParkStatus::InvalidPlate: reply.status = ParkReplyStatus::InvalidPlate; break;
+        case ParkingLot::ParkStatus::NoSuitableSpot: reply.status = ParkReplyStatus::NoSuitableSpot; break;
+        }
+        break;
+    }
+    case ParkCommandType::Release: {
+        int spot = spotManager.findSpot(command.plate);
+        if (spot < 0) {
+            reply.status = ParkReplyStatus::NotFound;
+            addSimilarPlates(reply);
+            break;
+        }
+        // 先按出库时刻计费，再移除车辆；空出的车位立即交给等待队列
+        reply.vehicle = *spotManager.getVehicleAt(spot);
+        reply.feeCents = tariff->price(reply.vehicle.getVehicleClass(), reply.vehicle.getEntryTime(), now);
+        reply.spot = parkingLot->releaseVehicle(command.plate, {now, reply.feeCents}).spot;  // 历史和统计按这笔费用记账
+        ParkingLot::SpotResult promoted = parkingLot->promoteNextVehicle();
+        reply.promotedSpot = promoted.spot;
+        if (promoted.spot >= 0) reply.promoted = promoted.vehicle;
+        break;
+    }
+    case ParkCommandType::Query: {
+        int spot = spotManager.findSpot(command.plate);
+        if (spot >= 0) {
+            reply.vehicle = *spotManager.getVehicleAt(spot);
+            reply.spot = spot;
+            reply.feeCents = tariff->price(reply.vehicle.getVehicleClass(), reply.vehicle.getEntryTime(), now);
+        } else {
+            reply.status = parkingLot->getQueueManager().hasVehicleInQueue(command.plate) ? ParkReplyStatus::Queued
+                                                                                        : ParkReplyStatus::NotFound;
+            if (reply.status == ParkReplyStatus::NotFound) addSimilarPlates(reply);
+        }
+        if (reply.status != ParkReplyStatus::Queued) addMonthlyVisits(reply, now);
+        break;
+    }
+    case ParkCommandType::About: {
+        const SpotAllocator &allocator = spotManager.getAllocator();
+        reply.zoneCount = allocator.getLayout().getZoneCount();
+        reply.policyName = allocator.getPolicy()->name();
+        break;
+    }
+    case ParkCommandType::Cancel:
+        if (!parkingLot->cancelQueuedVehicle(command.plate)) reply.status = ParkReplyStatus::NotFound;
+        break;
+    case ParkCommandType::Settle:
+        settle(reply, now);
+        break;
+    case ParkCommandType::History:
+        queryHistory(command.argument.trimmed(), reply, now);
+        break;
+    case ParkCommandType::Export:
+        exportState(command.argument.trimmed(), reply);
+        break;
+    }
+
+    reply.totalSpots = spotManager.getTotalSpots();
+    reply.freeSpots = spotManager.getFreeCount();
+    reply.queueCapacity = parkingLot->getQueueManager().getMaxCapacity();
+    reply.queueLength = parkingLot->getQueueManager().getQueueLength();
+    return reply;
+}
+
+void ParkingService::addMonthlyVisits(ParkReply &reply, qint64 now) const {
+    if (!history) return;
+    QDate today = QDateTime::fromMSecsSinceEpoch(now).date();
+    qint64 monthStart = QDateTime(QDate(today.year(), today.month(), 1), QTime(0, 0)).toMSecsSinceEpoch();
+    const QVector<StayRecord> stays = history->staysOf(reply.vehicle.getPlateKey(), monthStart, now + 1);
+    reply.monthlyVisits = stays.size();
+    for (const StayRecord &stay : stays) reply.lastExitTime = qMax(reply.lastExitTime, stay.exitTime);
+}
+
+void ParkingService::addSimilarPlates(ParkReply &reply) const {
+    if (!searchIndex) return;
+    for (const PlateSearchHit &hit : searchIndex->search(reply.vehicle.getLicensePlate(), 5)) {
+        if (hit.presence == PlatePresence::Parked) reply.similarPlates.append(hit.plate.toString());
+    }
+}
+
+void ParkingService::settle(ParkReply &reply, qint64 now) const {
+    QElapsedTimer timer;
+    timer.start();
+    reply.settlement = tariff->settleParked(parkingLot->getSpotManager(), now);
+    reply.elapsedMSecs = timer.elapsed();
+}
+
+void ParkingService::queryHistory(const QString &range, ParkReply &reply, qint64 now) const {
+    if (!history) {
+        reply.status = ParkReplyStatus::Failed;
+        reply.message = "没有停车历史记录";
+        return;
+    }
+
+    if (range.isEmpty()) {
+        const qint64 days = 30;
+        qint64 total = 0;
+        for (const DailyRevenue &day :
+             history->revenueByDay(now - days * 24 * 3600 * 1000, now + 1, tariff->getRules().utcOffsetMinutes)) {
+            reply.lines.append(QString("%1  %2 辆次  %3 元")
+                                   .arg(day.date.toString("yyyy-MM-dd"))
+                                   .arg(day.stays)
+                                   .arg(TariffEngine::formatCents(day.revenueCents)));
+            total += day.revenueCents;
+        }
+        reply.message = reply.lines.isEmpty() ? QString("最近 %1 天暂无出库记录").arg(days)
+                                              : QString("最近 %1 天营收合计 %2 元").arg(days).arg(TariffEngine::formatCents(total));
+        return;
+    }
+
+    const QString format = "yyyy-MM-dd hh:mm";
+    QStringList bounds = range.split('~');
+    QDateTime begin = bounds.size() == 2 ? QDateTime::fromString(bounds[0].trimmed(), format) : QDateTime();
+    QDateTime end = bounds.size() == 2 ? QDateTime::fromString(bounds[1].trimmed(), format) : QDateTime();
+    if (!begin.isValid() || !end.isValid() || begin >= end) {
+        reply.status = ParkReplyStatus::BadRequest;
+        reply.message = QString("时段格式不正确，应为 %1 ~ %1").arg(format);
+        return;
+    }
+    qint64 from = begin.toMSecsSinceEpoch();
+    qint64 to = end.toMSecsSinceEpoch();
+
+    // 已出库的记录来自历史库，仍在场的车辆只要在时段结束前入场也算在内；明细只保留前 kMaxReplyLines 行
+    int departed = 0;
+    int total = 0;
+    for (const StayRecord &stay : history->staysBetween(from, to)) {
+        ++departed;
+        if (++total > kMaxReplyLines) continue;
+        reply.lines.append(QString("%1  %2 号车位  %3 ~ %4  %5 元")
+                               .arg(stay.plate.toString())
+                               .arg(stay.spot + 1)
+                               .arg(formatTimestamp(stay.entryTime))
+                               .arg(formatTimestamp(stay.exitTime))
+                               .arg(TariffEngine::formatCents(stay.feeCents)));
+    }
+    parkingLot->getSpotManager().forEachParkedVehicle([&](int spot, const Vehicle &vehicle) {
+        if (vehicle.getEntryTime() >= to) return;
+        if (++total > kMaxReplyLines) return;
+        reply.lines.append(QString("%1  %2 号车位  %3 ~ （仍在场）")
+                               .arg(vehicle.getLicensePlate())
+                               .arg(spot + 1)
+                               .arg(formatTimestamp(vehicle.getEntryTime())));
+    });
+    if (total > kMaxReplyLines) reply.lines.append(QString("其余 %1 辆次未列出").arg(total - kMaxReplyLines));
+    reply.message = QString("%1 至 %2 在场过的车辆共 %3 辆次（其中已出库 %4 辆次）")
+                        .arg(begin.toString(format), end.toString(format))
+                        .arg(total)
+                        .arg(departed);
+}
+
+void ParkingService::exportState(const QString &path, ParkReply &reply) const {
+    // 扩展名为 .bin 时写紧凑的二进制格式；在工作线程上持锁执行，导出的是一致的快照
+    if (path.isEmpty()) {
+        reply.status = ParkReplyStatus::BadRequest;
+        reply.message = "请输入导出文件路径";
+        return;
+    }
+    QString error;
+    if (!LotStateFile::exportFile(*parkingLot, path, &error)) {
+        reply.status = ParkReplyStatus::Failed;
+        reply.message = error;
+        return;
+    }
+    reply.message = path;
+}
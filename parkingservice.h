@@ -0,0 +1,108 @@
+#ifndef PARKINGSERVICE_H
+#define PARKINGSERVICE_H
+
+#include <QStringList>
+#include <QVector>
+
+#include "parkinglot.h"
+#include "tariff.h"
+
+class PlateSearchIndex;
+class StayHistory;
+
+enum class ParkCommandType : quint8 {
+    Park = 1,   // 入库，没有合适车位时排队
+    Release,    // 出库并计费，空出的车位放行队首车辆
+    Query,      // 查询在场车辆和截至当前的费用
+    About,      // 车位和队列的容量与占用
+    Cancel,     // 排队车辆放弃排队
+    // 以下命令只在进程内使用，parkprotocol 不接受它们
+    Settle,     // 按当前时间对所有在场车辆计价，生成日结报表
+    History,    // 查询历史：argument 为时段时列出在场过的车辆，为空时汇总最近 30 天每日营收
+    Export      // 把在库车辆和等待队列导出到 argument 指定的文件
+};
+
+struct ParkCommand {
+    ParkCommandType type = ParkCommandType::About;
+    PlateKey plate;
+    VehicleClass vehicleClass = VehicleClass::Standard;
+    PriorityClass priorityClass = PriorityClass::Regular;
+    QString argument;   // History 的时段“yyyy-MM-dd hh:mm ~ yyyy-MM-dd hh:mm”，Export 的文件路径
+};
+
+enum class ParkReplyStatus : quint8 {
+    Ok,
+    Queued,           // 入库时进入等待队列，或查询的车辆正在排队
+    Duplicate,
+    QueueFull,
+    InvalidPlate,
+    NoSuitableSpot,
+    NotFound,
+    BadRequest,
+    StorageError,     // 已在内存中执行，但预写日志没能落盘，不能视为已确认
+    Failed            // 结算、历史或导出没能完成，原因见 message；保持为最后一个，park_load 按它确定状态数
+};
+
+struct ParkReply {
+    ParkCommandType type = ParkCommandType::About;
+    ParkReplyStatus status = ParkReplyStatus::Ok;
+    Vehicle vehicle;          // 入库、出库或查询到的车辆；未找到时只有请求中的车牌
+    int spot = -1;
+    qint64 feeCents = 0;      // 出库应付的费用，查询时为截至当前的费用
+    Vehicle promoted;         // 出库后从队列放行的车辆
+    int promotedSpot = -1;
+    // Query 时本月的到访记录，设置了历史记录才有
+    int monthlyVisits = 0;
+    qint64 lastExitTime = 0;
+    QStringList similarPlates;  // 出库或查询找不到车辆时相近的在场车牌，设置了车牌索引才有
+    // About
+    int totalSpots = 0;
+    int freeSpots = 0;
+    int queueCapacity = 0;
+    int queueLength = 0;
+    int zoneCount = 0;
+    QString policyName;
+    // Settle
+    SettlementReport settlement;
+    qint64 elapsedMSecs = 0;
+    // History 的明细行，最多 kMaxReplyLines 行
+    QStringList lines;
+    QString message;          // StorageError、Failed 时为错误原因；History 为汇总，Export 为写入的路径
+};
+
+// ParkingService 类
+// 入库、出库、查询、状态和取消排队操作的统一入口，规则与界面按钮一致，但不弹出任何对话框；
+// 无界面服务、批量命令等机器接口都通过它修改停车场。结算、历史和导出也在这里执行，
+// 界面只显示结果。与停车场在同一线程使用。
+// execute 只修改内存中的状态，调用方在应答前用 ParkingJournal::sync 等待落盘。
+class ParkingService {
+public:
+    static const int kMaxReplyLines = 500;
+
+    ParkingService(ParkingLot *parkingLot, const TariffEngine *tariff) : parkingLot(parkingLot), tariff(tariff) {}
+
+    void setHistory(StayHistory *history) { this->history = history; }  // 未设置时 History 返回 Failed
+    void setSearchIndex(const PlateSearchIndex *searchIndex) { this->searchIndex = searchIndex; }
+    ParkReply execute(const ParkCommand &command);
+    // 释放停车场的锁后调用，把 execute 期间出库记下的停车历史写盘
+    void flushHistory();
+
+    // 修改了停车场状态的应答，确认前必须等预写日志落盘
+    static bool changesState(const ParkReply &reply);
+    // 日志落盘失败时把修改了状态的应答改为 StorageError
+    static void markNotDurable(QVector<ParkReply> &replies, const QString &error);
+
+private:
+    void addMonthlyVisits(ParkReply &reply, qint64 now) const;
+    void addSimilarPlates(ParkReply &reply) const;
+    void settle(ParkReply &reply, qint64 now) const;
+    void queryHistory(const QString &range, ParkReply &reply, qint64 now) const;
+    void exportState(const QString &path, ParkReply &reply) const;
+
+    ParkingLot *parkingLot;
+    const TariffEngine *tariff;
+    StayHistory *history = nullptr;
+    const PlateSearchIndex *searchIndex = nullptr;
+};
+
+#endif // PARKINGSERVICE_H
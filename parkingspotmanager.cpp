@@ -0,0 +1,124 @@
+#include "parkingspotmanager.h"
+
+// ParkingSpotManager 实现
+ParkingSpotManager::ParkingSpotManager(int totalSpots) : ParkingSpotManager(SpotLayout::uniform(totalSpots)) {}
+
+ParkingSpotManager::ParkingSpotManager(const SpotLayout &layout)
+    : totalSpots(layout.getTotalSpots()), slotOfSpot(totalSpots, -1), allocator(layout) {
+    parkedPlates.reserve(totalSpots);
+    parkedEntryTimes.reserve(totalSpots);
+    parkedVehicleClasses.reserve(totalSpots);
+    parkedPriorityClasses.reserve(totalSpots);
+    parkedSpots.reserve(totalSpots);
+    spotIndex.reserve(totalSpots);
+}
+
+void ParkingSpotManager::placeVehicle(const Vehicle &vehicle, int spot) {
+    slotOfSpot[spot] = parkedSpots.size();
+    parkedPlates.append(vehicle.getPlateKey());
+    parkedEntryTimes.append(vehicle.getEntryTime());
+    parkedVehicleClasses.append(quint8(vehicle.getVehicleClass()));
+    parkedPriorityClasses.append(quint8(vehicle.getPriorityClass()));
+    parkedSpots.append(spot);
+    spotIndex.insert(vehicle.getPlateKey(), spot);
+}
+
+int ParkingSpotManager::parkVehicle(const Vehicle &vehicle) {
+    int spot = allocator.allocate(vehicle);
+    if (spot < 0) {
+        return -1;
+    }
+    placeVehicle(vehicle, spot);
+    return spot;
+}
+
+bool ParkingSpotManager::parkVehicleAt(const Vehicle &vehicle, int spot) {
+    if (spot < 0 || spot >= totalSpots || slotOfSpot[spot] >= 0 || !allocator.take(spot)) {
+        return false;
+    }
+    placeVehicle(vehicle, spot);
+    return true;
+}
+
+int ParkingSpotManager::removeVehicle(const PlateKey &plate) {
+    auto it = spotIndex.find(plate);
+    if (it == spotIndex.end()) {
+        return -1;
+    }
+    int spot = it.value();
+    spotIndex.erase(it);
+
+    // 用最后一辆车填补腾出的下标，保持结构数组紧凑
+    int slot = slotOfSpot[spot];
+    int lastSlot = parkedSpots.size() - 1;
+    if (slot != lastSlot) {
+        parkedPlates[slot] = parkedPlates[lastSlot];
+        parkedEntryTimes[slot] = parkedEntryTimes[lastSlot];
+        parkedVehicleClasses[slot] = parkedVehicleClasses[lastSlot];
+        parkedPriorityClasses[slot] = parkedPriorityClasses[lastSlot];
+        parkedSpots[slot] = parkedSpots[lastSlot];
+        slotOfSpot[parkedSpots[slot]] = slot;
+    }
+    parkedPlates.removeLast();
+    parkedEntryTimes.removeLast();
+    parkedVehicleClasses.removeLast();
+    parkedPriorityClasses.removeLast();
+    parkedSpots.removeLast();
+
+    slotOfSpot[spot] = -1;
+    allocator.release(spot);
+    return spot;
+}
+
+bool ParkingSpotManager::isFull() const {
+    return allocator.getFreeCount() == 0;
+}
+
+bool ParkingSpotManager::canPark(const Vehicle &vehicle) const {
+    return allocator.canAllocate(vehicle);
+}
+
+bool ParkingSpotManager::fits(const Vehicle &vehicle) const {
+    return allocator.fits(vehicle);
+}
+
+bool ParkingSpotManager::setLayout(const SpotLayout &layout) {
+    if (layout.getTotalSpots() != totalSpots) {
+        return false;
+    }
+    SpotAllocator rebuilt(layout);
+    rebuilt.setPolicy(allocator.getPolicy());
+    for (int spot : parkedSpots) {
+        rebuilt.take(spot);
+    }
+    allocator = rebuilt;
+    return true;
+}
+
+void ParkingSpotManager::setAllocationPolicy(std::shared_ptr<const SpotAllocationPolicy> policy) {
+    allocator.setPolicy(std::move(policy));
+}
+
+bool ParkingSpotManager::hasVehicle(const PlateKey &plate) const {
+    return spotIndex.contains(plate);
+}
+
+int ParkingSpotManager::findSpot(const PlateKey &plate) const {
+    return spotIndex.value(plate, -1);
+}
+
+bool ParkingSpotManager::isSpotOccupied(int spot) const {
+    return spot >= 0 && spot < totalSpots && slotOfSpot[spot] >= 0;
+}
+
+Vehicle ParkingSpotManager::vehicleAtSlot(int slot) const {
+    return Vehicle(parkedPlates[slot], parkedEntryTimes[slot], VehicleClass(parkedVehicleClasses[slot]),
+                   PriorityClass(parkedPriorityClasses[slot]));
+}
+
+std::optional<Vehicle> ParkingSpotManager::getVehicleAt(int spot) const {
+    if (!isSpotOccupied(spot)) {
+        return std::nullopt;
+    }
+    return vehicleAtSlot(slotOfSpot[spot]);
+}
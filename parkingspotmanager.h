@@ -0,0 +1,69 @@
+#ifndef PARKINGSPOTMANAGER_H
+#define PARKINGSPOTMANAGER_H
+
+#include <QHash>
+#include <QVector>
+
+#include <optional>
+
+#include "spotallocator.h"
+#include "vehicle.h"
+
+// ParkingSpotManager 类
+// 在库车辆按结构数组（SoA）紧凑存放：车牌键、入场时间、车型、优先级和车位号各占一个连续数组，
+// 下标 0 ~ getParkedCount()-1，出库时用最后一辆车填补空位；扫描和批量计费只需顺序读取这些数组。
+// 车牌到车位号通过哈希索引，查找和出库都是 O(1)；空闲车位由 SpotAllocator 按布局和分配策略挑选，
+// 入库 O(log n)。车辆在停留期间始终保持同一个车位号。
+class ParkingSpotManager {
+public:
+    ParkingSpotManager(int totalSpots);               // 不区分车位的布局
+    explicit ParkingSpotManager(const SpotLayout &layout);
+    int parkVehicle(const Vehicle &vehicle);          // 返回分配到的车位号，没有合适的空车位时返回 -1
+    bool parkVehicleAt(const Vehicle &vehicle, int spot);  // 停入指定车位（恢复状态用），车位被占时返回 false
+    int removeVehicle(const PlateKey &plate);         // 返回腾出的车位号，未找到时返回 -1
+    bool isFull() const;
+    bool canPark(const Vehicle &vehicle) const;       // 现在有适合该车的空车位
+    bool fits(const Vehicle &vehicle) const;          // 布局中存在适合该车的车位
+
+    // 更换布局时车位数必须不变，在库车辆留在原车位；策略为 nullptr 时忽略
+    bool setLayout(const SpotLayout &layout);
+    void setAllocationPolicy(std::shared_ptr<const SpotAllocationPolicy> policy);
+    const SpotAllocator &getAllocator() const { return allocator; }
+    bool hasVehicle(const PlateKey &plate) const;
+    int findSpot(const PlateKey &plate) const;        // 未找到时返回 -1
+    bool isSpotOccupied(int spot) const;
+    std::optional<Vehicle> getVehicleAt(int spot) const;  // 空车位返回 std::nullopt
+    int getTotalSpots() const { return totalSpots; }
+    int getParkedCount() const { return parkedSpots.size(); }
+    int getFreeCount() const { return allocator.getFreeCount(); }
+
+    // 在库车辆的结构数组，长度均为 getParkedCount()，顺序随出入库变化
+    const PlateKey *getParkedPlates() const { return parkedPlates.constData(); }
+    const qint64 *getParkedEntryTimes() const { return parkedEntryTimes.constData(); }
+    const quint8 *getParkedVehicleClasses() const { return parkedVehicleClasses.constData(); }
+    const int *getParkedSpots() const { return parkedSpots.constData(); }
+
+    // 访问所有在库车辆，visit(int spot, const Vehicle &vehicle)，顺序同结构数组
+    template <typename Visitor>
+    void forEachParkedVehicle(Visitor &&visit) const {
+        for (int i = 0; i < parkedSpots.size(); ++i) {
+            visit(parkedSpots[i], vehicleAtSlot(i));
+        }
+    }
+
+private:
+    Vehicle vehicleAtSlot(int slot) const;
+    void placeVehicle(const Vehicle &vehicle, int spot);
+
+    int totalSpots;
+    QVector<PlateKey> parkedPlates;
+    QVector<qint64> parkedEntryTimes;
+    QVector<quint8> parkedVehicleClasses;
+    QVector<quint8> parkedPriorityClasses;
+    QVector<int> parkedSpots;
+    QVector<int> slotOfSpot;         // 车位号 -> 结构数组下标，空车位为 -1
+    SpotAllocator allocator;
+    QHash<PlateKey, int> spotIndex;  // 车牌 -> 车位号
+};
+
+#endif // PARKINGSPOTMANAGER_H
@@ -0,0 +1,197 @@
+#include "parkprotocol.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+const int kHeaderBytes = 5;  // 操作 + 请求号
+
+template <typename T>
+void put(QByteArray &out, T value) {
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// 按顺序读取定长字段，越界后所有读取都返回 0 并记为失败
+class Reader {
+public:
+    Reader(const char *data, int length) : data(data), end(data + length) {}
+
+    template <typename T>
+    T get() {
+        if (end - data < int(sizeof(T))) {
+            ok = false;
+            return T(0);
+        }
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+        data += sizeof(value);
+        return qFromLittleEndian(value);
+    }
+
+    const char *take(int length) {
+        if (length < 0 || end - data < length) {
+            ok = false;
+            return nullptr;
+        }
+        const char *result = data;
+        data += length;
+        return result;
+    }
+
+    bool ok = true;
+
+private:
+    const char *data;
+    const char *end;
+};
+
+} // namespace
+
+// ParkProtocol 实现
+void ParkProtocol::appendRequest(QByteArray &out, quint32 requestId, const ParkCommand &command) {
+    appendRequest(out, requestId, command.type, command.plate.toString().toUtf8(), command.vehicleClass,
+                  command.priorityClass);
+}
+
+void ParkProtocol::appendRequest(QByteArray &out, quint32 requestId, ParkCommandType type, const QByteArray &plateUtf8,
+                                 VehicleClass vehicleClass, PriorityClass priorityClass) {
+    QByteArray plate = plateUtf8.left(kMaxPlateBytes);
+    bool hasPlate = type != ParkCommandType::About;
+    quint32 length = kHeaderBytes + (hasPlate ? 1 + plate.size() : 0) + (type == ParkCommandType::Park ? 2 : 0);
+    put<quint32>(out, length);
+    put<quint8>(out, quint8(type));
+    put<quint32>(out, requestId);
+    if (hasPlate) {
+        put<quint8>(out, quint8(plate.size()));
+        out.append(plate);
+    }
+    if (type == ParkCommandType::Park) {
+        put<quint8>(out, quint8(vehicleClass));
+        put<quint8>(out, quint8(priorityClass));
+    }
+}
+
+void ParkProtocol::appendReply(QByteArray &out, quint32 requestId, const ParkReply &reply) {
+    bool hasResult = reply.status != ParkReplyStatus::BadRequest;
+    int resultBytes = 0;
+    if (hasResult) {
+        switch (reply.type) {
+        case ParkCommandType::Park: resultBytes = 4; break;
+        case ParkCommandType::Release: resultBytes = 16; break;
+        case ParkCommandType::Query: resultBytes = 20; break;
+        case ParkCommandType::About: resultBytes = 16; break;
+        case ParkCommandType::Cancel:
+        case ParkCommandType::Settle:
+        case ParkCommandType::History:
+        case ParkCommandType::Export: break;  // 后三种只在进程内使用，不会出现在线路上
+        }
+    }
+    put<quint32>(out, quint32(kHeaderBytes + 1 + resultBytes));
+    put<quint8>(out, quint8(reply.type));
+    put<quint32>(out, requestId);
+    put<quint8>(out, quint8(reply.status));
+    if (!hasResult) return;
+
+    switch (reply.type) {
+    case ParkCommandType::Park:
+        put<qint32>(out, reply.spot);
+        break;
+    case ParkCommandType::Release:
+        put<qint32>(out, reply.spot);
+        put<qint64>(out, reply.feeCents);
+        put<qint32>(out, reply.promotedSpot);
+        break;
+    case ParkCommandType::Query:
+        put<qint32>(out, reply.spot);
+        put<qint64>(out, reply.vehicle.getEntryTime());
+        put<qint64>(out, reply.feeCents);
+        break;
+    case ParkCommandType::About:
+        put<qint32>(out, reply.totalSpots);
+        put<qint32>(out, reply.freeSpots);
+        put<qint32>(out, reply.queueCapacity);
+        put<qint32>(out, reply.queueLength);
+        break;
+    case ParkCommandType::Cancel:
+    case ParkCommandType::Settle:
+    case ParkCommandType::History:
+    case ParkCommandType::Export:
+        break;
+    }
+}
+
+ParkProtocol::FrameResult ParkProtocol::readFrame(const QByteArray &buffer, int *offset, const char **payload,
+                                                  int *length) {
+    int available = buffer.size() - *offset;
+    if (available < 4) return FrameResult::Incomplete;
+    quint32 frameLength = qFromLittleEndian<quint32>(buffer.constData() + *offset);
+    if (frameLength < quint32(kHeaderBytes) || frameLength > quint32(kMaxFrameBytes)) return FrameResult::Invalid;
+    if (available - 4 < int(frameLength)) return FrameResult::Incomplete;
+    *payload = buffer.constData() + *offset + 4;
+    *length = int(frameLength);
+    *offset += 4 + int(frameLength);
+    return FrameResult::Complete;
+}
+
+bool ParkProtocol::decodeRequest(const char *payload, int length, quint32 *requestId, ParkCommand *command) {
+    Reader reader(payload, length);
+    *command = ParkCommand();
+    command->type = ParkCommandType(reader.get<quint8>());
+    *requestId = reader.get<quint32>();
+    if (command->type == ParkCommandType::About) return reader.ok;
+    if (command->type < ParkCommandType::Park || command->type > ParkCommandType::Cancel) return false;
+
+    int plateLength = reader.get<quint8>();
+    const char *plate = reader.take(plateLength);
+    if (!reader.ok) return false;
+    command->plate = PlateKey(QString::fromUtf8(plate, plateLength));
+    if (command->type == ParkCommandType::Park) {
+        quint8 vehicleClass = reader.get<quint8>();
+        quint8 priorityClass = reader.get<quint8>();
+        if (!reader.ok || vehicleClass >= kVehicleClassCount || priorityClass >= kPriorityClassCount) return false;
+        command->vehicleClass = VehicleClass(vehicleClass);
+        command->priorityClass = PriorityClass(priorityClass);
+    }
+    return true;
+}
+
+bool ParkProtocol::decodeReply(const char *payload, int length, quint32 *requestId, ParkReply *reply) {
+    Reader reader(payload, length);
+    *reply = ParkReply();
+    reply->type = ParkCommandType(reader.get<quint8>());
+    *requestId = reader.get<quint32>();
+    reply->status = ParkReplyStatus(reader.get<quint8>());
+    if (!reader.ok || reply->status == ParkReplyStatus::BadRequest) return reader.ok;
+
+    switch (reply->type) {
+    case ParkCommandType::Park:
+        reply->spot = reader.get<qint32>();
+        break;
+    case ParkCommandType::Release:
+        reply->spot = reader.get<qint32>();
+        reply->feeCents = reader.get<qint64>();
+        reply->promotedSpot = reader.get<qint32>();
+        break;
+    case ParkCommandType::Query: {
+        reply->spot = reader.get<qint32>();
+        qint64 entryTime = reader.get<qint64>();
+        reply->feeCents = reader.get<qint64>();
+        reply->vehicle = Vehicle(PlateKey(), entryTime);
+        break;
+    }
+    case ParkCommandType::About:
+        reply->totalSpots = reader.get<qint32>();
+        reply->freeSpots = reader.get<qint32>();
+        reply->queueCapacity = reader.get<qint32>();
+        reply->queueLength = reader.get<qint32>();
+        break;
+    case ParkCommandType::Cancel:
+        break;
+    default:
+        return false;
+    }
+    return reader.ok;
+}
@@ -0,0 +1,40 @@
+#ifndef PARKPROTOCOL_H
+#define PARKPROTOCOL_H
+
+#include <QByteArray>
+
+#include "parkingservice.h"
+
+// ParkProtocol 类
+// 道闸控制器、缴费机与无界面服务之间的二进制协议，整数均为小端。每帧为
+//   u32 长度（不含自身） + u8 操作 + u32 请求号 + 参数
+// 请求参数：入库为 u8 车牌字节数 + UTF-8 车牌 + u8 车型 + u8 排队类别；出库、查询、取消排队为车牌；状态没有参数。
+// 应答帧的操作和请求号与请求相同，随后是 u8 ParkReplyStatus 和按操作区分的定长结果：
+//   入库 i32 车位；出库 i32 车位 + i64 费用（分）+ i32 放行车位；
+//   查询 i32 车位 + i64 入场时间 + i64 费用；状态 i32 车位数 + i32 空车位 + i32 队列容量 + i32 排队数；
+//   取消排队没有结果字段。结算、历史和导出只供界面使用，不是合法的请求操作。
+// 客户端可以不等应答连续发送多个请求（流水线），服务端按请求顺序应答，
+// 同一次读到的请求的应答合并成一次写入。
+class ParkProtocol {
+public:
+    static const int kMaxFrameBytes = 1024;
+    static const int kMaxPlateBytes = 64;
+
+    enum class FrameResult { Complete, Incomplete, Invalid };
+
+    static void appendRequest(QByteArray &out, quint32 requestId, const ParkCommand &command);
+    static void appendRequest(QByteArray &out, quint32 requestId, ParkCommandType type, const QByteArray &plateUtf8,
+                              VehicleClass vehicleClass = VehicleClass::Standard,
+                              PriorityClass priorityClass = PriorityClass::Regular);
+    static void appendReply(QByteArray &out, quint32 requestId, const ParkReply &reply);
+
+    // 从 buffer 的 *offset 处取出一帧；Complete 时 payload 指向帧内容并前移 *offset，
+    // 长度越界的帧为 Invalid，此时应断开连接
+    static FrameResult readFrame(const QByteArray &buffer, int *offset, const char **payload, int *length);
+
+    // 请求号总能取出；参数不完整或车型越界时返回 false，服务端应答 BadRequest
+    static bool decodeRequest(const char *payload, int length, quint32 *requestId, ParkCommand *command);
+    static bool decodeReply(const char *payload, int length, quint32 *requestId, ParkReply *reply);
+};
+
+#endif // PARKPROTOCOL_H
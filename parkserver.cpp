@@ -0,0 +1,183 @@
+#include "parkserver.h"
+#include "parkprotocol.h"
+#include "parkingjournal.h"
+#include "tracing.h"
+
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+const qint64 kMaxPendingReplyBytes = 1 << 20;  // 单个连接积压的应答超过 1 MiB 时暂停读取
+const qint64 kReadBufferBytes = 256 * 1024;    // 套接字读缓冲区上限，暂停读取后由内核缓冲区向客户端施加背压
+const int kMaxHeldReplies = 65536;             // 单个连接等待落盘的应答超过该数时暂停读取
+}
+
+// ParkServer 实现
+ParkServer::ParkServer(ParkingService *service, QObject *parent) : QObject(parent), service(service) {}
+
+void ParkServer::setJournal(ParkingJournal *journal) {
+    if (this->journal) this->journal->setCommitCallback(nullptr);
+    this->journal = journal;
+    if (journal) {
+        // 回调在日志写盘线程上，只把处理排队到本对象所在的线程
+        journal->setCommitCallback([this]() { QMetaObject::invokeMethod(this, "releaseDurable", Qt::QueuedConnection); });
+    }
+    releaseDurable();
+}
+
+bool ParkServer::listenLocal(const QString &name, QString *error) {
+    if (!localServer) {
+        localServer = new QLocalServer(this);
+        connect(localServer, &QLocalServer::newConnection, this, &ParkServer::acceptLocal);
+    }
+    // 同名套接字能连上说明另一个实例正在服务，两个实例会同时写同一份日志，拒绝启动
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(500)) {
+        probe.disconnectFromServer();
+        if (error) *error = QString("本地套接字 %1 上已有服务在运行").arg(name);
+        return false;
+    }
+    // 连不上时是上次异常退出留下的套接字文件
+    QLocalServer::removeServer(name);
+    if (!localServer->listen(name)) {
+        if (error) *error = QString("无法监听本地套接字 %1：%2").arg(name, localServer->errorString());
+        return false;
+    }
+    return true;
+}
+
+bool ParkServer::listenTcp(quint16 port, QString *error) {
+    if (!tcpServer) {
+        tcpServer = new QTcpServer(this);
+        connect(tcpServer, &QTcpServer::newConnection, this, &ParkServer::acceptTcp);
+    }
+    if (!tcpServer->listen(QHostAddress::LocalHost, port)) {
+        if (error) *error = QString("无法监听 TCP 端口 %1：%2").arg(port).arg(tcpServer->errorString());
+        return false;
+    }
+    return true;
+}
+
+void ParkServer::acceptLocal() {
+    while (QLocalSocket *socket = localServer->nextPendingConnection()) {
+        socket->setReadBufferSize(kReadBufferBytes);
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { removeConnection(socket); });
+        addConnection(socket);
+    }
+}
+
+void ParkServer::acceptTcp() {
+    while (QTcpSocket *socket = tcpServer->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);  // 应答已按批合并，不再等 Nagle
+        socket->setReadBufferSize(kReadBufferBytes);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { removeConnection(socket); });
+        addConnection(socket);
+    }
+}
+
+void ParkServer::addConnection(QIODevice *socket) {
+    buffers.insert(socket, QByteArray());
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() { serve(socket); });
+    // 积压的应答写出后继续处理暂停期间收到的请求
+    connect(socket, &QIODevice::bytesWritten, this, [this, socket]() {
+        if (socket->bytesToWrite() <= kMaxPendingReplyBytes && socket->bytesAvailable() > 0) serve(socket);
+    });
+    if (socket->bytesAvailable() > 0) serve(socket);
+}
+
+void ParkServer::removeConnection(QIODevice *socket) {
+    // 挂起的批次只持有 QPointer，落盘后发现连接已关闭就丢弃应答
+    heldReplies.remove(socket);
+    if (buffers.remove(socket) > 0) socket->deleteLater();
+}
+
+void ParkServer::serve(QIODevice *socket) {
+    auto it = buffers.find(socket);
+    if (it == buffers.end()) return;
+    // 客户端没有读应答，或等待落盘的应答太多，等 bytesWritten
+    if (socket->bytesToWrite() > kMaxPendingReplyBytes || heldReplies.value(socket) > kMaxHeldReplies) return;
+    PARK_TRACE_SCOPE(ServerBatch);
+
+    QByteArray &buffer = it.value();
+    buffer.append(socket->readAll());
+    HeldBatch batch{socket, 0, {}, {}, false};
+    bool changesState = false;
+    int offset = 0;
+    const char *payload;
+    int length;
+    ParkProtocol::FrameResult result;
+    while ((result = ParkProtocol::readFrame(buffer, &offset, &payload, &length)) == ParkProtocol::FrameResult::Complete) {
+        quint32 requestId;
+        ParkCommand command;
+        ParkReply reply;
+        if (ParkProtocol::decodeRequest(payload, length, &requestId, &command)) {
+            reply = service->execute(command);
+            changesState = changesState || ParkingService::changesState(reply);
+        } else {
+            reply.type = command.type;
+            reply.status = ParkReplyStatus::BadRequest;
+        }
+        batch.requestIds.append(requestId);
+        batch.replies.append(reply);
+    }
+    buffer.remove(0, offset);
+    batch.closeAfter = result == ParkProtocol::FrameResult::Invalid;
+    if (batch.closeAfter) buffer.clear();
+    if (batch.replies.isEmpty() && !batch.closeAfter) return;
+
+    // 道闸只在操作落盘后才收到确认，崩溃重启后不会丢失已应答的入库或出库。
+    // 不在这里等待 fsync：修改了状态的批次挂起，前面还有挂起批次时只读的批次也排在后面
+    if (journal && changesState) batch.sequence = journal->getLastSequence();
+    if (batch.sequence == 0 && held.isEmpty()) {
+        writeReplies(batch);
+        return;
+    }
+    heldReplies[socket] += batch.replies.size();
+    held.enqueue(batch);
+    releaseDurable();  // 日志可能已经写完
+}
+
+void ParkServer::releaseDurable() {
+    qint64 durable = journal ? journal->getDurableSequence() : 0;
+    QString error = journal ? journal->getError() : QString();
+    while (!held.isEmpty()) {
+        HeldBatch &batch = held.head();
+        if (batch.sequence > durable) {
+            if (error.isEmpty()) break;
+            ParkingService::markNotDurable(batch.replies, error);
+        }
+        HeldBatch ready = held.dequeue();
+        if (ready.socket) {
+            auto count = heldReplies.find(ready.socket);
+            if (count != heldReplies.end() && (count.value() -= ready.replies.size()) <= 0) heldReplies.erase(count);
+        }
+        writeReplies(ready);
+    }
+}
+
+void ParkServer::writeReplies(HeldBatch &batch) {
+    QIODevice *socket = batch.socket;
+    if (!socket || !buffers.contains(socket)) return;  // 等待落盘期间连接已关闭
+
+    replies.clear();
+    for (int i = 0; i < batch.replies.size(); ++i) {
+        ParkProtocol::appendReply(replies, batch.requestIds[i], batch.replies[i]);
+    }
+    if (!replies.isEmpty()) socket->write(replies);
+    if (!batch.replies.isEmpty()) {
+        requests += batch.replies.size();
+        emit requestsServed(batch.replies.size());
+    }
+    if (batch.closeAfter) {
+        // 帧边界已经无法确定，应答已处理的部分后断开
+        if (QLocalSocket *local = qobject_cast<QLocalSocket *>(socket)) {
+            local->disconnectFromServer();
+        } else if (QTcpSocket *tcp = qobject_cast<QTcpSocket *>(socket)) {
+            tcp->disconnectFromHost();
+        }
+    }
+}
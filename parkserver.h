@@ -0,0 +1,74 @@
+#ifndef PARKSERVER_H
+#define PARKSERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+#include "parkingservice.h"
+
+class ParkingJournal;
+class QLocalServer;
+class QTcpServer;
+
+// ParkServer 类
+// 在本地套接字（QLocalServer）和只监听 127.0.0.1 的 TCP 端口上提供 ParkProtocol 服务。
+// 全部在所属线程的事件循环中处理：每次可读时解析出所有完整的请求帧，依次交给 ParkingService 执行，
+// 应答合并成一次写入，因此客户端可以流水线发送而不必逐条等待。收到越界的帧时断开该连接。
+// 设置了预写日志时，修改了状态的一批请求先挂起应答，由日志写盘线程成组 fsync 后通知事件循环再写出，
+// 等待落盘期间照常处理其他连接；失败的修改以 StorageError 应答。挂起的批次按提交顺序写出，
+// 同一连接上的应答顺序不变。
+// 客户端只发不收、应答积压或等待落盘的应答超过上限时暂停读取该连接，等应答写出后再继续，内存占用有上界。
+class ParkServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ParkServer(ParkingService *service, QObject *parent = nullptr);
+
+    void setJournal(ParkingJournal *journal);  // 传入空指针时解除与原日志的关联，日志销毁前调用
+    // 同名套接字上已有服务在监听时返回 false；连不上时才视为上次异常退出留下的文件并删除
+    bool listenLocal(const QString &name, QString *error = nullptr);
+    bool listenTcp(quint16 port, QString *error = nullptr);
+
+    int connectionCount() const { return buffers.size(); }
+    qint64 requestCount() const { return requests; }
+
+signals:
+    void requestsServed(int count);  // 每批应答写出时发出一次
+
+private slots:
+    void acceptLocal();
+    void acceptTcp();
+    void releaseDurable();  // 写出已落盘（或日志出错）的挂起批次
+
+private:
+    struct HeldBatch {
+        QPointer<QIODevice> socket;
+        qint64 sequence;              // 应答前日志要落盘到的序号，0 表示不需要等待，只为保持顺序
+        QVector<quint32> requestIds;
+        QVector<ParkReply> replies;
+        bool closeAfter;              // 收到越界的帧，应答写出后断开
+    };
+
+    void addConnection(QIODevice *socket);
+    void removeConnection(QIODevice *socket);
+    void serve(QIODevice *socket);
+    void writeReplies(HeldBatch &batch);
+
+    ParkingService *service;
+    ParkingJournal *journal = nullptr;
+    QLocalServer *localServer = nullptr;
+    QTcpServer *tcpServer = nullptr;
+    QHash<QIODevice *, QByteArray> buffers;  // 各连接尚未凑成整帧的字节
+    QQueue<HeldBatch> held;                  // 等待落盘的批次，按提交顺序
+    QHash<QIODevice *, int> heldReplies;     // 各连接挂起的应答数
+    QByteArray replies;                      // 复用的应答缓冲区
+    qint64 requests = 0;
+};
+
+#endif // PARKSERVER_H
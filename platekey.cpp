@@ -0,0 +1,50 @@
+#include "platekey.h"
+
+// PlateKey 实现
+PlateKey::PlateKey(const QString &licensePlate) {
+    int length = 0;
+    for (QChar ch : licensePlate) {
+        ushort unit = ch.unicode();
+        if (unit == 0 || ch.isSpace() || unit == '-' || unit == 0x00B7 || unit == 0x30FB || unit == 0x2022) {
+            continue;  // 空格、连字符和各种间隔点
+        }
+        if (unit >= 0xFF01 && unit <= 0xFF5E) {
+            unit = ushort(unit - 0xFF01 + 0x21);  // 全角转半角
+        }
+        if (unit >= 'a' && unit <= 'z') {
+            unit = ushort(unit - 'a' + 'A');
+        }
+        if (length == kMaxLength) {
+            words[0] = words[1] = 0;  // 超长，视为无效
+            return;
+        }
+        words[length / 4] |= quint64(unit) << ((length % 4) * 16);
+        ++length;
+    }
+}
+
+PlateKey PlateKey::fromWords(quint64 low, quint64 high) {
+    PlateKey key;
+    key.words[0] = low;
+    key.words[1] = high;
+    return key;
+}
+
+int PlateKey::length() const {
+    int length = 0;
+    while (length < kMaxLength && ((words[length / 4] >> ((length % 4) * 16)) & 0xFFFF) != 0) {
+        ++length;
+    }
+    return length;
+}
+
+QString PlateKey::toString() const {
+    QChar units[kMaxLength];
+    int length = 0;
+    for (; length < kMaxLength; ++length) {
+        ushort unit = ushort(words[length / 4] >> ((length % 4) * 16));
+        if (unit == 0) break;
+        units[length] = QChar(unit);
+    }
+    return QString(units, length);
+}
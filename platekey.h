@@ -0,0 +1,47 @@
+#ifndef PLATEKEY_H
+#define PLATEKEY_H
+
+#include <QString>
+#include <QtGlobal>
+
+// PlateKey 类
+// 规范化后的车牌号，最多 8 个 UTF-16 字符，直接打包在两个 64 位整数里：
+// 不分配堆内存，比较和哈希只需几条整数指令。规范化会去掉空格、连字符和间隔点，
+// 全角字母数字转为半角，小写字母转为大写。为空或超长的车牌得到无效键。
+class PlateKey {
+public:
+    static const int kMaxLength = 8;
+
+    PlateKey() = default;  // 无效键
+    explicit PlateKey(const QString &licensePlate);
+    static PlateKey fromWords(quint64 low, quint64 high);  // 由 word(0)/word(1) 还原，用于读取持久化数据
+
+    bool isValid() const { return words[0] != 0; }
+    int length() const;
+    QString toString() const;
+    quint64 word(int i) const { return words[i]; }
+
+    bool operator==(const PlateKey &other) const { return words[0] == other.words[0] && words[1] == other.words[1]; }
+    bool operator!=(const PlateKey &other) const { return !(*this == other); }
+    bool operator<(const PlateKey &other) const {
+        return words[0] != other.words[0] ? words[0] < other.words[0] : words[1] < other.words[1];
+    }
+
+private:
+    quint64 words[2] = {0, 0};  // 第 i 个字符位于 words[i / 4] 的第 (i % 4) * 16 位
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+using PlateKeyHash = size_t;
+#else
+using PlateKeyHash = uint;
+#endif
+
+inline PlateKeyHash qHash(const PlateKey &key, PlateKeyHash seed = 0) noexcept {
+    quint64 hash = (key.word(0) ^ seed) * 0x9E3779B97F4A7C15ULL;
+    hash ^= key.word(1) + 0x7F4A7C159E3779B9ULL + (hash << 6) + (hash >> 2);
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    return PlateKeyHash(hash ^ (hash >> 31));
+}
+
+#endif // PLATEKEY_H
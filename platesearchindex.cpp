@@ -0,0 +1,277 @@
+#include "platesearchindex.h"
+#include "tracing.h"
+
+#include <algorithm>
+
+namespace {
+
+const int kCompactThreshold = 4096;
+
+// 车牌识别常见的误读：同一组字符折叠成一个
+ushort foldUnit(ushort unit) {
+    switch (unit) {
+    case 'O': case 'Q': case 'D': return '0';
+    case 'I': case 'L': return '1';
+    case 'Z': return '2';
+    case 'S': return '5';
+    case 'B': return '8';
+    default: return unit;
+    }
+}
+
+int foldedUnits(const PlateKey &plate, ushort *units) {
+    int length = 0;
+    for (; length < PlateKey::kMaxLength; ++length) {
+        ushort unit = ushort(plate.word(length / 4) >> ((length % 4) * 16));
+        if (unit == 0) break;
+        units[length] = foldUnit(unit);
+    }
+    return length;
+}
+
+// 最多 3 个字符打包成一个键，高位记录长度以区分二元组和三元组
+quint64 gramKey(const ushort *units, int length) {
+    quint64 key = quint64(length) << 48;
+    for (int i = 0; i < length; ++i) {
+        key |= quint64(units[i]) << (i * 16);
+    }
+    return key;
+}
+
+int findUnits(const ushort *text, int textLength, const ushort *pattern, int patternLength) {
+    for (int at = 0; at + patternLength <= textLength; ++at) {
+        if (std::equal(pattern, pattern + patternLength, text + at)) return at;
+    }
+    return -1;
+}
+
+// a、b 之间最多相差一次插入、删除或替换
+bool withinOneEdit(const ushort *a, int aLength, const ushort *b, int bLength) {
+    if (aLength > bLength) {
+        std::swap(a, b);
+        std::swap(aLength, bLength);
+    }
+    if (bLength - aLength > 1) return false;
+    int i = 0;
+    while (i < aLength && a[i] == b[i]) ++i;
+    if (i == aLength) return true;
+    if (aLength == bLength) return std::equal(a + i + 1, a + aLength, b + i + 1);
+    return std::equal(a + i, a + aLength, b + i + 1);
+}
+
+} // namespace
+
+QString platePresenceName(PlatePresence presence) {
+    switch (presence) {
+    case PlatePresence::Parked: return "在场";
+    case PlatePresence::Queued: return "排队中";
+    case PlatePresence::Departed: return "已离场";
+    }
+    return QString();
+}
+
+// PlateSearchIndex 实现
+PlateSearchIndex::PlateSearchIndex(const ParkingLot *parkingLot, int departedCapacity)
+    : parkingLot(parkingLot), departedCapacity(qMax(0, departedCapacity)) {
+    // 从当前状态（可能刚从日志恢复）建立索引，之后由观察者回调增量维护
+    parkingLot->getSpotManager().forEachParkedVehicle([this](int spot, const Vehicle &vehicle) {
+        update(vehicle.getPlateKey(), PlatePresence::Parked, spot, vehicle.getEntryTime());
+    });
+    parkingLot->getQueueManager().forEachQueuedVehicle([this](const Vehicle &vehicle) {
+        update(vehicle.getPlateKey(), PlatePresence::Queued, -1, vehicle.getEntryTime());
+    });
+}
+
+void PlateSearchIndex::addPostings(int id) {
+    const Entry &entry = entries[id];
+    quint64 added[2 * PlateKey::kMaxLength];
+    int count = 0;
+    for (int gram = 2; gram <= 3; ++gram) {
+        for (int i = 0; i + gram <= entry.length; ++i) {
+            quint64 key = gramKey(entry.folded + i, gram);
+            if (std::find(added, added + count, key) != added + count) continue;  // 同一车牌内重复的组只记一次
+            added[count++] = key;
+            postings[key].append(id);
+        }
+    }
+}
+
+void PlateSearchIndex::update(const PlateKey &plate, PlatePresence presence, int spot, qint64 time) {
+    auto it = index.constFind(plate);
+    if (it != index.constEnd()) {
+        // 折叠后的车牌不变，倒排表无需改动
+        Entry &entry = entries[it.value()];
+        entry.presence = presence;
+        entry.spot = spot;
+        entry.time = time;
+        return;
+    }
+
+    Entry entry;
+    entry.plate = plate;
+    entry.length = foldedUnits(plate, entry.folded);
+    entry.presence = presence;
+    entry.live = true;
+    entry.spot = spot;
+    entry.time = time;
+    entry.departure = 0;
+    int id = entries.size();
+    entries.append(entry);
+    index.insert(plate, id);
+    addPostings(id);
+}
+
+void PlateSearchIndex::depart(const PlateKey &plate) {
+    auto it = index.constFind(plate);
+    if (it == index.constEnd()) return;
+    Entry &entry = entries[it.value()];
+    entry.presence = PlatePresence::Departed;
+    entry.spot = -1;
+    entry.time = parkingLot->getClock()->now();
+    entry.departure = ++departureSequence;
+    departures.enqueue({plate, entry.departure});
+
+    // 只保留最近离场的 departedCapacity 辆；之后又入场或再次离场的车牌跳过
+    while (departures.size() > departedCapacity) {
+        Departure oldest = departures.dequeue();
+        auto old = index.find(oldest.plate);
+        if (old == index.end()) continue;
+        Entry &stale = entries[old.value()];
+        if (stale.presence != PlatePresence::Departed || stale.departure != oldest.sequence) continue;
+        stale.live = false;
+        index.erase(old);
+        ++staleEntries;
+    }
+
+    // 倒排表只做惰性删除，失效条目多于有效条目时整体重建
+    if (staleEntries > kCompactThreshold && staleEntries > index.size()) {
+        compact();
+    }
+}
+
+void PlateSearchIndex::compact() {
+    QVector<Entry> kept;
+    kept.reserve(index.size());
+    for (const Entry &entry : entries) {
+        if (entry.live) kept.append(entry);
+    }
+    entries.swap(kept);
+
+    index.clear();
+    postings.clear();
+    index.reserve(entries.size());
+    for (int id = 0; id < entries.size(); ++id) {
+        index.insert(entries[id].plate, id);
+        addPostings(id);
+    }
+    staleEntries = 0;
+    marks.clear();
+    epoch = 0;
+}
+
+const QVector<int> *PlateSearchIndex::rarestPosting(const ushort *units, int length) const {
+    // 子串中的每个组都必须出现在车牌里，取最短的倒排表核对；任何一个组不存在则没有结果
+    int gram = qMin(length, 3);
+    const QVector<int> *rarest = nullptr;
+    for (int i = 0; i + gram <= length; ++i) {
+        auto it = postings.constFind(gramKey(units + i, gram));
+        if (it == postings.constEnd()) return nullptr;
+        if (!rarest || it.value().size() < rarest->size()) rarest = &it.value();
+    }
+    return rarest;
+}
+
+bool PlateSearchIndex::visit(int id) const {
+    if (marks[id] == epoch) return false;
+    marks[id] = epoch;
+    return true;
+}
+
+QVector<PlateSearchHit> PlateSearchIndex::search(const QString &query, int limit) const {
+    PARK_TRACE_SCOPE(PlateSearch);
+    QVector<PlateSearchHit> hits;
+    PlateKey key(query);
+    if (!key.isValid() || limit <= 0) return hits;
+    ushort folded[PlateKey::kMaxLength];
+    int length = foldedUnits(key, folded);
+
+    if (marks.size() < entries.size()) marks.resize(entries.size());
+    if (++epoch == 0) {
+        marks.fill(0);
+        epoch = 1;
+    }
+
+    QVector<Candidate> candidates;
+    auto exact = index.constFind(key);
+    if (exact != index.constEnd()) {
+        visit(exact.value());
+        candidates.append({exact.value(), PlateMatch::Exact});
+    }
+
+    if (length >= kMinQueryLength) {
+        // 前缀与子串
+        if (const QVector<int> *posting = rarestPosting(folded, length)) {
+            for (int id : *posting) {
+                const Entry &entry = entries[id];
+                if (!entry.live || entry.length < length) continue;
+                int at = findUnits(entry.folded, entry.length, folded, length);
+                if (at < 0 || !visit(id)) continue;
+                PlateMatch match = at > 0 ? PlateMatch::Substring
+                                   : entry.length == length ? PlateMatch::Confusable : PlateMatch::Prefix;
+                candidates.append({id, match});
+            }
+        }
+
+        // 编辑距离 1：未被编辑的那一半必然原样出现在车牌中
+        if (length >= 2 * kMinQueryLength) {
+            int half = length / 2;
+            const int offsets[2] = {0, half};
+            const int lengths[2] = {half, length - half};
+            for (int part = 0; part < 2; ++part) {
+                const QVector<int> *posting = rarestPosting(folded + offsets[part], lengths[part]);
+                if (!posting) continue;
+                for (int id : *posting) {
+                    const Entry &entry = entries[id];
+                    if (!entry.live || qAbs(entry.length - length) > 1) continue;
+                    if (marks[id] == epoch || !withinOneEdit(entry.folded, entry.length, folded, length)) continue;
+                    visit(id);
+                    candidates.append({id, PlateMatch::Fuzzy});
+                }
+            }
+        }
+    }
+
+    // 先按匹配程度，再按在场、排队、已离场排序
+    auto before = [this](const Candidate &a, const Candidate &b) {
+        if (a.match != b.match) return a.match < b.match;
+        const Entry &x = entries[a.id];
+        const Entry &y = entries[b.id];
+        if (x.presence != y.presence) return x.presence < y.presence;
+        return x.plate < y.plate;
+    };
+    int count = qMin(limit, int(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), before);
+
+    hits.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const Entry &entry = entries[candidates[i].id];
+        hits.append({entry.plate, candidates[i].match, entry.presence, entry.spot, entry.time});
+    }
+    return hits;
+}
+
+void PlateSearchIndex::vehicleParked(const Vehicle &vehicle, int spot) {
+    update(vehicle.getPlateKey(), PlatePresence::Parked, spot, vehicle.getEntryTime());
+}
+
+void PlateSearchIndex::vehicleReleased(const Vehicle &vehicle, int, const ReleaseInfo &) {
+    depart(vehicle.getPlateKey());
+}
+
+void PlateSearchIndex::vehicleQueued(const Vehicle &vehicle) {
+    update(vehicle.getPlateKey(), PlatePresence::Queued, -1, vehicle.getEntryTime());
+}
+
+void PlateSearchIndex::queueCancelled(const Vehicle &vehicle) {
+    depart(vehicle.getPlateKey());
+}
@@ -0,0 +1,91 @@
+#ifndef PLATESEARCHINDEX_H
+#define PLATESEARCHINDEX_H
+
+#include <QHash>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+#include "parkinglot.h"
+
+enum class PlatePresence : quint8 { Parked, Queued, Departed };
+enum class PlateMatch : quint8 {
+    Exact,        // 与输入完全相同
+    Confusable,   // 只差易混字符（0/O、8/B、1/I 等）
+    Prefix,       // 输入是车牌开头
+    Substring,    // 输入出现在车牌中间
+    Fuzzy         // 整个车牌相差一次插入、删除或替换
+};
+
+QString platePresenceName(PlatePresence presence);
+
+struct PlateSearchHit {
+    PlateKey plate;
+    PlateMatch match;
+    PlatePresence presence;
+    int spot;       // 在场时为车位号，否则为 -1
+    qint64 time;    // 在场/排队时为入场时间，已离场时为离场时间
+};
+
+// PlateSearchIndex 类
+// 车牌模糊查找：对在场、排队和最近离场的车牌，先把易混字符折叠成同一个字符，
+// 再按二元组、三元组建立倒排表。前缀和子串查询取输入中最短的倒排表逐个核对；
+// 编辑距离 1 的查询把输入对半分，一次编辑只会破坏其中一半，另一半必然原样出现在车牌里，
+// 因此复用同一份倒排表即可得到候选，不需要额外的删除邻域表。
+// 作为 ParkingLotObserver 随停车场同步更新；不是线程安全的，应与停车场在同一线程使用。
+class PlateSearchIndex : public ParkingLotObserver {
+public:
+    static const int kMinQueryLength = 2;  // 更短的输入只做精确匹配
+
+    explicit PlateSearchIndex(const ParkingLot *parkingLot, int departedCapacity = 10000);
+
+    // 按匹配类型、在场状态排序，最多返回 limit 条
+    QVector<PlateSearchHit> search(const QString &query, int limit = 20) const;
+    int size() const { return index.size(); }
+
+    void vehicleParked(const Vehicle &vehicle, int spot) override;
+    void vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) override;
+    void vehicleQueued(const Vehicle &vehicle) override;
+    void queueCancelled(const Vehicle &vehicle) override;
+
+private:
+    struct Entry {
+        PlateKey plate;
+        ushort folded[PlateKey::kMaxLength];
+        int length;
+        PlatePresence presence;
+        bool live;
+        int spot;
+        qint64 time;
+        quint64 departure;  // 最近一次离场的序号，用于淘汰最早离场的车牌
+    };
+    struct Departure {
+        PlateKey plate;
+        quint64 sequence;
+    };
+    struct Candidate {
+        int id;
+        PlateMatch match;
+    };
+
+    void update(const PlateKey &plate, PlatePresence presence, int spot, qint64 time);
+    void depart(const PlateKey &plate);
+    void addPostings(int id);
+    void compact();
+    const QVector<int> *rarestPosting(const ushort *units, int length) const;
+    bool visit(int id) const;
+
+    const ParkingLot *parkingLot;
+    int departedCapacity;
+    QVector<Entry> entries;
+    QHash<PlateKey, int> index;              // 车牌 -> entries 下标
+    QHash<quint64, QVector<int>> postings;   // 折叠后的二元组/三元组 -> entries 下标
+    QQueue<Departure> departures;
+    quint64 departureSequence = 0;
+    int staleEntries = 0;                    // 已删除但仍留在倒排表里的条目
+
+    mutable QVector<quint32> marks;          // 一次查询内的候选去重
+    mutable quint32 epoch = 0;
+};
+
+#endif // PLATESEARCHINDEX_H
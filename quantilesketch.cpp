@@ -0,0 +1,45 @@
+#include "quantilesketch.h"
+
+#include <cmath>
+
+// QuantileSketch 实现
+int QuantileSketch::binOf(qint64 value) {
+    if (value <= 1) return 0;
+    int bin = int(3.0 * std::log2(double(value)));
+    return bin < kBins ? bin : kBins - 1;
+}
+
+qint64 QuantileSketch::binValue(int bin) {
+    return qint64(std::exp2((bin + 0.5) / 3.0));
+}
+
+void QuantileSketch::add(qint64 value) {
+    ++bins[binOf(value)];
+    ++total;
+    if (value > maxValue) maxValue = value;
+}
+
+void QuantileSketch::merge(const QuantileSketch &other) {
+    for (int i = 0; i < kBins; ++i) {
+        bins[i] += other.bins[i];
+    }
+    total += other.total;
+    if (other.maxValue > maxValue) maxValue = other.maxValue;
+}
+
+void QuantileSketch::clear() {
+    *this = QuantileSketch();
+}
+
+qint64 QuantileSketch::quantile(double q) const {
+    if (total == 0) return 0;
+    qint64 rank = qMax<qint64>(1, qint64(std::ceil(q * total)));
+    qint64 seen = 0;
+    for (int i = 0; i < kBins; ++i) {
+        seen += bins[i];
+        if (seen >= rank) {
+            return qMin(binValue(i), maxValue);
+        }
+    }
+    return maxValue;
+}
@@ -0,0 +1,30 @@
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <QtGlobal>
+
+// QuantileSketch 类
+// 对数分桶的流式直方图：每个 2 的幂区间分 3 个桶（相邻桶约 1.26 倍），
+// 覆盖 1 毫秒到约 50 天，分位数相对误差约 12%。固定大小、可直接合并，
+// 适合按时间窗口分段累计后再汇总。
+class QuantileSketch {
+public:
+    static const int kBins = 96;
+
+    void add(qint64 value);
+    void merge(const QuantileSketch &other);
+    void clear();
+    qint64 count() const { return total; }
+    qint64 quantile(double q) const;  // 0 < q <= 1，空时返回 0
+    qint64 max() const { return maxValue; }
+
+private:
+    static int binOf(qint64 value);
+    static qint64 binValue(int bin);  // 桶内代表值（几何中点）
+
+    quint32 bins[kBins] = {};
+    qint64 total = 0;
+    qint64 maxValue = 0;
+};
+
+#endif // QUANTILESKETCH_H
@@ -0,0 +1,140 @@
+#include "queuemanager.h"
+
+namespace {
+// 默认老化补偿：优先车辆视为提前到达的时长
+const qint64 kDefaultBoosts[kPriorityClassCount] = {
+    0,                  // 普通车辆
+    10 * 60 * 1000,     // 新能源车
+    20 * 60 * 1000,     // 许可证车辆
+    60 * 60 * 1000      // 残障人士车辆
+};
+}
+
+// QueueManager 实现
+QueueManager::QueueManager(int maxCapacity) : maxCapacity(maxCapacity) {
+    for (int c = 0; c < kPriorityClassCount; ++c) {
+        heads[c] = tails[c] = -1;
+        lengths[c] = 0;
+        for (int v = 0; v < kVehicleClassCount; ++v) classLengths[c][v] = 0;
+        boosts[c] = kDefaultBoosts[c];
+    }
+}
+
+void QueueManager::addVehicleToQueue(const Vehicle &vehicle) {
+    if (isQueueFull() || index.contains(vehicle.getPlateKey())) {
+        return;
+    }
+
+    int node;
+    if (!freeNodes.isEmpty()) {
+        node = freeNodes.takeLast();
+    } else {
+        node = nodes.size();
+        nodes.append(Node());
+    }
+
+    int c = int(vehicle.getPriorityClass());
+    Node &entry = nodes[node];
+    entry.vehicle = vehicle;
+    entry.prev = tails[c];
+    entry.next = -1;
+    if (tails[c] >= 0) nodes[tails[c]].next = node;
+    else heads[c] = node;
+    tails[c] = node;
+    ++lengths[c];
+    ++classLengths[c][int(vehicle.getVehicleClass())];
+
+    index.insert(vehicle.getPlateKey(), node);
+    orderValid = false;
+}
+
+int QueueManager::pickClass(const int *cursors) const {
+    // 每类内部先来先服务，只需比较各类当前节点的有效到达时间；相同时优先级高的先放行
+    int best = -1;
+    qint64 bestKey = 0;
+    for (int c = kPriorityClassCount - 1; c >= 0; --c) {
+        if (cursors[c] < 0) continue;
+        qint64 key = nodes[cursors[c]].vehicle.getEntryTime() - boosts[c];
+        if (best < 0 || key < bestKey) {
+            best = c;
+            bestKey = key;
+        }
+    }
+    return best;
+}
+
+Vehicle QueueManager::dequeueVehicle() {
+    int c = pickClass(heads);
+    Q_ASSERT(c >= 0);
+    int node = heads[c];
+    Vehicle vehicle = nodes[node].vehicle;
+    releaseNode(node);
+    return vehicle;
+}
+
+const Vehicle *QueueManager::peekNextVehicle() const {
+    int c = pickClass(heads);
+    return c >= 0 ? &nodes[heads[c]].vehicle : nullptr;
+}
+
+bool QueueManager::removeVehicleFromQueue(const PlateKey &plate, Vehicle *removed) {
+    auto it = index.constFind(plate);
+    if (it == index.constEnd()) {
+        return false;
+    }
+    if (removed) *removed = nodes[it.value()].vehicle;
+    releaseNode(it.value());
+    return true;
+}
+
+void QueueManager::releaseNode(int node) {
+    Node &entry = nodes[node];
+    int c = int(entry.vehicle.getPriorityClass());
+    if (entry.prev >= 0) nodes[entry.prev].next = entry.next;
+    else heads[c] = entry.next;
+    if (entry.next >= 0) nodes[entry.next].prev = entry.prev;
+    else tails[c] = entry.prev;
+    --lengths[c];
+    --classLengths[c][int(entry.vehicle.getVehicleClass())];
+
+    index.remove(entry.vehicle.getPlateKey());
+    entry.vehicle = Vehicle();
+    freeNodes.append(node);
+    orderValid = false;
+}
+
+bool QueueManager::isQueueEmpty() const {
+    return index.isEmpty();
+}
+
+bool QueueManager::isQueueFull() const {
+    return index.size() >= maxCapacity;
+}
+
+void QueueManager::setAgingBoost(PriorityClass priorityClass, qint64 msecs) {
+    boosts[int(priorityClass)] = msecs;
+    orderValid = false;
+}
+
+const Vehicle *QueueManager::getVehicleAt(int position) const {
+    if (position < 0 || position >= index.size()) {
+        return nullptr;
+    }
+    if (!orderValid) {
+        // 队列变化后第一次按位置读取时重建一次，界面每帧至多触发一次
+        order.clear();
+        order.reserve(index.size());
+        int cursors[kPriorityClassCount];
+        for (int c = 0; c < kPriorityClassCount; ++c) cursors[c] = heads[c];
+        for (int c = pickClass(cursors); c >= 0; c = pickClass(cursors)) {
+            order.append(cursors[c]);
+            cursors[c] = nodes[cursors[c]].next;
+        }
+        orderValid = true;
+    }
+    return &nodes[order[position]].vehicle;
+}
+
+bool QueueManager::hasVehicleInQueue(const PlateKey &plate) const {
+    return index.contains(plate);
+}
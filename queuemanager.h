@@ -0,0 +1,84 @@
+#ifndef QUEUEMANAGER_H
+#define QUEUEMANAGER_H
+
+#include <QHash>
+#include <QVector>
+#include "vehicle.h"
+
+// QueueManager 类
+// 按优先级分类的等待队列：每类一条先来先服务的双向链表，节点放在预分配的数组里，
+// 另有车牌到节点的哈希索引，入队、查询、放弃排队和放行下一辆都是 O(1)。
+// 放行顺序带老化补偿：各类车辆视为提前 boost 毫秒到达，比较各类队首即可选出下一辆，
+// 普通车辆等得足够久也会排到新来的优先车辆前面。
+class QueueManager {
+public:
+    QueueManager(int maxCapacity);
+    void addVehicleToQueue(const Vehicle &vehicle);  // 队列已满或车牌已在队列中时忽略
+    Vehicle dequeueVehicle();                         // 取出下一辆应放行的车辆，队列不能为空
+    const Vehicle *peekNextVehicle() const;           // 队列为空时返回 nullptr
+    bool removeVehicleFromQueue(const PlateKey &plate, Vehicle *removed = nullptr);  // 车辆放弃排队，未找到时返回 false
+    bool isQueueEmpty() const;
+    bool isQueueFull() const;
+    bool hasVehicleInQueue(const PlateKey &plate) const;
+    int getMaxCapacity() const { return maxCapacity; }
+    int getQueueLength() const { return index.size(); }
+    int getClassLength(PriorityClass priorityClass) const { return lengths[int(priorityClass)]; }
+    // 某排队类别中某车型的车辆数，放行时据此跳过当前没有车位可停的组合
+    int getClassLength(PriorityClass priorityClass, VehicleClass vehicleClass) const {
+        return classLengths[int(priorityClass)][int(vehicleClass)];
+    }
+
+    // 老化补偿：全为 0 时严格先来先服务，取值很大时为严格优先级
+    void setAgingBoost(PriorityClass priorityClass, qint64 msecs);
+    qint64 getAgingBoost(PriorityClass priorityClass) const { return boosts[int(priorityClass)]; }
+
+    const Vehicle *getVehicleAt(int position) const;  // 按放行顺序，0 为下一辆，越界返回 nullptr
+
+    // 按放行顺序只读遍历：visit(const Vehicle &)
+    template <typename Visit>
+    void forEachQueuedVehicle(Visit visit) const {
+        int cursors[kPriorityClassCount];
+        for (int c = 0; c < kPriorityClassCount; ++c) cursors[c] = heads[c];
+        for (int c = pickClass(cursors); c >= 0; c = pickClass(cursors)) {
+            visit(nodes[cursors[c]].vehicle);
+            cursors[c] = nodes[cursors[c]].next;
+        }
+    }
+
+    // 按放行顺序找第一辆满足 match(const Vehicle &) 的车辆，找到即停止；没有时返回 nullptr
+    template <typename Match>
+    const Vehicle *findQueuedVehicle(Match match) const {
+        int cursors[kPriorityClassCount];
+        for (int c = 0; c < kPriorityClassCount; ++c) cursors[c] = heads[c];
+        for (int c = pickClass(cursors); c >= 0; c = pickClass(cursors)) {
+            if (match(nodes[cursors[c]].vehicle)) return &nodes[cursors[c]].vehicle;
+            cursors[c] = nodes[cursors[c]].next;
+        }
+        return nullptr;
+    }
+
+private:
+    struct Node {
+        Vehicle vehicle;
+        int prev = -1;
+        int next = -1;
+    };
+
+    int pickClass(const int *cursors) const;  // 在各类的当前节点中选出下一辆所在的类，全空时返回 -1
+    void releaseNode(int node);
+
+    QVector<Node> nodes;
+    QVector<int> freeNodes;
+    int heads[kPriorityClassCount];
+    int tails[kPriorityClassCount];
+    int lengths[kPriorityClassCount];
+    int classLengths[kPriorityClassCount][kVehicleClassCount];
+    qint64 boosts[kPriorityClassCount];
+    QHash<PlateKey, int> index;  // 车牌 -> 节点
+    int maxCapacity;
+
+    mutable QVector<int> order;  // 按放行顺序的节点缓存，供界面按位置读取
+    mutable bool orderValid = false;
+};
+
+#endif // QUEUEMANAGER_H
@@ -0,0 +1,328 @@
+#include "spotallocator.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace {
+
+// 车型按实际尺寸从小到大排列，车辆可以停入不小于自身的车位
+const VehicleClass kSizeOrder[kVehicleClassCount] = {VehicleClass::Compact, VehicleClass::Standard, VehicleClass::Oversize};
+
+int sizeRank(VehicleClass vehicleClass) {
+    return int(std::find(kSizeOrder, kSizeOrder + kVehicleClassCount, vehicleClass) - kSizeOrder);
+}
+
+int kindIndex(int size, int reservation) {
+    return size * kPriorityClassCount + reservation;
+}
+
+} // namespace
+
+// HierarchicalBitset 实现
+HierarchicalBitset::HierarchicalBitset(int size) : bitCount(qMax(0, size)) {
+    int words = qMax(1, (bitCount + 63) / 64);
+    levels.append(QVector<quint64>(words));
+    while (words > 1) {
+        words = (words + 63) / 64;
+        levels.append(QVector<quint64>(words));
+    }
+}
+
+void HierarchicalBitset::set(int i) {
+    // 字由空变为非空时才需要修改上一层
+    for (int level = 0; level < levels.size(); ++level) {
+        quint64 &word = levels[level][i >> 6];
+        bool wasEmpty = word == 0;
+        word |= quint64(1) << (i & 63);
+        if (!wasEmpty) break;
+        i >>= 6;
+    }
+}
+
+void HierarchicalBitset::reset(int i) {
+    for (int level = 0; level < levels.size(); ++level) {
+        quint64 &word = levels[level][i >> 6];
+        word &= ~(quint64(1) << (i & 63));
+        if (word != 0) break;
+        i >>= 6;
+    }
+}
+
+bool HierarchicalBitset::test(int i) const {
+    return i >= 0 && i < bitCount && ((levels[0][i >> 6] >> (i & 63)) & 1) != 0;
+}
+
+int HierarchicalBitset::findNext(int from) const {
+    if (from < 0) from = 0;
+    if (from >= bitCount) return -1;
+
+    // 向上：在当前层找 index 之后的第一个置位，找不到就到上一层从下一个字开始找
+    int level = 0;
+    quint64 index = quint64(from);
+    while (true) {
+        if (level == levels.size()) return -1;
+        quint64 word = index >> 6;
+        if (word >= quint64(levels[level].size())) return -1;
+        quint64 bits = levels[level][int(word)] & (~quint64(0) << (index & 63));
+        if (bits != 0) {
+            index = word * 64 + qCountTrailingZeroBits(bits);
+            break;
+        }
+        index = word + 1;
+        ++level;
+    }
+
+    // 向下：每层取最低的置位
+    while (level > 0) {
+        --level;
+        index = index * 64 + qCountTrailingZeroBits(levels[level][int(index)]);
+    }
+    return int(index);
+}
+
+// SpotLayout 实现
+int SpotLayout::zoneOf(int spot) const {
+    return int(std::upper_bound(zoneStarts.begin(), zoneStarts.end(), spot) - zoneStarts.begin()) - 1;
+}
+
+bool SpotLayout::hasReservedSpots() const {
+    return std::any_of(reservations.begin(), reservations.end(),
+                       [](quint8 reservation) { return reservation != quint8(PriorityClass::Regular); });
+}
+
+bool SpotLayout::isUniform() const {
+    if (zoneStarts.size() != 1) return false;
+    for (int spot = 0; spot < sizes.size(); ++spot) {
+        if (sizes[spot] != quint8(VehicleClass::Oversize) || reservations[spot] != quint8(PriorityClass::Regular)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SpotLayout SpotLayout::uniform(int totalSpots) {
+    // 不区分车位时每个车位都能停任何车型
+    SpotLayout layout;
+    layout.sizes.fill(quint8(VehicleClass::Oversize), qMax(0, totalSpots));
+    layout.reservations.fill(quint8(PriorityClass::Regular), qMax(0, totalSpots));
+    layout.zoneStarts.append(0);
+    return layout;
+}
+
+SpotLayout SpotLayout::generate(int totalSpots, int zoneCount, int compactPercent, int oversizePercent,
+                                int disabledPerZone, int electricPerZone) {
+    totalSpots = qMax(0, totalSpots);
+    zoneCount = qBound(1, zoneCount, qMax(1, totalSpots));
+    QVector<int> zoneStarts;
+    for (int zone = 0; zone < zoneCount; ++zone) {
+        zoneStarts.append(int(qint64(totalSpots) * zone / zoneCount));
+    }
+    return generate(zoneStarts, totalSpots, compactPercent, oversizePercent, disabledPerZone, electricPerZone);
+}
+
+SpotLayout SpotLayout::generate(const QVector<int> &zoneStarts, int totalSpots, int compactPercent, int oversizePercent,
+                                int disabledPerZone, int electricPerZone) {
+    totalSpots = qMax(0, totalSpots);
+    SpotLayout layout;
+    layout.sizes.reserve(totalSpots);
+    layout.reservations.reserve(totalSpots);
+    layout.zoneStarts = zoneStarts.isEmpty() ? QVector<int>{0} : zoneStarts;
+
+    for (int zone = 0; zone < layout.zoneStarts.size(); ++zone) {
+        int start = layout.zoneStarts[zone];
+        int end = zone + 1 < layout.zoneStarts.size() ? layout.zoneStarts[zone + 1] : totalSpots;
+        int spots = end - start;
+
+        // 保留车位放在区域入口处，大型车位放在区域末尾
+        int disabled = qBound(0, disabledPerZone, spots);
+        int electric = qBound(0, electricPerZone, spots - disabled);
+        int rest = spots - disabled - electric;
+        int oversize = qBound(0, rest * oversizePercent / 100, rest);
+        int compact = qBound(0, rest * compactPercent / 100, rest - oversize);
+        int standard = rest - oversize - compact;
+
+        auto append = [&layout](int count, VehicleClass size, PriorityClass reservation) {
+            for (int i = 0; i < count; ++i) {
+                layout.sizes.append(quint8(size));
+                layout.reservations.append(quint8(reservation));
+            }
+        };
+        append(disabled, VehicleClass::Standard, PriorityClass::Disabled);
+        append(electric, VehicleClass::Standard, PriorityClass::Electric);
+        append(compact, VehicleClass::Compact, PriorityClass::Regular);
+        append(standard, VehicleClass::Standard, PriorityClass::Regular);
+        append(oversize, VehicleClass::Oversize, PriorityClass::Regular);
+    }
+    return layout;
+}
+
+bool SpotLayout::parse(int totalSpots, const QString &spec, SpotLayout *layout, QString *error,
+                       const QVector<int> &zoneStarts) {
+    int zones = 1, compact = 0, oversize = 0, disabled = 0, electric = 0;
+    const QStringList items = spec.split(',');
+    for (const QString &item : items) {
+        if (item.trimmed().isEmpty()) continue;
+        QStringList pair = item.split('=');
+        bool ok = pair.size() == 2;
+        int value = ok ? pair[1].trimmed().toInt(&ok) : 0;
+        QString key = pair[0].trimmed().toLower();
+        if (!ok || value < 0) {
+            if (error) *error = QString("无效的布局项：%1").arg(item.trimmed());
+            return false;
+        }
+        if (key == "zones") {
+            if (!zoneStarts.isEmpty()) {
+                if (error) *error = "区域已由停车场拓扑划分，不能再指定 zones";
+                return false;
+            }
+            zones = value;
+        } else if (key == "compact") {
+            compact = value;
+        } else if (key == "oversize") {
+            oversize = value;
+        } else if (key == "disabled") {
+            disabled = value;
+        } else if (key == "electric") {
+            electric = value;
+        } else {
+            if (error) *error = QString("未知的布局项：%1").arg(key);
+            return false;
+        }
+    }
+    if (zones < 1 || zones > totalSpots) {
+        if (error) *error = QString("区域数应在 1 到 %1 之间").arg(totalSpots);
+        return false;
+    }
+    if (compact + oversize > 100) {
+        if (error) *error = "小型和大型车位的比例之和不能超过 100";
+        return false;
+    }
+    *layout = zoneStarts.isEmpty() ? generate(totalSpots, zones, compact, oversize, disabled, electric)
+                                   : generate(zoneStarts, totalSpots, compact, oversize, disabled, electric);
+    return true;
+}
+
+// 分配策略
+int NearestEntrancePolicy::choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const {
+    for (int i = 0; i < kindCount; ++i) {
+        if (allocator.freeOfKind(kinds[i]) > 0) {
+            return allocator.firstFree(kinds[i], 0, allocator.getLayout().getTotalSpots());
+        }
+    }
+    return -1;
+}
+
+int ZoneBalancingPolicy::choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const {
+    const SpotLayout &layout = allocator.getLayout();
+    for (int i = 0; i < kindCount; ++i) {
+        if (allocator.freeOfKind(kinds[i]) == 0) continue;
+        int best = 0;
+        for (int zone = 1; zone < layout.getZoneCount(); ++zone) {
+            if (allocator.freeInZone(kinds[i], zone) > allocator.freeInZone(kinds[i], best)) best = zone;
+        }
+        int end = best + 1 < layout.getZoneCount() ? layout.zoneStarts[best + 1] : layout.getTotalSpots();
+        return allocator.firstFree(kinds[i], layout.zoneStarts[best], end);
+    }
+    return -1;
+}
+
+std::shared_ptr<const SpotAllocationPolicy> spotAllocationPolicy(const QString &name) {
+    QString key = name.trimmed().toLower();
+    if (key.isEmpty() || key == "nearest") return std::make_shared<NearestEntrancePolicy>();
+    if (key == "balance") return std::make_shared<ZoneBalancingPolicy>();
+    return nullptr;
+}
+
+// SpotAllocator 实现
+SpotAllocator::SpotAllocator(const SpotLayout &layout)
+    : layout(layout), policy(std::make_shared<NearestEntrancePolicy>()), spotKinds(layout.getTotalSpots()),
+    kindTotal(kKindCount), kindFree(kKindCount), zoneFree(kKindCount * layout.getZoneCount()) {
+    int totalSpots = layout.getTotalSpots();
+    freeSpots.reserve(kKindCount);
+    for (int kind = 0; kind < kKindCount; ++kind) freeSpots.append(HierarchicalBitset(totalSpots));
+
+    int zone = 0;
+    for (int spot = 0; spot < totalSpots; ++spot) {
+        while (zone + 1 < layout.getZoneCount() && layout.zoneStarts[zone + 1] <= spot) ++zone;
+        int kind = kindIndex(layout.sizes[spot], layout.reservations[spot]);
+        spotKinds[spot] = quint8(kind);
+        freeSpots[kind].set(spot);
+        ++kindTotal[kind];
+        ++kindFree[kind];
+        ++zoneFree[kind * layout.getZoneCount() + zone];
+    }
+    freeCount = totalSpots;
+}
+
+int SpotAllocator::candidateKinds(const Vehicle &vehicle, int *kinds) const {
+    int smallest = sizeRank(vehicle.getVehicleClass());
+    int priority = int(vehicle.getPriorityClass());
+    int count = 0;
+    // 保留车位只给对应类别的车辆，并且优先使用；同一保留类别内先用刚好合适的车位
+    auto addSizes = [&](int reservation) {
+        for (int rank = smallest; rank < kVehicleClassCount; ++rank) {
+            kinds[count++] = kindIndex(int(kSizeOrder[rank]), reservation);
+        }
+    };
+    if (priority != int(PriorityClass::Regular)) addSizes(priority);
+    addSizes(int(PriorityClass::Regular));
+    return count;
+}
+
+int SpotAllocator::firstFree(int kind, int from, int to) const {
+    int spot = freeSpots[kind].findNext(from);
+    return spot >= 0 && spot < to ? spot : -1;
+}
+
+bool SpotAllocator::canAllocate(const Vehicle &vehicle) const {
+    int kinds[kKindCount];
+    int count = candidateKinds(vehicle, kinds);
+    for (int i = 0; i < count; ++i) {
+        if (kindFree[kinds[i]] > 0) return true;
+    }
+    return false;
+}
+
+bool SpotAllocator::fits(const Vehicle &vehicle) const {
+    int kinds[kKindCount];
+    int count = candidateKinds(vehicle, kinds);
+    for (int i = 0; i < count; ++i) {
+        if (kindTotal[kinds[i]] > 0) return true;
+    }
+    return false;
+}
+
+int SpotAllocator::allocate(const Vehicle &vehicle) {
+    if (freeCount == 0) return -1;
+    int kinds[kKindCount];
+    int count = candidateKinds(vehicle, kinds);
+    int spot = policy->choose(*this, kinds, count);
+    if (spot >= 0 && !take(spot)) return -1;
+    return spot;
+}
+
+bool SpotAllocator::take(int spot) {
+    if (spot < 0 || spot >= layout.getTotalSpots()) return false;
+    int kind = spotKinds[spot];
+    if (!freeSpots[kind].test(spot)) return false;
+    freeSpots[kind].reset(spot);
+    --kindFree[kind];
+    --zoneFree[kind * layout.getZoneCount() + layout.zoneOf(spot)];
+    --freeCount;
+    return true;
+}
+
+void SpotAllocator::release(int spot) {
+    if (spot < 0 || spot >= layout.getTotalSpots()) return;
+    int kind = spotKinds[spot];
+    if (freeSpots[kind].test(spot)) return;
+    freeSpots[kind].set(spot);
+    ++kindFree[kind];
+    ++zoneFree[kind * layout.getZoneCount() + layout.zoneOf(spot)];
+    ++freeCount;
+}
+
+void SpotAllocator::setPolicy(std::shared_ptr<const SpotAllocationPolicy> newPolicy) {
+    if (newPolicy) policy = std::move(newPolicy);
+}
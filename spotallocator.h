@@ -0,0 +1,120 @@
+#ifndef SPOTALLOCATOR_H
+#define SPOTALLOCATOR_H
+
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include "vehicle.h"
+
+// HierarchicalBitset 类
+// 64 叉的分层位图：叶子层每一位对应一个元素，上层每一位表示下层对应的 64 位字是否非空。
+// 置位和清位最多沿层级向上修改 log64(n) 个字（10 万个车位只有 3 层），
+// findNext 向上找到第一个非空的字后再逐层向下，同样只访问 O(log64 n) 个字。
+class HierarchicalBitset {
+public:
+    explicit HierarchicalBitset(int size = 0);
+    void set(int i);
+    void reset(int i);
+    bool test(int i) const;
+    int findNext(int from) const;  // 下标不小于 from 的第一个置位，没有时返回 -1
+    int size() const { return bitCount; }
+
+private:
+    int bitCount = 0;
+    QVector<QVector<quint64>> levels;  // levels[0] 为叶子层，最后一层只有一个字
+};
+
+// 车位布局：每个车位的尺寸、所在区域（楼层）和保留类别。
+// 区域按车位号连续划分，zoneStarts 为各区域的起始车位号，第一个必须为 0。
+struct SpotLayout {
+    QVector<quint8> sizes;         // VehicleClass，车位能容纳的车型
+    QVector<quint8> reservations;  // PriorityClass，Regular 表示不保留
+    QVector<int> zoneStarts;
+
+    int getTotalSpots() const { return sizes.size(); }
+    int getZoneCount() const { return zoneStarts.size(); }
+    int zoneOf(int spot) const;
+    bool hasReservedSpots() const;
+    bool isUniform() const;  // 单一区域、全部为不保留且能停任何车型的车位
+
+    static SpotLayout uniform(int totalSpots);
+    // 按车位号平均划分区域；每个区域入口处为保留车位（标准尺寸），其余按比例分为小型、标准和大型车位
+    static SpotLayout generate(int totalSpots, int zoneCount, int compactPercent, int oversizePercent,
+                               int disabledPerZone, int electricPerZone);
+    static SpotLayout generate(const QVector<int> &zoneStarts, int totalSpots, int compactPercent, int oversizePercent,
+                               int disabledPerZone, int electricPerZone);
+    // 形如 "zones=3,compact=20,oversize=5,disabled=2,electric=4"，未给出的项为 0（zones 默认为 1）；
+    // 给出 zoneStarts 时区域已由停车场拓扑划分，不能再写 zones
+    static bool parse(int totalSpots, const QString &spec, SpotLayout *layout, QString *error = nullptr,
+                      const QVector<int> &zoneStarts = QVector<int>());
+};
+
+class SpotAllocator;
+
+// SpotAllocationPolicy 接口
+// 在车辆可用的车位类型中挑选一个空车位。kinds 按优先顺序排列（保留车位在前，小车位在前），
+// 策略只读分配器的索引，应保持 O(区域数 × log n)。策略无状态，可在多个停车场间共享。
+class SpotAllocationPolicy {
+public:
+    virtual ~SpotAllocationPolicy() = default;
+    virtual QString name() const = 0;
+    virtual int choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const = 0;  // 没有空车位时返回 -1
+};
+
+// 离入口最近：车位号越小越近，取第一个有空位的类型中号码最小的车位
+class NearestEntrancePolicy : public SpotAllocationPolicy {
+public:
+    QString name() const override { return "nearest"; }
+    int choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const override;
+};
+
+// 区域均衡：在第一个有空位的类型中，选该类型空位最多的区域，区域内取离入口最近的车位
+class ZoneBalancingPolicy : public SpotAllocationPolicy {
+public:
+    QString name() const override { return "balance"; }
+    int choose(const SpotAllocator &allocator, const int *kinds, int kindCount) const override;
+};
+
+std::shared_ptr<const SpotAllocationPolicy> spotAllocationPolicy(const QString &name);  // 未知名称返回 nullptr
+
+// SpotAllocator 类
+// 按“车位尺寸 × 保留类别”把空车位分成 12 类，每类一个分层位图并按区域计数。
+// 分配时按车辆可用的类型依次交给策略挑选，O(log n)；释放只在对应位图中置位，O(1) 且不移动其他车位。
+class SpotAllocator {
+public:
+    static const int kKindCount = kVehicleClassCount * kPriorityClassCount;
+
+    explicit SpotAllocator(const SpotLayout &layout);
+
+    int allocate(const Vehicle &vehicle);  // 返回分配到的车位号，没有合适的空车位时返回 -1
+    bool take(int spot);                   // 占用指定车位（恢复状态用），已被占用时返回 false
+    void release(int spot);
+    bool canAllocate(const Vehicle &vehicle) const;  // 现在有合适的空车位
+    bool fits(const Vehicle &vehicle) const;         // 布局中存在能容纳该车的车位（不论是否空闲）
+
+    void setPolicy(std::shared_ptr<const SpotAllocationPolicy> policy);  // nullptr 时忽略
+    std::shared_ptr<const SpotAllocationPolicy> getPolicy() const { return policy; }
+    const SpotLayout &getLayout() const { return layout; }
+    int getFreeCount() const { return freeCount; }
+
+    // 供策略查询
+    int candidateKinds(const Vehicle &vehicle, int *kinds) const;  // 写入 kinds，返回个数，最多 kKindCount
+    int kindOf(int spot) const { return spotKinds[spot]; }
+    int freeOfKind(int kind) const { return kindFree[kind]; }
+    int freeInZone(int kind, int zone) const { return zoneFree[kind * layout.getZoneCount() + zone]; }
+    int firstFree(int kind, int from, int to) const;  // [from, to) 中该类型的第一个空车位，没有时返回 -1
+
+private:
+    SpotLayout layout;
+    std::shared_ptr<const SpotAllocationPolicy> policy;
+    QVector<quint8> spotKinds;
+    QVector<HierarchicalBitset> freeSpots;  // 按类型，置位表示空闲
+    QVector<int> kindTotal;
+    QVector<int> kindFree;
+    QVector<int> zoneFree;                  // kind * 区域数 + zone
+    int freeCount = 0;
+};
+
+#endif // SPOTALLOCATOR_H
@@ -0,0 +1,187 @@
+#include "statspanel.h"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPushButton>
+#include <QSaveFile>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+
+const QStringList kRowNames = {
+    "到达车辆", "离场车辆", "进入排队", "排队放行", "放弃排队", "队满拒绝", "拒绝率",
+    "平均在库车辆", "平均占用率", "峰值在库", "峰值排队",
+    "停留 p50/p95/p99", "排队等待 p50/p95/p99", "收入", "每小时收入"
+};
+
+QString minutesText(qint64 msecs)
+{
+    return QString::number(double(msecs) / 60000.0, 'f', 1);
+}
+
+} // namespace
+
+// 最近 60 分钟的平均占用率柱状图
+class OccupancyChart : public QWidget
+{
+public:
+    explicit OccupancyChart(QWidget *parent = nullptr) : QWidget(parent)
+    {
+        setMinimumHeight(120);
+    }
+
+    void setData(const QVector<double> &newValues, int newCapacity)
+    {
+        values = newValues;
+        capacity = qMax(1, newCapacity);
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().color(QPalette::Base));
+        painter.setPen(palette().color(QPalette::Mid));
+        painter.drawRect(rect().adjusted(0, 0, -1, -1));
+        if (values.isEmpty()) return;
+
+        QRectF area = QRectF(rect()).adjusted(4, 4, -4, -16);
+        double barWidth = area.width() / values.size();
+        for (int i = 0; i < values.size(); ++i) {
+            if (values[i] < 0) continue;  // 没有数据的分钟
+            double ratio = qBound(0.0, values[i] / capacity, 1.0);
+            QColor color = ratio > 0.9 ? QColor("#C0392B") : ratio > 0.7 ? QColor("#E67E22") : QColor("#27AE60");
+            QRectF bar(area.left() + i * barWidth, area.bottom() - ratio * area.height(),
+                       qMax(1.0, barWidth - 1), ratio * area.height());
+            painter.fillRect(bar, color);
+        }
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(rect().adjusted(4, 0, -4, -2), Qt::AlignLeft | Qt::AlignBottom, "60 分钟前");
+        painter.drawText(rect().adjusted(4, 0, -4, -2), Qt::AlignRight | Qt::AlignBottom, "现在");
+    }
+
+private:
+    QVector<double> values;
+    int capacity = 1;
+};
+
+// StatsPanel 实现
+StatsPanel::StatsPanel(LotAnalytics *analytics, const ParkingLot *parkingLot, QWidget *parent)
+    : QWidget(parent, Qt::Window), analytics(analytics), parkingLot(parkingLot),
+    currentLabel(new QLabel(this)), table(new QTableWidget(kRowNames.size(), 2, this)),
+    chart(new OccupancyChart(this)), refreshTimer(new QTimer(this))
+{
+    table->setHorizontalHeaderLabels({"最近一小时", "今天"});
+    table->setVerticalHeaderLabels(kRowNames);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for (int row = 0; row < kRowNames.size(); ++row) {
+        for (int column = 0; column < 2; ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            table->setItem(row, column, item);
+        }
+    }
+
+    QPushButton *exportButton = new QPushButton("导出 CSV", this);
+    connect(exportButton, &QPushButton::clicked, this, &StatsPanel::exportCsv);
+
+    refreshTimer->setInterval(1000);
+    connect(refreshTimer, &QTimer::timeout, this, &StatsPanel::refresh);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    topLayout->addWidget(currentLabel, 1);
+    topLayout->addWidget(exportButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(topLayout);
+    layout->addWidget(chart);
+    layout->addWidget(table, 1);
+    setLayout(layout);
+    setWindowTitle("运营统计");
+    resize(460, 560);
+}
+
+void StatsPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void StatsPanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer->stop();  // 不可见时不刷新
+}
+
+void StatsPanel::refresh()
+{
+    QMutexLocker locker(lotMutex);
+    analytics->advanceTo(parkingLot->getClock()->now());
+
+    int totalSpots = parkingLot->getSpotManager().getTotalSpots();
+    int parkedCount = parkingLot->getSpotManager().getParkedCount();
+    currentLabel->setText(QString("当前在库 %1 / %2（%3%），排队 %4")
+                              .arg(parkedCount)
+                              .arg(totalSpots)
+                              .arg(QString::number(100.0 * parkedCount / qMax(1, totalSpots), 'f', 1))
+                              .arg(parkingLot->getQueueManager().getQueueLength()));
+    chart->setData(analytics->minuteOccupancy(), totalSpots);
+    fillColumn(0, analytics->lastHour());
+    fillColumn(1, analytics->today());
+}
+
+void StatsPanel::fillColumn(int column, const AnalyticsWindow &window)
+{
+    int totalSpots = qMax(1, parkingLot->getSpotManager().getTotalSpots());
+    const QStringList values = {
+        QString::number(window.arrivals),
+        QString::number(window.departures),
+        QString::number(window.queued),
+        QString::number(window.promoted),
+        QString::number(window.cancelled),
+        QString::number(window.rejected),
+        QString::number(100.0 * window.rejectionRate(), 'f', 1) + "%",
+        QString::number(window.averageParked(), 'f', 1),
+        QString::number(100.0 * window.averageParked() / totalSpots, 'f', 1) + "%",
+        QString::number(window.peakParked),
+        QString::number(window.peakQueued),
+        QString("%1 / %2 / %3 分钟").arg(minutesText(window.dwell.quantile(0.50)),
+                                        minutesText(window.dwell.quantile(0.95)),
+                                        minutesText(window.dwell.quantile(0.99))),
+        QString("%1 / %2 / %3 分钟").arg(minutesText(window.wait.quantile(0.50)),
+                                        minutesText(window.wait.quantile(0.95)),
+                                        minutesText(window.wait.quantile(0.99))),
+        TariffEngine::formatCents(window.revenueCents) + " 元",
+        QString::number(window.revenuePerHour(), 'f', 2) + " 元"
+    };
+    for (int row = 0; row < values.size(); ++row) {
+        table->item(row, column)->setText(values[row]);
+    }
+}
+
+void StatsPanel::exportCsv()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "导出统计", "parking-stats.csv", "CSV 文件 (*.csv)");
+    if (filePath.isEmpty()) return;
+
+    QByteArray csv;
+    {
+        QMutexLocker locker(lotMutex);
+        analytics->advanceTo(parkingLot->getClock()->now());
+        csv = analytics->toCsv().toUtf8();
+    }
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(csv) < 0 || !file.commit()) {
+        QMessageBox::warning(this, "导出失败", QString("无法写入文件：%1").arg(filePath));
+    }
+}
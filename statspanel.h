@@ -0,0 +1,41 @@
+#ifndef STATSPANEL_H
+#define STATSPANEL_H
+
+#include <QWidget>
+#include "lotanalytics.h"
+
+class QLabel;
+class QMutex;
+class QTableWidget;
+class QTimer;
+class OccupancyChart;
+
+// 运营统计面板：最近一小时和今天的到达/离场、占用率、停留与排队时长分位数、收入，
+// 以及最近 60 分钟的占用率曲线；可见时每秒刷新一次，可按小时导出 CSV
+class StatsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    StatsPanel(LotAnalytics *analytics, const ParkingLot *parkingLot, QWidget *parent = nullptr);
+    void setLotMutex(QMutex *mutex) { lotMutex = mutex; }  // 停车场在工作线程上修改时，读取统计期间持有该锁
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+    void exportCsv();
+    void fillColumn(int column, const AnalyticsWindow &window);
+
+    LotAnalytics *analytics;
+    const ParkingLot *parkingLot;
+    QMutex *lotMutex = nullptr;
+    QLabel *currentLabel;
+    QTableWidget *table;
+    OccupancyChart *chart;
+    QTimer *refreshTimer;
+};
+
+#endif // STATSPANEL_H
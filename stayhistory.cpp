@@ -0,0 +1,387 @@
+#include "stayhistory.h"
+#include "tracing.h"
+
+#include <QDir>
+#include <QMap>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+const char kSegmentMagic[4] = {'P', 'K', 'H', 'S'};
+const quint32 kSegmentVersion = 1;
+const int kSegmentHeaderBytes = 4 + 4 + 4 + 4 + 4 * 8;   // 标识、版本、行数、字典大小、时间上下界
+const int kRowBytes = 4 + 4 + 4 + 4 + 2 + 2 + 1;          // 离场偏移、秒数、车位、费用、行号、字典下标、车型
+const int kActiveRowBytes = 8 + 8 + 4 + 8 + 8 + 8 + 1;    // active.bin 中逐行存放的完整记录
+const qint64 kMSecsPerDay = 24LL * 3600 * 1000;
+
+QString segmentName(int number) { return QString("segment-%1.col").arg(number, 8, 10, QChar('0')); }
+QString activePath(const QString &directory) { return directory + "/active.bin"; }
+
+template <typename T>
+void put(QByteArray &out, T value) {
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+T load(const uchar *data) {
+    return qFromLittleEndian<T>(data);
+}
+
+qint64 floorDiv(qint64 value, qint64 divisor) {
+    qint64 quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+VehicleClass classAt(quint8 value) {
+    return value < kVehicleClassCount ? VehicleClass(value) : VehicleClass::Standard;
+}
+
+bool overlaps(const StayRecord &stay, qint64 from, qint64 to) {
+    return stay.entryTime < to && stay.exitTime > from;
+}
+
+// 段内停留时长按秒存储，入库前先对齐，封存前后查询结果一致
+StayRecord alignStay(StayRecord stay) {
+    qint64 seconds = qBound<qint64>(0, (stay.exitTime - stay.entryTime + 500) / 1000, 0xFFFFFFFFLL);
+    stay.entryTime = stay.exitTime - seconds * 1000;
+    stay.feeCents = qBound<qint64>(0, stay.feeCents, 0xFFFFFFFFLL);
+    return stay;
+}
+
+} // namespace
+
+// StayHistory 实现
+StayHistory::StayHistory(const QString &directory, const TariffEngine *tariff)
+    : directory(directory), tariff(tariff) {
+    QDir dir(directory);
+    dir.mkpath(".");
+
+    // 段文件只读映射，启动时只读头部和车牌字典
+    const QStringList names = dir.entryList(QStringList() << "segment-*.col", QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        int number = name.mid(8, 8).toInt();
+        nextSegmentNumber = qMax(nextSegmentNumber, number + 1);
+        openSegment(dir.filePath(name));
+    }
+
+    // 未封存的记录读回内存，截掉写了一半的尾部
+    activeFile.setFileName(activePath(directory));
+    if (activeFile.open(QIODevice::ReadWrite)) {
+        QByteArray data = activeFile.readAll();
+        int rows = data.size() / kActiveRowBytes;
+        const uchar *row = reinterpret_cast<const uchar *>(data.constData());
+        for (int i = 0; i < rows; ++i, row += kActiveRowBytes) {
+            StayRecord stay;
+            stay.plate = PlateKey::fromWords(load<quint64>(row), load<quint64>(row + 8));
+            stay.spot = load<qint32>(row + 16);
+            stay.entryTime = load<qint64>(row + 20);
+            stay.exitTime = load<qint64>(row + 28);
+            stay.feeCents = load<qint64>(row + 36);
+            stay.vehicleClass = classAt(row[44]);
+            if (active.isEmpty()) activeMinExit = activeMaxExit = stay.exitTime;
+            activeMinExit = qMin(activeMinExit, stay.exitTime);
+            activeMaxExit = qMax(activeMaxExit, stay.exitTime);
+            active.append(stay);
+        }
+        if (data.size() != rows * kActiveRowBytes) {
+            activeFile.resize(qint64(rows) * kActiveRowBytes);
+        }
+        activeFile.seek(activeFile.size());
+    } else {
+        qWarning("无法打开停车历史文件: %s", qPrintable(activeFile.fileName()));
+    }
+}
+
+StayHistory::~StayHistory() {
+    flush();
+    for (Segment &segment : segments) {
+        delete segment.file;  // 关闭文件时解除映射
+    }
+}
+
+bool StayHistory::openSegment(const QString &path) {
+    QFile *file = new QFile(path);
+    const uchar *data = nullptr;
+    if (file->open(QIODevice::ReadOnly) && file->size() >= kSegmentHeaderBytes) {
+        data = file->map(0, file->size());
+    }
+    if (!data || std::memcmp(data, kSegmentMagic, 4) != 0 || load<quint32>(data + 4) != kSegmentVersion) {
+        qWarning("停车历史段文件无法读取，忽略: %s", qPrintable(path));
+        delete file;
+        return false;
+    }
+
+    Segment segment;
+    segment.file = file;
+    segment.rows = load<quint32>(data + 8);
+    segment.plates = load<quint32>(data + 12);
+    segment.minEntry = load<qint64>(data + 16);
+    segment.maxEntry = load<qint64>(data + 24);
+    segment.minExit = load<qint64>(data + 32);
+    segment.maxExit = load<qint64>(data + 40);
+    segment.bytes = file->size();
+
+    qint64 expected = kSegmentHeaderBytes + 16LL * segment.plates + 4LL * (segment.plates + 1)
+                      + qint64(kRowBytes) * segment.rows;
+    if (segment.bytes != expected || segment.plates > segment.rows) {
+        qWarning("停车历史段文件长度不符，忽略: %s", qPrintable(path));
+        delete file;
+        return false;
+    }
+
+    // 8 字节宽的字典放在最前，其后各列按宽度从大到小排列
+    const uchar *column = data + kSegmentHeaderBytes;
+    segment.dictionary = column;       column += 16 * segment.plates;
+    segment.postingStarts = column;    column += 4 * (segment.plates + 1);
+    segment.exitOffsets = column;      column += 4 * segment.rows;
+    segment.durations = column;        column += 4 * segment.rows;
+    segment.spots = column;            column += 4 * segment.rows;
+    segment.fees = column;             column += 4 * segment.rows;
+    segment.postings = column;         column += 2 * segment.rows;
+    segment.plateIds = column;         column += 2 * segment.rows;
+    segment.classes = column;
+
+    int id = segments.size();
+    segments.append(segment);
+    for (quint32 i = 0; i < segment.plates; ++i) {
+        const uchar *entry = segment.dictionary + 16 * i;
+        plateSegments[PlateKey::fromWords(load<quint64>(entry), load<quint64>(entry + 8))].append(id);
+    }
+    return true;
+}
+
+StayRecord StayHistory::rowAt(const Segment &segment, quint32 row) const {
+    StayRecord stay;
+    const uchar *plate = segment.dictionary + 16 * load<quint16>(segment.plateIds + 2 * row);
+    stay.plate = PlateKey::fromWords(load<quint64>(plate), load<quint64>(plate + 8));
+    stay.spot = load<qint32>(segment.spots + 4 * row);
+    stay.exitTime = segment.minExit + load<quint32>(segment.exitOffsets + 4 * row);
+    stay.entryTime = stay.exitTime - qint64(load<quint32>(segment.durations + 4 * row)) * 1000;
+    stay.feeCents = load<quint32>(segment.fees + 4 * row);
+    stay.vehicleClass = classAt(segment.classes[row]);
+    return stay;
+}
+
+void StayHistory::writeActive(const StayRecord &stay) {
+    QByteArray row;
+    row.reserve(kActiveRowBytes);
+    put<quint64>(row, stay.plate.word(0));
+    put<quint64>(row, stay.plate.word(1));
+    put<qint32>(row, stay.spot);
+    put<qint64>(row, stay.entryTime);
+    put<qint64>(row, stay.exitTime);
+    put<qint64>(row, stay.feeCents);
+    put<quint8>(row, quint8(stay.vehicleClass));
+    activeFile.write(row);
+    activeFile.flush();
+}
+
+void StayHistory::append(StayRecord stay) {
+    PARK_TRACE_SCOPE(HistoryAppend);
+    stay = alignStay(stay);
+
+    // 离场时间偏移用 32 位存储，段的跨度超过上限时先封存
+    if (!active.isEmpty() && (qMax(activeMaxExit, stay.exitTime) - qMin(activeMinExit, stay.exitTime) >= kMaxSegmentSpan)) {
+        seal();
+    }
+    if (active.isEmpty()) activeMinExit = activeMaxExit = stay.exitTime;
+    activeMinExit = qMin(activeMinExit, stay.exitTime);
+    activeMaxExit = qMax(activeMaxExit, stay.exitTime);
+    active.append(stay);
+    writeActive(stay);
+
+    if (active.size() >= kSegmentRows) {
+        seal();
+    }
+}
+
+void StayHistory::seal() {
+    if (active.isEmpty()) return;
+    quint32 rows = quint32(active.size());
+
+    // 按车牌排序得到字典和每个车牌的行号列表
+    QVector<int> order(int(rows));
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return active[a].plate < active[b].plate; });
+    QVector<PlateKey> dictionary;
+    QVector<quint32> postingStarts;
+    QVector<quint16> plateIds(int(rows));
+    for (int i = 0; i < int(rows); ++i) {
+        const PlateKey &plate = active[order[i]].plate;
+        if (dictionary.isEmpty() || dictionary.last() != plate) {
+            dictionary.append(plate);
+            postingStarts.append(quint32(i));
+        }
+        plateIds[order[i]] = quint16(dictionary.size() - 1);
+    }
+    postingStarts.append(rows);
+
+    qint64 minEntry = active.first().entryTime;
+    qint64 maxEntry = minEntry;
+    for (const StayRecord &stay : active) {
+        minEntry = qMin(minEntry, stay.entryTime);
+        maxEntry = qMax(maxEntry, stay.entryTime);
+    }
+
+    QByteArray out;
+    out.reserve(kSegmentHeaderBytes + 16 * dictionary.size() + 4 * postingStarts.size() + kRowBytes * int(rows));
+    out.append(kSegmentMagic, 4);
+    put<quint32>(out, kSegmentVersion);
+    put<quint32>(out, rows);
+    put<quint32>(out, quint32(dictionary.size()));
+    put<qint64>(out, minEntry);
+    put<qint64>(out, maxEntry);
+    put<qint64>(out, activeMinExit);
+    put<qint64>(out, activeMaxExit);
+    for (const PlateKey &plate : dictionary) {
+        put<quint64>(out, plate.word(0));
+        put<quint64>(out, plate.word(1));
+    }
+    for (quint32 start : postingStarts) put<quint32>(out, start);
+    for (const StayRecord &stay : active) put<quint32>(out, quint32(stay.exitTime - activeMinExit));
+    for (const StayRecord &stay : active) put<quint32>(out, quint32((stay.exitTime - stay.entryTime) / 1000));
+    for (const StayRecord &stay : active) put<qint32>(out, stay.spot);
+    for (const StayRecord &stay : active) put<quint32>(out, quint32(stay.feeCents));
+    for (int row : order) put<quint16>(out, quint16(row));
+    for (quint16 id : plateIds) put<quint16>(out, id);
+    for (const StayRecord &stay : active) put<quint8>(out, quint8(stay.vehicleClass));
+
+    QString path = QDir(directory).filePath(segmentName(nextSegmentNumber));
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit()) {
+        qWarning("无法写入停车历史段文件: %s", qPrintable(path));
+        return;  // 记录仍保留在 active.bin 中，下次再试
+    }
+    ++nextSegmentNumber;
+    openSegment(path);
+
+    active.clear();
+    activeFile.resize(0);
+    activeFile.seek(0);
+}
+
+QVector<StayRecord> StayHistory::staysBetween(qint64 from, qint64 to) const {
+    QVector<StayRecord> result;
+    for (const Segment &segment : segments) {
+        if (segment.minEntry >= to || segment.maxExit <= from) continue;  // 时间索引：整段不相交
+        // 只读离场时间和时长两列判断，命中的行再解码其余列
+        for (quint32 row = 0; row < segment.rows; ++row) {
+            qint64 exit = segment.minExit + load<quint32>(segment.exitOffsets + 4 * row);
+            qint64 entry = exit - qint64(load<quint32>(segment.durations + 4 * row)) * 1000;
+            if (entry < to && exit > from) result.append(rowAt(segment, row));
+        }
+    }
+    for (const QVector<StayRecord> *rows : {&active, &incoming}) {
+        for (const StayRecord &stay : *rows) {
+            if (overlaps(stay, from, to)) result.append(stay);
+        }
+    }
+    return result;
+}
+
+QVector<StayRecord> StayHistory::staysOf(const PlateKey &plate, qint64 from, qint64 to) const {
+    QVector<StayRecord> result;
+    const QVector<int> ids = plateSegments.value(plate);
+    for (int id : ids) {
+        const Segment &segment = segments[id];
+        if (segment.minEntry >= to || segment.maxExit <= from) continue;
+
+        // 在按车牌排序的字典中二分查找，再按倒排表取出该车牌的行
+        quint32 low = 0, high = segment.plates;
+        while (low < high) {
+            quint32 middle = (low + high) / 2;
+            const uchar *entry = segment.dictionary + 16 * middle;
+            if (PlateKey::fromWords(load<quint64>(entry), load<quint64>(entry + 8)) < plate) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low == segment.plates) continue;
+        quint32 begin = load<quint32>(segment.postingStarts + 4 * low);
+        quint32 end = load<quint32>(segment.postingStarts + 4 * (low + 1));
+        for (quint32 i = begin; i < end; ++i) {
+            StayRecord stay = rowAt(segment, load<quint16>(segment.postings + 2 * i));
+            if (stay.plate == plate && overlaps(stay, from, to)) result.append(stay);
+        }
+    }
+    for (const QVector<StayRecord> *rows : {&active, &incoming}) {
+        for (const StayRecord &stay : *rows) {
+            if (stay.plate == plate && overlaps(stay, from, to)) result.append(stay);
+        }
+    }
+    return result;
+}
+
+QVector<DailyRevenue> StayHistory::revenueByDay(qint64 from, qint64 to, int utcOffsetMinutes) const {
+    const qint64 offset = qint64(utcOffsetMinutes) * 60 * 1000;
+    QMap<qint64, DailyRevenue> days;  // 自 1970-01-01 起的当地天数 -> 汇总
+    auto add = [&](qint64 exit, qint64 cents) {
+        DailyRevenue &day = days[floorDiv(exit + offset, kMSecsPerDay)];
+        ++day.stays;
+        day.revenueCents += cents;
+    };
+
+    // 只读离场时间和费用两列
+    for (const Segment &segment : segments) {
+        if (segment.maxExit < from || segment.minExit >= to) continue;
+        for (quint32 row = 0; row < segment.rows; ++row) {
+            qint64 exit = segment.minExit + load<quint32>(segment.exitOffsets + 4 * row);
+            if (exit >= from && exit < to) add(exit, load<quint32>(segment.fees + 4 * row));
+        }
+    }
+    for (const QVector<StayRecord> *rows : {&active, &incoming}) {
+        for (const StayRecord &stay : *rows) {
+            if (stay.exitTime >= from && stay.exitTime < to) add(stay.exitTime, stay.feeCents);
+        }
+    }
+
+    QVector<DailyRevenue> result;
+    result.reserve(days.size());
+    const QDate epoch(1970, 1, 1);
+    for (auto it = days.cbegin(); it != days.cend(); ++it) {
+        DailyRevenue day = it.value();
+        day.date = epoch.addDays(it.key());
+        result.append(day);
+    }
+    return result;
+}
+
+qint64 StayHistory::stayCount() const {
+    qint64 count = active.size() + incoming.size();
+    for (const Segment &segment : segments) count += segment.rows;
+    return count;
+}
+
+qint64 StayHistory::diskBytes() const {
+    qint64 bytes = qint64(active.size()) * kActiveRowBytes;
+    for (const Segment &segment : segments) bytes += segment.bytes;
+    return bytes;
+}
+
+void StayHistory::flush() {
+    if (incoming.isEmpty()) return;
+    QVector<StayRecord> rows;
+    rows.swap(incoming);
+    for (const StayRecord &stay : rows) append(stay);
+}
+
+void StayHistory::vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) {
+    // 按出库时结算的离场时间和费用记账，与收据一致；没有计费的调用方才按计费规则补算。
+    // 回调在停车场的锁内，这里只记到内存，写盘和封存留给 flush
+    StayRecord stay;
+    stay.plate = vehicle.getPlateKey();
+    stay.spot = spot;
+    stay.entryTime = vehicle.getEntryTime();
+    stay.exitTime = release.exitTime;
+    stay.feeCents = release.feeCents >= 0 ? release.feeCents
+                                          : tariff->price(vehicle.getVehicleClass(), stay.entryTime, stay.exitTime);
+    stay.vehicleClass = vehicle.getVehicleClass();
+    incoming.append(alignStay(stay));
+}
@@ -0,0 +1,104 @@
+#ifndef STAYHISTORY_H
+#define STAYHISTORY_H
+
+#include <QDate>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "parkinglot.h"
+#include "tariff.h"
+
+// 一次完整的停车记录
+struct StayRecord {
+    PlateKey plate;
+    int spot;
+    qint64 entryTime;   // 毫秒时间戳，按秒存储
+    qint64 exitTime;
+    qint64 feeCents;
+    VehicleClass vehicleClass;
+};
+
+struct DailyRevenue {
+    QDate date;         // 按离场时间所在的当地自然日
+    int stays = 0;
+    qint64 revenueCents = 0;
+};
+
+// StayHistory 类
+// 出库车辆的历史记录。新记录先逐行追加到 active.bin，攒满一段（或跨度超过一周）后
+// 按列写成只读的段文件 segment-NNNNNNNN.col，以内存映射方式读取：
+//   - 每段头部记录入场、离场时间的上下界，作为时间索引，时段查询跳过不相交的段；
+//   - 每段内有按车牌排序的字典和行号倒排表，启动时汇总成“车牌 -> 段”的索引，
+//     按车牌查询只打开包含该车牌的段；
+//   - 时间存为段内偏移，车牌存为字典下标，每行约 21 字节。
+// 作为 ParkingLotObserver 在出库时按结算的离场时间和费用记录一行。回调在停车场的锁内执行，
+// 只把记录放进内存（查询立即可见）；调用方释放锁后调用 flush 写入 active.bin 并按需封存。
+// 与停车场在同一线程使用。
+// active.bin 只 flush 不 fsync，断电时可能丢失最后几条记录，不影响停车场状态本身。
+class StayHistory : public ParkingLotObserver {
+public:
+    static const int kSegmentRows = 65536;
+    static const qint64 kMaxSegmentSpan = 7LL * 24 * 3600 * 1000;
+
+    // tariff 只用于补算没有随出库给出费用的记录
+    StayHistory(const QString &directory, const TariffEngine *tariff);
+    ~StayHistory() override;
+
+    StayHistory(const StayHistory &) = delete;
+    StayHistory &operator=(const StayHistory &) = delete;
+
+    void append(StayRecord stay);
+    void seal();  // 把尚未封存的记录写成一个列式段
+    void flush(); // 把出库回调记下的记录写盘，段满时封存；不需要持有停车场的锁
+
+    // 与 [from, to) 有交集的停留，即这段时间内在场过的车辆
+    QVector<StayRecord> staysBetween(qint64 from, qint64 to) const;
+    QVector<StayRecord> staysOf(const PlateKey &plate, qint64 from, qint64 to) const;
+    // 离场时间落在 [from, to) 内的记录按当地自然日汇总，从旧到新
+    QVector<DailyRevenue> revenueByDay(qint64 from, qint64 to, int utcOffsetMinutes) const;
+
+    int segmentCount() const { return segments.size(); }
+    qint64 stayCount() const;
+    qint64 diskBytes() const;
+
+    void vehicleReleased(const Vehicle &vehicle, int spot, const ReleaseInfo &release) override;
+
+private:
+    struct Segment {
+        QFile *file;
+        quint32 rows;
+        quint32 plates;
+        qint64 minEntry, maxEntry;
+        qint64 minExit, maxExit;
+        qint64 bytes;
+        // 各列在映射内存中的起始位置
+        const uchar *dictionary;      // quint64 x 2，按车牌排序
+        const uchar *postingStarts;   // quint32 x (plates + 1)
+        const uchar *exitOffsets;     // quint32，相对 minExit 的毫秒数
+        const uchar *durations;       // quint32，停留秒数
+        const uchar *spots;           // qint32
+        const uchar *fees;            // quint32，分
+        const uchar *postings;        // quint16 行号，按字典顺序分组
+        const uchar *plateIds;        // quint16 字典下标
+        const uchar *classes;         // quint8
+    };
+
+    bool openSegment(const QString &path);
+    StayRecord rowAt(const Segment &segment, quint32 row) const;
+    void writeActive(const StayRecord &stay);
+
+    QString directory;
+    const TariffEngine *tariff;
+    QVector<Segment> segments;
+    QHash<PlateKey, QVector<int>> plateSegments;  // 车牌 -> 包含该车牌的段
+    QVector<StayRecord> active;                   // 尚未封存的记录
+    QVector<StayRecord> incoming;                 // 出库回调记下、尚未写盘的记录
+    qint64 activeMinExit = 0;
+    qint64 activeMaxExit = 0;
+    QFile activeFile;
+    int nextSegmentNumber = 1;
+};
+
+#endif // STAYHISTORY_H
@@ -0,0 +1,138 @@
+#include "tariff.h"
+#include "parkingspotmanager.h"
+#include "tracing.h"
+
+#include <QtGlobal>
+
+#include <vector>
+
+namespace {
+
+const int kMinutesPerDay = 1440;
+const qint64 kMSecsPerMinute = 60 * 1000;
+
+qint64 floorDiv(qint64 value, qint64 divisor) {
+    qint64 quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+} // namespace
+
+TariffRules TariffRules::defaults() {
+    // 白天 08:00-20:00 按高峰费率，其余时段按基础费率，每天封顶
+    TariffRules rules;
+    const qint32 dayRates[kVehicleClassCount] = {500, 400, 1000};
+    const qint32 nightRates[kVehicleClassCount] = {300, 200, 600};
+    const qint64 caps[kVehicleClassCount] = {6000, 4800, 12000};
+    for (int i = 0; i < kVehicleClassCount; ++i) {
+        rules.classes[i].baseCentsPerHour = nightRates[i];
+        rules.classes[i].bands = {TariffBand{8 * 60, 20 * 60, dayRates[i]}};
+        rules.classes[i].dailyCapCents = caps[i];
+    }
+    return rules;
+}
+
+// TariffEngine 实现
+TariffEngine::TariffEngine(const TariffRules &rules) {
+    setRules(rules);
+}
+
+void TariffEngine::setRules(const TariffRules &newRules) {
+    rules = newRules;
+    graceMSecs = qint64(qMax(0, rules.graceMinutes)) * kMSecsPerMinute;
+    offsetMSecs = qint64(rules.utcOffsetMinutes) * kMSecsPerMinute;
+
+    for (int i = 0; i < kVehicleClassCount; ++i) {
+        const ClassTariff &tariff = rules.classes[i];
+        // 先展开成每分钟的费率，再累加成前缀和；每分钟费用 = 每小时费率 / 60，
+        // 以 1/60 分为单位正好等于每小时费率，保持整数
+        qint32 minuteRates[kMinutesPerDay];
+        for (int minute = 0; minute < kMinutesPerDay; ++minute) {
+            minuteRates[minute] = qMax(0, tariff.baseCentsPerHour);
+        }
+        for (const TariffBand &band : tariff.bands) {
+            int start = qBound(0, band.startMinute, kMinutesPerDay);
+            int end = qBound(0, band.endMinute, kMinutesPerDay);
+            for (int minute = start; minute < end; ++minute) {
+                minuteRates[minute] = qMax(0, band.centsPerHour);
+            }
+        }
+
+        CompiledClass &table = compiled[i];
+        table.prefix[0] = 0;
+        for (int minute = 0; minute < kMinutesPerDay; ++minute) {
+            table.prefix[minute + 1] = table.prefix[minute] + minuteRates[minute];
+        }
+        qint64 fullDay = table.prefix[kMinutesPerDay];
+        table.dailyCap = tariff.dailyCapCents > 0 ? qMin(fullDay, tariff.dailyCapCents * 60) : fullDay;
+    }
+}
+
+const TariffRules &TariffEngine::getRules() const {
+    return rules;
+}
+
+inline qint64 TariffEngine::priceCompiled(const CompiledClass &table, qint64 entryMSecs, qint64 exitMSecs) const {
+    if (exitMSecs - entryMSecs <= graceMSecs) {
+        return 0;
+    }
+
+    // 换算为当地时间的分钟序号，[first, last) 为计费的分钟区间
+    qint64 first = floorDiv(entryMSecs + offsetMSecs, kMSecsPerMinute);
+    qint64 last = floorDiv(exitMSecs + offsetMSecs + kMSecsPerMinute - 1, kMSecsPerMinute);
+    qint64 firstDay = floorDiv(first, kMinutesPerDay);
+    qint64 lastDay = floorDiv(last - 1, kMinutesPerDay);
+    int startMinute = int(first - firstDay * kMinutesPerDay);
+    int endMinute = int(last - lastDay * kMinutesPerDay);
+
+    qint64 sixtieths;
+    if (firstDay == lastDay) {
+        sixtieths = qMin(table.dailyCap, table.prefix[endMinute] - table.prefix[startMinute]);
+    } else {
+        // 首日剩余部分 + 中间整天 + 末日已过部分，各自封顶
+        sixtieths = qMin(table.dailyCap, table.prefix[kMinutesPerDay] - table.prefix[startMinute])
+                    + (lastDay - firstDay - 1) * table.dailyCap
+                    + qMin(table.dailyCap, table.prefix[endMinute]);
+    }
+    return (sixtieths + 59) / 60;  // 不足一分钱按一分钱计
+}
+
+qint64 TariffEngine::price(VehicleClass vehicleClass, qint64 entryMSecs, qint64 exitMSecs) const {
+    int index = int(vehicleClass);
+    if (index < 0 || index >= kVehicleClassCount) index = 0;
+    return priceCompiled(compiled[index], entryMSecs, exitMSecs);
+}
+
+void TariffEngine::settle(const qint64 *entryMSecs, const quint8 *classes, int count, qint64 exitMSecs,
+                          qint64 *outCents) const {
+    PARK_TRACE_SCOPE(Settlement);
+    // 逐项独立、无分配的紧凑循环，查找表常驻缓存
+    for (int i = 0; i < count; ++i) {
+        int index = classes[i] < kVehicleClassCount ? classes[i] : 0;
+        outCents[i] = priceCompiled(compiled[index], entryMSecs[i], exitMSecs);
+    }
+}
+
+SettlementReport TariffEngine::settleParked(const ParkingSpotManager &spots, qint64 exitMSecs) const {
+    // 在库车辆本身就是结构数组，直接在入场时间和车型数组上批量计价
+    int count = spots.getParkedCount();
+    const quint8 *classes = spots.getParkedVehicleClasses();
+    std::vector<qint64> cents(count);
+    settle(spots.getParkedEntryTimes(), classes, count, exitMSecs, cents.data());
+
+    SettlementReport report;
+    report.vehicles = count;
+    for (int i = 0; i < count; ++i) {
+        report.totalCents += cents[i];
+        report.maxCents = qMax(report.maxCents, cents[i]);
+        report.classCents[classes[i]] += cents[i];
+        ++report.classVehicles[classes[i]];
+    }
+    return report;
+}
+
+QString TariffEngine::formatCents(qint64 cents) {
+    QString sign = cents < 0 ? QStringLiteral("-") : QString();
+    qint64 magnitude = qAbs(cents);
+    return QString("%1%2.%3").arg(sign).arg(magnitude / 100).arg(magnitude % 100, 2, 10, QChar('0'));
+}
@@ -0,0 +1,79 @@
+#ifndef TARIFF_H
+#define TARIFF_H
+
+#include <QString>
+#include <QVector>
+
+#include <array>
+
+#include "vehicle.h"
+
+class ParkingSpotManager;
+
+// 一天中的一个计费时段 [startMinute, endMinute)，按当地时间的分钟计
+struct TariffBand {
+    int startMinute = 0;
+    int endMinute = 1440;
+    qint32 centsPerHour = 0;
+};
+
+// 一类车辆的计费规则：后面的时段覆盖前面的时段，未被时段覆盖的分钟按基础费率计费
+struct ClassTariff {
+    qint32 baseCentsPerHour = 500;
+    QVector<TariffBand> bands;
+    qint64 dailyCapCents = 0;       // 每个自然日的封顶金额，0 表示不封顶
+};
+
+struct TariffRules {
+    int graceMinutes = 15;          // 停留不超过该时长免费
+    int utcOffsetMinutes = 480;     // 划分时段和自然日所用的当地时区
+    ClassTariff classes[kVehicleClassCount];
+
+    static TariffRules defaults();
+};
+
+// 批量结算的汇总结果
+struct SettlementReport {
+    int vehicles = 0;
+    qint64 totalCents = 0;
+    qint64 maxCents = 0;
+    qint64 classCents[kVehicleClassCount] = {};
+    int classVehicles[kVehicleClassCount] = {};
+};
+
+// TariffEngine 类
+// 把计费规则编译成每类车辆一张按分钟累计的前缀和表，任意停留区间的费用
+// 只需几次查表和整数运算；全程以分为单位计费，没有浮点误差。
+class TariffEngine {
+public:
+    explicit TariffEngine(const TariffRules &rules = TariffRules::defaults());
+
+    void setRules(const TariffRules &rules);  // 重新编译查找表
+    const TariffRules &getRules() const;
+
+    // [entryMSecs, exitMSecs) 的停车费（分），不足一分钟按一分钟计
+    qint64 price(VehicleClass vehicleClass, qint64 entryMSecs, qint64 exitMSecs) const;
+
+    // 批量结算：count 辆车按同一结束时间计价，输入输出都是连续数组
+    void settle(const qint64 *entryMSecs, const quint8 *classes, int count, qint64 exitMSecs, qint64 *outCents) const;
+
+    // 对停车场中全部在场车辆按 exitMSecs 结算
+    SettlementReport settleParked(const ParkingSpotManager &spots, qint64 exitMSecs) const;
+
+    static QString formatCents(qint64 cents);  // 1234 -> "12.34"
+
+private:
+    struct CompiledClass {
+        std::array<qint64, 1441> prefix;   // prefix[m] 为当天 [0, m) 分钟的费用，单位 1/60 分
+        qint64 dailyCap;                    // 单日费用上限，单位 1/60 分
+    };
+
+    qint64 priceCompiled(const CompiledClass &table, qint64 entryMSecs, qint64 exitMSecs) const;
+
+    TariffRules rules;
+    qint64 graceMSecs = 0;
+    qint64 offsetMSecs = 0;
+    CompiledClass compiled[kVehicleClassCount];
+};
+
+#endif // TARIFF_H
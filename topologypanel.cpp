@@ -0,0 +1,82 @@
+#include "topologypanel.h"
+#include "lottopology.h"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QMutexLocker>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+// TopologyPanel 实现
+TopologyPanel::TopologyPanel(const TopologyOccupancy *occupancy, QWidget *parent)
+    : QWidget(parent, Qt::Window), occupancy(occupancy), routeLabel(new QLabel(this)),
+    tree(new QTreeWidget(this)), refreshTimer(new QTimer(this))
+{
+    tree->setHeaderLabels({"位置", "空闲", "总车位", "占用率"});
+    tree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    tree->setRootIsDecorated(true);
+
+    // 拓扑在运行期间不变，条目只建一次，之后只更新数字
+    const LotTopology &topology = occupancy->getTopology();
+    items.fill(nullptr, topology.nodeCount());
+    for (int id = 1; id < topology.nodeCount(); ++id) {
+        const TopologyNode &node = topology.node(id);
+        QTreeWidgetItem *item = node.parent > 0 ? new QTreeWidgetItem(items[node.parent])
+                                                : new QTreeWidgetItem(tree);
+        item->setText(0, node.name);
+        for (int column = 1; column < 4; ++column) item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        items[id] = item;
+    }
+    // 默认展开到楼层，区域按需展开
+    for (int id = 1; id < topology.nodeCount(); ++id) {
+        if (topology.node(id).kind == TopologyKind::Lot) items[id]->setExpanded(true);
+    }
+
+    refreshTimer->setInterval(1000);
+    connect(refreshTimer, &QTimer::timeout, this, &TopologyPanel::refresh);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(routeLabel);
+    layout->addWidget(tree, 1);
+    setLayout(layout);
+    setWindowTitle("楼层余位");
+    resize(480, 520);
+}
+
+void TopologyPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void TopologyPanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer->stop();  // 不可见时不刷新
+}
+
+void TopologyPanel::refresh()
+{
+    QMutexLocker locker(lotMutex);
+    const LotTopology &topology = occupancy->getTopology();
+    for (int id = 1; id < topology.nodeCount(); ++id) {
+        int free = occupancy->freeCount(id);
+        int total = occupancy->totalCount(id);
+        items[id]->setText(1, QString::number(free));
+        items[id]->setText(2, QString::number(total));
+        items[id]->setText(3, QString("%1%").arg(total > 0 ? 100.0 * (total - free) / total : 0.0, 0, 'f', 1));
+    }
+
+    int level = occupancy->emptiestLevel();
+    if (level >= 0 && occupancy->freeCount(level) > 0) {
+        routeLabel->setText(QString("全站空闲 %1 / %2，下一辆车引导至：%3（空闲 %4）")
+                                .arg(occupancy->freeCount(0))
+                                .arg(occupancy->totalCount(0))
+                                .arg(topology.pathOf(level))
+                                .arg(occupancy->freeCount(level)));
+    } else {
+        routeLabel->setText("全站车位已满");
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef TOPOLOGYPANEL_H
+#define TOPOLOGYPANEL_H
+
+#include <QVector>
+#include <QWidget>
+
+class QLabel;
+class QMutex;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+class TopologyOccupancy;
+
+// 楼层面板：按停车场 → 楼层 → 区域列出空闲/总车位和占用率，相当于各入口的余位显示屏，
+// 并显示下一辆排队车辆会被引导到的楼层；数据直接读 TopologyOccupancy 的聚合值，可见时每秒刷新一次
+class TopologyPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    TopologyPanel(const TopologyOccupancy *occupancy, QWidget *parent = nullptr);
+    void setLotMutex(QMutex *mutex) { lotMutex = mutex; }  // 停车场在工作线程上修改时，刷新期间持有该锁
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+
+    const TopologyOccupancy *occupancy;
+    QMutex *lotMutex = nullptr;
+    QLabel *routeLabel;
+    QTreeWidget *tree;
+    QVector<QTreeWidgetItem *> items;  // 按拓扑节点编号，站点为 nullptr
+    QTimer *refreshTimer;
+};
+
+#endif // TOPOLOGYPANEL_H
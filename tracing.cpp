@@ -0,0 +1,267 @@
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int kBins = 256;             // 每个 2 的幂区间 4 个桶，相对误差约 12%
+const int kEventCapacity = 16384;  // 每个线程保留的最近事件数
+
+struct Histogram {
+    std::atomic<quint64> bins[kBins];
+    std::atomic<quint64> count;
+    std::atomic<quint64> total;
+    std::atomic<quint64> max;
+};
+
+// 逐槽序号：写入前后各加一，读取方看到奇数或前后不一致就丢弃该槽
+struct Event {
+    std::atomic<quint32> sequence;
+    std::atomic<quint32> point;
+    std::atomic<qint64> start;
+    std::atomic<qint64> duration;
+};
+
+struct ThreadState {
+    int id;
+    std::atomic<quint32> generation;
+    Histogram histograms[kTracePointCount];
+    Event events[kEventCapacity];
+    std::atomic<quint64> head;
+};
+
+std::atomic<quint32> globalGeneration(1);
+thread_local ThreadState *localState = nullptr;
+
+QMutex &registryMutex() {
+    static QMutex mutex;
+    return mutex;
+}
+
+// 线程退出后它的数据仍可被读取和导出，因此状态不释放
+QVector<ThreadState *> &registry() {
+    static QVector<ThreadState *> states;
+    return states;
+}
+
+ThreadState *threadState() {
+    if (!localState) {
+        ThreadState *state = new ThreadState();  // 值初始化，全部清零
+        QMutexLocker locker(&registryMutex());
+        state->id = registry().size() + 1;
+        registry().append(state);
+        localState = state;
+    }
+    return localState;
+}
+
+// 只有所属线程写入，用读加写代替原子加法
+void bump(std::atomic<quint64> &counter, quint64 amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void clearState(ThreadState *state) {
+    for (Histogram &histogram : state->histograms) {
+        for (std::atomic<quint64> &bin : histogram.bins) bin.store(0, std::memory_order_relaxed);
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.total.store(0, std::memory_order_relaxed);
+        histogram.max.store(0, std::memory_order_relaxed);
+    }
+    state->head.store(0, std::memory_order_release);
+}
+
+int binOf(qint64 nanoseconds) {
+    if (nanoseconds <= 0) return 0;
+    quint64 value = quint64(nanoseconds);
+    int exponent = 63 - int(qCountLeadingZeroBits(value));
+    int sub = exponent >= 2 ? int((value >> (exponent - 2)) & 3) : 0;
+    return qMin(kBins - 1, exponent * 4 + sub);
+}
+
+qint64 binValue(int bin) {
+    int exponent = bin / 4;
+    if (exponent < 2) return qint64(1) << exponent;
+    qint64 width = (qint64(1) << exponent) / 4;
+    return (qint64(1) << exponent) + (bin % 4) * width + width / 2;
+}
+
+} // namespace
+
+std::atomic<int> Tracer::currentMode(int(TraceMode::Off));
+
+const char *tracePointName(TracePoint point) {
+    switch (point) {
+    case TracePoint::Park: return "lot.park";
+    case TracePoint::Release: return "lot.release";
+    case TracePoint::Promote: return "lot.promote";
+    case TracePoint::CancelQueue: return "lot.cancel";
+    case TracePoint::GateBatch: return "gate.batch";
+    case TracePoint::JournalAppend: return "journal.append";
+    case TracePoint::Checkpoint: return "journal.checkpoint";
+    case TracePoint::Settlement: return "tariff.settle";
+    case TracePoint::PlateSearch: return "search.query";
+    case TracePoint::HistoryAppend: return "history.append";
+    case TracePoint::UiRefresh: return "ui.refresh";
+    case TracePoint::ViewPaint: return "ui.paint";
+    case TracePoint::LogAppend: return "log.append";
+    case TracePoint::LogFlush: return "log.flush";
+    case TracePoint::Animation: return "ui.animation";
+    case TracePoint::ServerBatch: return "server.batch";
+    case TracePoint::JournalSync: return "journal.sync";
+    }
+    return "unknown";
+}
+
+// Tracer 实现
+void Tracer::setMode(TraceMode mode) {
+    currentMode.store(int(mode), std::memory_order_relaxed);
+}
+
+TraceMode Tracer::mode() {
+    return TraceMode(currentMode.load(std::memory_order_relaxed));
+}
+
+bool Tracer::parseMode(const QString &text, TraceMode *mode) {
+    QString name = text.trimmed().toLower();
+    if (name == "off" || name == "0") {
+        *mode = TraceMode::Off;
+    } else if (name == "histogram" || name == "1") {
+        *mode = TraceMode::Histogram;
+    } else if (name == "timeline" || name == "2") {
+        *mode = TraceMode::Timeline;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+qint64 Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::record(TracePoint point, qint64 startNs, qint64 endNs) {
+    int mode = currentMode.load(std::memory_order_relaxed);
+    if (mode == int(TraceMode::Off)) return;
+
+    ThreadState *state = threadState();
+    quint32 generation = globalGeneration.load(std::memory_order_acquire);
+    if (state->generation.load(std::memory_order_relaxed) != generation) {
+        clearState(state);
+        state->generation.store(generation, std::memory_order_release);
+    }
+
+    qint64 duration = qMax<qint64>(0, endNs - startNs);
+    Histogram &histogram = state->histograms[int(point)];
+    bump(histogram.bins[binOf(duration)], 1);
+    bump(histogram.count, 1);
+    bump(histogram.total, quint64(duration));
+    if (quint64(duration) > histogram.max.load(std::memory_order_relaxed)) {
+        histogram.max.store(quint64(duration), std::memory_order_relaxed);
+    }
+
+    if (mode == int(TraceMode::Timeline)) {
+        quint64 head = state->head.load(std::memory_order_relaxed);
+        Event &event = state->events[head % kEventCapacity];
+        quint32 sequence = event.sequence.load(std::memory_order_relaxed);
+        event.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.point.store(quint32(point), std::memory_order_relaxed);
+        event.start.store(startNs, std::memory_order_relaxed);
+        event.duration.store(duration, std::memory_order_relaxed);
+        event.sequence.store(sequence + 2, std::memory_order_release);
+        state->head.store(head + 1, std::memory_order_release);
+    }
+}
+
+QVector<TraceStats> Tracer::stats() {
+    QVector<TraceStats> result(kTracePointCount);
+    quint32 generation = globalGeneration.load(std::memory_order_acquire);
+    QVector<quint64> bins(kBins);
+
+    QMutexLocker locker(&registryMutex());
+    for (int point = 0; point < kTracePointCount; ++point) {
+        TraceStats &stats = result[point];
+        bins.fill(0);
+        for (ThreadState *state : registry()) {
+            if (state->generation.load(std::memory_order_acquire) != generation) continue;  // 清零后尚未记录
+            const Histogram &histogram = state->histograms[point];
+            stats.count += qint64(histogram.count.load(std::memory_order_relaxed));
+            stats.totalNs += qint64(histogram.total.load(std::memory_order_relaxed));
+            stats.maxNs = qMax(stats.maxNs, qint64(histogram.max.load(std::memory_order_relaxed)));
+            for (int bin = 0; bin < kBins; ++bin) {
+                bins[bin] += histogram.bins[bin].load(std::memory_order_relaxed);
+            }
+        }
+
+        // 各分位数在一次累加中依次取得
+        const double quantiles[3] = {0.50, 0.99, 0.999};
+        qint64 *targets[3] = {&stats.p50Ns, &stats.p99Ns, &stats.p999Ns};
+        quint64 seen = 0;
+        int next = 0;
+        for (int bin = 0; bin < kBins && next < 3 && stats.count > 0; ++bin) {
+            seen += bins[bin];
+            while (next < 3 && seen >= quint64(std::ceil(quantiles[next] * stats.count))) {
+                *targets[next++] = qMin(binValue(bin), stats.maxNs);
+            }
+        }
+    }
+    return result;
+}
+
+void Tracer::reset() {
+    globalGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
+QByteArray Tracer::chromeTrace() {
+    QByteArray out("{\"traceEvents\":[\n");
+    qint64 pid = QCoreApplication::applicationPid();
+    quint32 generation = globalGeneration.load(std::memory_order_acquire);
+    char line[256];
+    bool first = true;
+    auto emitLine = [&](int length) {
+        if (!first) out.append(",\n");
+        out.append(line, qMin(length, int(sizeof(line)) - 1));
+        first = false;
+    };
+
+    QMutexLocker locker(&registryMutex());
+    for (ThreadState *state : registry()) {
+        if (state->generation.load(std::memory_order_acquire) != generation) continue;
+        emitLine(std::snprintf(line, sizeof(line),
+                               "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lld,\"tid\":%d,\"args\":{\"name\":\"thread-%d\"}}",
+                               static_cast<long long>(pid), state->id, state->id));
+
+        quint64 head = state->head.load(std::memory_order_acquire);
+        quint64 begin = head > quint64(kEventCapacity) ? head - kEventCapacity : 0;
+        for (quint64 i = begin; i < head; ++i) {
+            const Event &event = state->events[i % kEventCapacity];
+            quint32 before = event.sequence.load(std::memory_order_acquire);
+            quint32 point = event.point.load(std::memory_order_relaxed);
+            qint64 start = event.start.load(std::memory_order_relaxed);
+            qint64 duration = event.duration.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((before & 1) != 0 || before != event.sequence.load(std::memory_order_relaxed)) continue;  // 正在被覆盖
+            if (point >= quint32(kTracePointCount)) continue;
+
+            // 时间单位为微秒
+            const char *name = tracePointName(TracePoint(point));
+            const char *dot = std::strchr(name, '.');
+            int categoryLength = dot ? int(dot - name) : int(std::strlen(name));
+            emitLine(std::snprintf(line, sizeof(line),
+                                   "{\"name\":\"%s\",\"cat\":\"%.*s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lld,\"tid\":%d}",
+                                   name, categoryLength, name, start / 1000.0, duration / 1000.0,
+                                   static_cast<long long>(pid), state->id));
+        }
+    }
+    out.append("\n],\"displayTimeUnit\":\"ns\"}\n");
+    return out;
+}
@@ -0,0 +1,99 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+// 被计时的代码位置
+enum class TracePoint : quint8 {
+    Park,           // ParkingLot::parkOrEnqueue
+    Release,        // ParkingLot::releaseVehicle
+    Promote,        // ParkingLot::promoteNextVehicle
+    CancelQueue,    // ParkingLot::cancelQueuedVehicle
+    GateBatch,      // 闸机事件批处理
+    JournalAppend,  // 预写日志编码
+    Checkpoint,     // 生成快照
+    Settlement,     // 批量结算
+    PlateSearch,    // 车牌模糊查找
+    HistoryAppend,  // 写入停车历史
+    UiRefresh,      // 合并后的模型刷新
+    ViewPaint,      // 车位视图重绘
+    LogAppend,      // LogWindow 追加日志
+    LogFlush,       // 日志批量写入模型
+    Animation,      // 动画从开始到结束，即界面上的视觉延迟
+    ServerBatch,    // 无界面服务处理一次读到的请求
+    JournalSync     // 应答前等待预写日志落盘
+};
+const int kTracePointCount = 17;
+
+const char *tracePointName(TracePoint point);  // 形如 "lot.park"，点号前为 Chrome 跟踪中的类别
+
+enum class TraceMode : int {
+    Off,        // 只剩一次原子读和分支
+    Histogram,  // 按线程累计延迟直方图
+    Timeline    // 另外保留每个线程最近的事件，可导出 Chrome 跟踪
+};
+
+struct TraceStats {
+    qint64 count = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+    qint64 p50Ns = 0;
+    qint64 p99Ns = 0;
+    qint64 p999Ns = 0;
+};
+
+// Tracer 类
+// 低开销的延迟计量。每个线程第一次记录时分配自己的直方图和事件环，之后只由本线程写入
+// （relaxed 原子读写，无锁、无共享写），读取方合并各线程的数据；事件环用逐槽序号校验读到的是完整事件。
+// 模式可在运行时切换；定义 PARK_NO_TRACING 时 PARK_TRACE_SCOPE 编译为空。
+class Tracer {
+public:
+    static void setMode(TraceMode mode);
+    static TraceMode mode();
+#ifdef PARK_NO_TRACING
+    static bool enabled() { return false; }
+#else
+    static bool enabled() { return currentMode.load(std::memory_order_relaxed) != int(TraceMode::Off); }
+#endif
+    static bool parseMode(const QString &text, TraceMode *mode);  // off / histogram / timeline
+
+    static qint64 now();  // 单调时钟，纳秒
+    static void record(TracePoint point, qint64 startNs, qint64 endNs);
+
+    static QVector<TraceStats> stats();  // 按 TracePoint 下标，合并全部线程
+    static void reset();                 // 各线程在下次记录时清空自己的数据
+    static QByteArray chromeTrace();     // Chrome trace-event JSON，可在 chrome://tracing 或 Perfetto 中打开
+
+private:
+    static std::atomic<int> currentMode;
+};
+
+// 作用域计时：构造时取开始时间，析构时记录；未启用时不读时钟
+class TraceScope {
+public:
+    explicit TraceScope(TracePoint point) : point(point), start(Tracer::enabled() ? Tracer::now() : -1) {}
+    ~TraceScope() {
+        if (start >= 0) Tracer::record(point, start, Tracer::now());
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    TracePoint point;
+    qint64 start;
+};
+
+#define PARK_TRACE_JOIN2(a, b) a##b
+#define PARK_TRACE_JOIN(a, b) PARK_TRACE_JOIN2(a, b)
+#ifdef PARK_NO_TRACING
+#define PARK_TRACE_SCOPE(point) do {} while (0)
+#else
+#define PARK_TRACE_SCOPE(point) TraceScope PARK_TRACE_JOIN(traceScope, __LINE__)(TracePoint::point)
+#endif
+
+#endif // TRACING_H
@@ -0,0 +1,32 @@
+#include "vehicle.h"
+
+QString vehicleClassName(VehicleClass vehicleClass) {
+    switch (vehicleClass) {
+    case VehicleClass::Standard: return "标准车";
+    case VehicleClass::Compact: return "小型车";
+    case VehicleClass::Oversize: return "大型车";
+    }
+    return QString();
+}
+
+QString priorityClassName(PriorityClass priorityClass) {
+    switch (priorityClass) {
+    case PriorityClass::Regular: return "普通";
+    case PriorityClass::Electric: return "新能源";
+    case PriorityClass::Permit: return "许可证";
+    case PriorityClass::Disabled: return "无障碍";
+    }
+    return QString();
+}
+
+// Vehicle 实现
+Vehicle::Vehicle(const QString &licensePlate, qint64 entryTime, VehicleClass vehicleClass, PriorityClass priorityClass)
+    : plate(licensePlate), entryTime(entryTime), vehicleClass(vehicleClass), priorityClass(priorityClass) {}
+
+Vehicle::Vehicle(const PlateKey &plate, qint64 entryTime, VehicleClass vehicleClass, PriorityClass priorityClass)
+    : plate(plate), entryTime(entryTime), vehicleClass(vehicleClass), priorityClass(priorityClass) {}
+
+QString Vehicle::getLicensePlate() const { return plate.toString(); }
+qint64 Vehicle::getEntryTime() const { return entryTime; }
+VehicleClass Vehicle::getVehicleClass() const { return vehicleClass; }
+PriorityClass Vehicle::getPriorityClass() const { return priorityClass; }
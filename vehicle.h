@@ -0,0 +1,52 @@
+#ifndef VEHICLE_H
+#define VEHICLE_H
+
+#include <QString>
+#include "platekey.h"
+
+// 车辆类型，决定计费费率
+enum class VehicleClass : quint8 {
+    Standard,   // 标准车
+    Compact,    // 小型车
+    Oversize    // 大型车
+};
+
+const int kVehicleClassCount = 3;
+
+// 排队优先级，车位满时决定放行顺序
+enum class PriorityClass : quint8 {
+    Regular,    // 普通车辆
+    Electric,   // 新能源车（充电车位）
+    Permit,     // 月租/许可证车辆
+    Disabled    // 残障人士车辆
+};
+
+const int kPriorityClassCount = 4;
+
+QString vehicleClassName(VehicleClass vehicleClass);
+QString priorityClassName(PriorityClass priorityClass);
+
+// Vehicle 类
+// 车牌以规范化的 PlateKey 内联保存，入场时间只存一个毫秒时间戳（自 1970-01-01 UTC），
+// 由调用方从 Clock 读取后传入；整个对象不持有堆内存，可按值传递。
+class Vehicle {
+public:
+    Vehicle() = default;
+    Vehicle(const QString &licensePlate, qint64 entryTime, VehicleClass vehicleClass = VehicleClass::Standard,
+            PriorityClass priorityClass = PriorityClass::Regular);
+    Vehicle(const PlateKey &plate, qint64 entryTime, VehicleClass vehicleClass = VehicleClass::Standard,
+            PriorityClass priorityClass = PriorityClass::Regular);
+    const PlateKey &getPlateKey() const { return plate; }
+    QString getLicensePlate() const;  // 规范化后的车牌号，用于显示和日志
+    qint64 getEntryTime() const;
+    VehicleClass getVehicleClass() const;
+    PriorityClass getPriorityClass() const;
+
+private:
+    PlateKey plate;
+    qint64 entryTime = 0;
+    VehicleClass vehicleClass = VehicleClass::Standard;
+    PriorityClass priorityClass = PriorityClass::Regular;
+};
+
+#endif // VEHICLE_H